@@ -1,9 +1,8 @@
-#!/bin/sh
+#!/bin/bash
 
 # $1 => destination file
 # $2 => source_directory
-# $3 => release_directory
-# $4 => debug_directory
+# $3... => object directories, one rule per directory for every source
 truncate --size=0 "${1}"
 for source in ${2}/*.c; do
 	dependencies=()
@@ -59,13 +58,11 @@ for source in ${2}/*.c; do
 	file="${file%%.c}"
 	file="${file}.o"
 
-	printf "${3}/${file}:" >> "${1}"
-	for name in "${dependencies[@]}"; do
-		printf " ${2}/${name}" >> "${1}"
+	for directory in "${@:3}"; do
+		printf "${directory}/${file}:" >> "${1}"
+		for name in "${dependencies[@]}"; do
+			printf " ${2}/${name}" >> "${1}"
+		done
+		printf "\n" >> "${1}"
 	done
-	printf "\n${4}/${file}:" >> "${1}"
-	for name in "${dependencies[@]}"; do
-		printf " ${2}/${name}" >> "${1}"
-	done
-	printf "\n" >> "${1}"
 done
@@ -0,0 +1,245 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "attribute-cache.h"
+
+#include <string.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+
+#ifdef D_attribute_cache_log
+#	define attribute_cache_log(M_message)         warn_log(M_message)
+#	define attribute_cache_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define attribute_cache_log(M_message)
+#	define attribute_cache_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 16
+
+typedef struct sl_cached_attributes_mutable {
+	Window x_window;
+	i32 x;
+	i32 y;
+	u32 width;
+	u32 height;
+	u32 border_width;
+	bool override_redirect;
+	bool mapped;
+} sl_cached_attributes_mutable;
+
+typedef struct sl_attribute_cache_mutable {
+	sl_cached_attributes_mutable* entries;
+	size_t size;
+	size_t allocated_size;
+
+	u64 hits;
+	u64 misses;
+} sl_attribute_cache_mutable;
+
+// index of the entry for x_window, or of where it would be inserted
+static size_t lower_bound (sl_attribute_cache const* restrict this, Window x_window) {
+	size_t begin = 0;
+	size_t end = this->size;
+
+	while (begin < end) {
+		size_t const middle = begin + (end - begin) / 2;
+
+		if (this->entries[middle].x_window < x_window) begin = middle + 1;
+		else end = middle;
+	}
+
+	return begin;
+}
+
+static sl_cached_attributes copy (sl_cached_attributes_mutable const* restrict attributes) {
+	return (sl_cached_attributes) {
+	.x_window = attributes->x_window,
+	.x = attributes->x,
+	.y = attributes->y,
+	.width = attributes->width,
+	.height = attributes->height,
+	.border_width = attributes->border_width,
+	.override_redirect = attributes->override_redirect,
+	.mapped = attributes->mapped};
+}
+
+static sl_cached_attributes_mutable* find (sl_attribute_cache* restrict this, Window x_window) {
+	size_t const i = lower_bound(this, x_window);
+
+	if (i == this->size || this->entries[i].x_window != x_window) return NULL;
+
+	return &((sl_attribute_cache_mutable*)this)->entries[i];
+}
+
+static void insert (sl_attribute_cache* restrict cache, sl_cached_attributes_mutable const* restrict attributes) {
+	sl_attribute_cache_mutable* const this = (sl_attribute_cache_mutable*)cache;
+	size_t const i = lower_bound(cache, attributes->x_window);
+
+	if (i != this->size && this->entries[i].x_window == attributes->x_window) {
+		this->entries[i] = *attributes;
+		return;
+	}
+
+	if (this->size == this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		sl_cached_attributes_mutable* entries = realloc(this->entries, sizeof(sl_cached_attributes_mutable) * allocated_size);
+
+		if (!entries) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return;
+		}
+
+		this->entries = entries;
+		this->allocated_size = allocated_size;
+	}
+
+	memmove(&this->entries[i + 1], &this->entries[i], sizeof(sl_cached_attributes_mutable) * (this->size - i));
+	this->entries[i] = *attributes;
+	++this->size;
+}
+
+void sl_attribute_cache_create (sl_attribute_cache* restrict this) { *(sl_attribute_cache_mutable*)this = (sl_attribute_cache_mutable) {}; }
+
+void sl_attribute_cache_delete (sl_attribute_cache* restrict this) {
+	if (this->entries) free(((sl_attribute_cache_mutable*)this)->entries);
+
+	*(sl_attribute_cache_mutable*)this = (sl_attribute_cache_mutable) {};
+}
+
+/*
+  synthetic events are what other clients claim happened, only the ones generated by the server are trusted. a window is seen once from the
+  SubstructureNotifyMask of its parent and once more from its own StructureNotifyMask, so every update has to be idempotent.
+*/
+
+void sl_attribute_cache_create_notify (sl_attribute_cache* restrict this, XCreateWindowEvent const* restrict event) {
+	if (event->send_event) return;
+
+	insert(
+	this,
+	&(sl_cached_attributes_mutable) {
+	.x_window = event->window,
+	.x = event->x,
+	.y = event->y,
+	.width = event->width,
+	.height = event->height,
+	.border_width = event->border_width,
+	.override_redirect = event->override_redirect,
+	.mapped = false}
+	);
+}
+
+void sl_attribute_cache_configure_notify (sl_attribute_cache* restrict this, XConfigureEvent const* restrict event) {
+	sl_cached_attributes_mutable* const attributes = find(this, event->window);
+	if (!attributes || event->send_event) return;
+
+	attributes->x = event->x;
+	attributes->y = event->y;
+	attributes->width = event->width;
+	attributes->height = event->height;
+	attributes->border_width = event->border_width;
+	attributes->override_redirect = event->override_redirect;
+}
+
+void sl_attribute_cache_gravity_notify (sl_attribute_cache* restrict this, XGravityEvent const* restrict event) {
+	sl_cached_attributes_mutable* const attributes = find(this, event->window);
+	if (!attributes || event->send_event) return;
+
+	attributes->x = event->x;
+	attributes->y = event->y;
+}
+
+void sl_attribute_cache_reparent_notify (sl_attribute_cache* restrict this, XReparentEvent const* restrict event) {
+	sl_cached_attributes_mutable* const attributes = find(this, event->window);
+	if (!attributes || event->send_event) return;
+
+	attributes->x = event->x;
+	attributes->y = event->y;
+	attributes->override_redirect = event->override_redirect;
+}
+
+void sl_attribute_cache_map_notify (sl_attribute_cache* restrict this, XMapEvent const* restrict event) {
+	sl_cached_attributes_mutable* const attributes = find(this, event->window);
+	if (!attributes || event->send_event) return;
+
+	attributes->override_redirect = event->override_redirect;
+	attributes->mapped = true;
+}
+
+void sl_attribute_cache_unmap_notify (sl_attribute_cache* restrict this, XUnmapEvent const* restrict event) {
+	sl_cached_attributes_mutable* const attributes = find(this, event->window);
+	if (!attributes || event->send_event) return;
+
+	attributes->mapped = false;
+}
+
+void sl_attribute_cache_destroy_notify (sl_attribute_cache* restrict cache, XDestroyWindowEvent const* restrict event) {
+	if (event->send_event) return;
+
+	sl_attribute_cache_mutable* const this = (sl_attribute_cache_mutable*)cache;
+	size_t const i = lower_bound(cache, event->window);
+
+	if (i == this->size || this->entries[i].x_window != event->window) return;
+
+	memmove(&this->entries[i], &this->entries[i + 1], sizeof(sl_cached_attributes_mutable) * (this->size - i - 1));
+	--this->size;
+}
+
+sl_cached_attributes sl_attribute_cache_get (sl_display* restrict display, Window x_window) {
+	sl_attribute_cache* const cache = (sl_attribute_cache*)&display->attribute_cache;
+	sl_attribute_cache_mutable* const this = (sl_attribute_cache_mutable*)cache;
+	sl_cached_attributes_mutable const* attributes = find(cache, x_window);
+
+	if (attributes) {
+		++this->hits;
+		return copy(attributes);
+	}
+
+	/*
+	  windows that existed before we selected SubstructureNotifyMask on their parent never sent us a CreateNotify. ask once and let the events
+	  keep the entry coherent from then on.
+	*/
+	++this->misses;
+	attribute_cache_log_va("[%lu] attribute cache miss", x_window);
+
+	XWindowAttributes x_attributes;
+	if (!XGetWindowAttributes(display->x_display, x_window, &x_attributes)) return (sl_cached_attributes) {.x_window = x_window};
+
+	sl_cached_attributes_mutable const fetched = (sl_cached_attributes_mutable) {
+	.x_window = x_window,
+	.x = x_attributes.x,
+	.y = x_attributes.y,
+	.width = x_attributes.width,
+	.height = x_attributes.height,
+	.border_width = x_attributes.border_width,
+	.override_redirect = x_attributes.override_redirect,
+	.mapped = x_attributes.map_state != IsUnmapped};
+
+	insert(cache, &fetched);
+
+	return copy(&fetched);
+}
+
+void sl_attribute_cache_log_statistics (M_maybe_unused sl_attribute_cache const* restrict this) {
+	log("attribute cache: %lu hits, %lu misses, %lu windows", this->hits, this->misses, this->size);
+}
@@ -0,0 +1,63 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/Xlib.h>
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+// the part of XWindowAttributes the event handlers need, kept up to date from structure events instead of asked for
+typedef struct sl_cached_attributes {
+	Window const x_window;
+	i32 const x;
+	i32 const y;
+	u32 const width;
+	u32 const height;
+	u32 const border_width;
+	bool const override_redirect;
+	bool const mapped;
+} sl_cached_attributes;
+
+typedef struct sl_attribute_cache {
+	sl_cached_attributes const* entries; // sorted by x_window
+	size_t const size;
+	size_t const allocated_size;
+
+	u64 const hits;
+	u64 const misses;
+} sl_attribute_cache;
+
+extern void sl_attribute_cache_create (sl_attribute_cache* restrict);
+extern void sl_attribute_cache_delete (sl_attribute_cache* restrict);
+
+extern void sl_attribute_cache_create_notify (sl_attribute_cache* restrict, XCreateWindowEvent const* restrict);
+extern void sl_attribute_cache_configure_notify (sl_attribute_cache* restrict, XConfigureEvent const* restrict);
+extern void sl_attribute_cache_gravity_notify (sl_attribute_cache* restrict, XGravityEvent const* restrict);
+extern void sl_attribute_cache_reparent_notify (sl_attribute_cache* restrict, XReparentEvent const* restrict);
+extern void sl_attribute_cache_map_notify (sl_attribute_cache* restrict, XMapEvent const* restrict);
+extern void sl_attribute_cache_unmap_notify (sl_attribute_cache* restrict, XUnmapEvent const* restrict);
+extern void sl_attribute_cache_destroy_notify (sl_attribute_cache* restrict, XDestroyWindowEvent const* restrict);
+
+extern sl_cached_attributes sl_attribute_cache_get (sl_display* restrict, Window);
+extern void sl_attribute_cache_log_statistics (sl_attribute_cache const* restrict);
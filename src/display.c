@@ -18,6 +18,8 @@
 
 #include "display.h"
 
+#include <stdlib.h>
+
 #include <X11/cursorfont.h>
 #include <X11/keysym.h>
 #include <X11/Xatom.h>
@@ -31,17 +33,43 @@
 
 typedef struct sl_display_mutable {
 	Display* x_display;
+	int screen;
 	Window root;
 	Cursor cursor;
 	sl_window_stack window_stack;
 	Atom atoms[atoms_size];
+	sl_atom_flag atom_flags[M_atom_flags_size];
+	Atom flag_atoms[64];
 	sl_window_dimensions dimensions;
+	sl_workarea workarea;
+	sl_outputs outputs;
 
 	uint numlockmask;
 
-	struct sl_u32_position mouse;
+	sl_timer timers[timers_size];
+	sl_process_priority process_priority;
+	sl_warm_pool warm_pool;
+	sl_media_control media_control;
+	sl_property_prefetch property_prefetch;
+	sl_attribute_cache attribute_cache;
+	sl_request_queue request_queue;
+	sl_ewmh_publisher ewmh_publisher;
+	sl_icon_cache icon_cache;
+	sl_rules rules;
+	sl_drag drag;
+	sl_sync_resize sync_resize;
+	sl_snap snap;
+	sl_placement placement;
+	sl_layout layout;
+	sl_low_latency low_latency;
 } sl_display_mutable;
 
+/*
+  every change of focus or workspace schedules an update of the process priorities, updates closer together than this are merged into one so that
+  cycling through windows does not turn into a flood of setpriority calls
+*/
+#define M_process_priority_update_interval (250 * M_nanoseconds_per_millisecond)
+
 static uint get_numlock_mask (Display* display) {
 	XModifierKeymap* modmap = XGetModifierMapping(display);
 	for (u8 i = 0; i < 8; i++) {
@@ -55,6 +83,99 @@ static uint get_numlock_mask (Display* display) {
 	assert_not_reached();
 }
 
+static struct {
+	u8 atom;
+	u64 flag;
+} const atom_flag_pairs[M_atom_flags_size] = {
+{net_wm_window_type_desktop,       window_type_desktop_bit                 },
+{net_wm_window_type_dock,          window_type_dock_bit                    },
+{net_wm_window_type_toolbar,       window_type_toolbar_bit                 },
+{net_wm_window_type_menu,          window_type_menu_bit                    },
+{net_wm_window_type_utility,       window_type_utility_bit                 },
+{net_wm_window_type_splash,        window_type_splash_bit                  },
+{net_wm_window_type_dialog,        window_type_dialog_bit                  },
+{net_wm_window_type_dropdown_menu, window_type_dropdown_menu_bit           },
+{net_wm_window_type_popup_menu,    window_type_popup_menu_bit              },
+{net_wm_window_type_tooltip,       window_type_tooltip_bit                 },
+{net_wm_window_type_notification,  window_type_notification_bit            },
+{net_wm_window_type_combo,         window_type_combo_bit                   },
+{net_wm_window_type_dnd,           window_type_dnd_bit                     },
+{net_wm_window_type_normal,        window_type_normal_bit                  },
+{net_wm_state_modal,               window_state_modal_bit                  },
+{net_wm_state_sticky,              window_state_sticky_bit                 },
+{net_wm_state_maximized_vert,      window_state_maximized_vert_bit         },
+{net_wm_state_maximized_horz,      window_state_maximized_horz_bit         },
+{net_wm_state_shaded,              window_state_shaded_bit                 },
+{net_wm_state_skip_taskbar,        window_state_skip_taskbar_bit           },
+{net_wm_state_skip_pager,          window_state_skip_pager_bit             },
+{net_wm_state_hidden,              window_state_hidden_bit                 },
+{net_wm_state_fullscreen,          window_state_fullscreen_bit             },
+{net_wm_state_above,               window_state_above_bit                  },
+{net_wm_state_below,               window_state_below_bit                  },
+{net_wm_state_demands_attention,   window_state_demands_attention_bit      },
+{net_wm_state_focused,             window_state_focused_bit                },
+{net_wm_action_move,               window_allowed_action_move_bit          },
+{net_wm_action_resize,             window_allowed_action_resize_bit        },
+{net_wm_action_minimize,           window_allowed_action_minimize_bit      },
+{net_wm_action_shade,              window_allowed_action_shade_bit         },
+{net_wm_action_stick,              window_allowed_action_stick_bit         },
+{net_wm_action_maximize_horz,      window_allowed_action_maximize_horz_bit },
+{net_wm_action_maximize_vert,      window_allowed_action_maximize_vert_bit },
+{net_wm_action_fullscreen,         window_allowed_action_fullscreen_bit    },
+{net_wm_action_change_desktop,     window_allowed_action_change_desktop_bit},
+{net_wm_action_close,              window_allowed_action_close_bit         },
+{net_wm_action_above,              window_allowed_action_above_bit         },
+{net_wm_action_below,              window_allowed_action_below_bit         },
+};
+
+static int compare_atom_flags (void const* a, void const* b) {
+	Atom const a_atom = ((sl_atom_flag const*)a)->atom;
+	Atom const b_atom = ((sl_atom_flag const*)b)->atom;
+
+	return (a_atom > b_atom) - (a_atom < b_atom);
+}
+
+static void create_atom_flags (sl_display_mutable* restrict display) {
+	for (size_t i = 0; i < 64; ++i)
+		display->flag_atoms[i] = None;
+
+	for (size_t i = 0; i < M_atom_flags_size; ++i) {
+		display->atom_flags[i] = (sl_atom_flag) {.atom = display->atoms[atom_flag_pairs[i].atom], .flag = atom_flag_pairs[i].flag};
+		display->flag_atoms[__builtin_ctzll(atom_flag_pairs[i].flag)] = display->atoms[atom_flag_pairs[i].atom];
+	}
+
+	qsort(display->atom_flags, M_atom_flags_size, sizeof(sl_atom_flag), &compare_atom_flags);
+}
+
+u64 sl_atom_to_flag (sl_display const* restrict this, Atom atom) {
+	sl_atom_flag const* const found =
+	bsearch(&(sl_atom_flag) {.atom = atom}, this->atom_flags, M_atom_flags_size, sizeof(sl_atom_flag), &compare_atom_flags);
+
+	return found ? found->flag : 0;
+}
+
+u64 sl_atom_list_to_flags (sl_display const* restrict this, Atom const* restrict atoms, size_t size, u64 mask) {
+	u64 flags = 0;
+
+	// the mask keeps an atom from the wrong list, a state in _NET_WM_WINDOW_TYPE for example, from setting a flag
+	for (size_t i = 0; i < size; ++i)
+		flags |= sl_atom_to_flag(this, atoms[i]) & mask;
+
+	return flags;
+}
+
+size_t sl_flags_to_atom_list (sl_display const* restrict this, u64 flags, Atom* restrict atoms) {
+	size_t size = 0;
+
+	// atoms has to have room for __builtin_popcountll(flags) atoms, flags without an atom are skipped
+	for (; flags; flags &= flags - 1) {
+		Atom const atom = this->flag_atoms[__builtin_ctzll(flags)];
+		if (atom != None) atoms[size++] = atom;
+	}
+
+	return size;
+}
+
 static void set_net_supported (sl_display* restrict display) {
 	/*
 	  _NET_SUPPORTED, ATOM[]/32
@@ -72,7 +193,7 @@ static void set_net_supported (sl_display* restrict display) {
 	);
 }
 
-sl_display* sl_display_create (Display* restrict x_display) {
+sl_display* sl_display_create (Display* restrict x_display, int screen) {
 	sl_display_mutable* display = malloc(sizeof(sl_display_mutable));
 	if (!display) {
 		warn_log("invalid allocation");
@@ -80,7 +201,8 @@ sl_display* sl_display_create (Display* restrict x_display) {
 	}
 
 	display->x_display = x_display;
-	display->root = DefaultRootWindow(x_display);
+	display->screen = screen;
+	display->root = RootWindow(x_display, screen);
 	display->cursor = XCreateFontCursor(display->x_display, XC_left_ptr);
 
 	sl_window_stack_create(&display->window_stack, 0);
@@ -91,9 +213,16 @@ sl_display* sl_display_create (Display* restrict x_display) {
 	}
 
 	XInternAtoms(x_display, (char**)atoms_string_list, atoms_size, false, display->atoms);
+	create_atom_flags(display);
 
 	display->dimensions =
-	(sl_window_dimensions) {.x = 0, .y = 0, .width = XDisplayWidth(display->x_display, 0), .height = XDisplayHeight(display->x_display, 0)};
+	(sl_window_dimensions) {.x = 0, .y = 0, .width = XDisplayWidth(display->x_display, screen), .height = XDisplayHeight(display->x_display, screen)};
+	sl_workarea_create(&display->workarea, display->dimensions);
+
+	// every output starts out showing a workspace of its own
+	sl_outputs_create(&display->outputs, x_display, display->root, display->dimensions);
+	while (display->window_stack.workspace_vector.size < display->outputs.size)
+		sl_window_stack_add_workspace(&display->window_stack);
 
 #ifdef D_debug
 	XSynchronize(display->x_display, true);
@@ -102,19 +231,70 @@ sl_display* sl_display_create (Display* restrict x_display) {
 	{
 		XSetWindowAttributes attributes;
 		attributes.cursor = display->cursor;
-		attributes.event_mask = ButtonPressMask | ButtonReleaseMask | PointerMotionMask | EnterWindowMask | LeaveWindowMask | StructureNotifyMask |
-		SubstructureNotifyMask | SubstructureRedirectMask | FocusChangeMask | PropertyChangeMask;
+		// no PointerMotionMask, the motion of a drag comes through its pointer grab and no other motion is wanted, nor are crossings of the root
+		attributes.event_mask =
+		ButtonPressMask | ButtonReleaseMask | StructureNotifyMask | SubstructureNotifyMask | SubstructureRedirectMask | FocusChangeMask | PropertyChangeMask;
 		XChangeWindowAttributes(display->x_display, display->root, CWEventMask | CWCursor, &attributes);
 	}
 
+	for (size_t i = 0; i < timers_size; ++i)
+		display->timers[i] = (sl_timer) {};
+	display->timers[timer_process_priority].callback = &sl_update_process_priorities;
+	display->timers[timer_volume].callback = &sl_media_flush_volume;
+	display->timers[timer_brightness].callback = &sl_media_flush_brightness;
+	display->timers[timer_drag].callback = &sl_drag_update;
+	display->timers[timer_sync_resize].callback = &sl_sync_resize_timeout;
+
+	sl_process_priority_create(&display->process_priority);
+	sl_warm_pool_create(&display->warm_pool);
+	sl_media_control_create(&display->media_control, (sl_display*)display);
+	sl_property_prefetch_create(&display->property_prefetch);
+	sl_attribute_cache_create(&display->attribute_cache);
+	sl_request_queue_create(&display->request_queue);
+	sl_ewmh_publisher_create(&display->ewmh_publisher);
+	sl_icon_cache_create(&display->icon_cache);
+	sl_rules_create(&display->rules);
+	sl_drag_create(&display->drag);
+	sl_sync_resize_create(&display->sync_resize, x_display);
+	sl_snap_create(&display->snap);
+	sl_placement_create(&display->placement);
+	sl_layout_create(&display->layout);
+	sl_low_latency_create(&display->low_latency);
+
+	{
+		char* const path = sl_rules_default_path();
+		sl_rules_load(&display->rules, path);
+		if (path) free(path);
+	}
+
 	sl_grab_keys((sl_display*)display);
 	set_net_supported((sl_display*)display);
 
+	sl_warm_pool_fill((sl_display*)display);
+
 	return (sl_display*)display;
 }
 
 void sl_display_delete (sl_display* restrict this) {
+	sl_rules_delete((sl_rules*)&this->rules);
+	sl_sync_resize_delete((sl_sync_resize*)&this->sync_resize, this->x_display);
+	sl_drag_delete((sl_drag*)&this->drag, this->x_display);
+	sl_snap_delete((sl_snap*)&this->snap);
+	sl_placement_delete((sl_placement*)&this->placement);
+	sl_layout_delete((sl_layout*)&this->layout);
+	sl_low_latency_delete((sl_low_latency*)&this->low_latency);
+	sl_icon_cache_delete((sl_icon_cache*)&this->icon_cache);
+	sl_ewmh_publisher_delete((sl_ewmh_publisher*)&this->ewmh_publisher);
+	sl_request_queue_delete((sl_request_queue*)&this->request_queue, this);
+	sl_attribute_cache_delete((sl_attribute_cache*)&this->attribute_cache);
+	sl_property_prefetch_delete((sl_property_prefetch*)&this->property_prefetch, this);
+	sl_media_control_delete((sl_media_control*)&this->media_control);
+	sl_warm_pool_delete((sl_warm_pool*)&this->warm_pool);
+	sl_process_priority_delete((sl_process_priority*)&this->process_priority);
+
 	sl_window_stack_delete((sl_window_stack*)&this->window_stack);
+	sl_workarea_delete((sl_workarea*)&this->workarea);
+	sl_outputs_delete((sl_outputs*)&this->outputs);
 
 	XFreeCursor(this->x_display, this->cursor);
 
@@ -127,6 +307,14 @@ void sl_grab_keys (sl_display* restrict this) {
 
 	this->numlockmask = get_numlock_mask(x_display);
 	uint const modifiers[] = {0, this->numlockmask, LockMask, this->numlockmask | LockMask};
+
+	// in front of a fullscreen window only the keys with super and the media keys are kept, the others are likely to be the window's own
+#ifdef D_low_latency_ungrab_keys
+	bool const all_grabs = !this->low_latency.active;
+#else
+	bool const all_grabs = true;
+#endif
+
 	XUngrabKey(x_display, AnyKey, AnyModifier, root);
 	for (u8 i = 0; i < 4; ++i) {
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XF86XK_AudioLowerVolume), modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
@@ -134,7 +322,7 @@ void sl_grab_keys (sl_display* restrict this) {
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XF86XK_AudioMute), modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XF86XK_MonBrightnessDown), modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XF86XK_MonBrightnessUp), modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
-		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Print), modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
+		if (all_grabs) XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Print), modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XF86XK_AudioLowerVolume), ShiftMask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XF86XK_AudioRaiseVolume), ShiftMask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
@@ -150,6 +338,8 @@ void sl_grab_keys (sl_display* restrict this) {
 
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_m), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_c), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
+		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_o), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
+		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_space), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Tab), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_t), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
@@ -173,7 +363,7 @@ void sl_grab_keys (sl_display* restrict this) {
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_KP_Add), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_KP_Subtract), Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 
-		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Tab), Mod1Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
+		if (all_grabs) XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Tab), Mod1Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Tab), ShiftMask | Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 
@@ -193,7 +383,17 @@ void sl_grab_keys (sl_display* restrict this) {
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Right), ControlMask | Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Left), ControlMask | Mod4Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
 
-		XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Tab), ShiftMask | Mod1Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
+		if (all_grabs)
+			XGrabKey(x_display, XKeysymToKeycode(x_display, XK_Tab), ShiftMask | Mod1Mask | modifiers[i], root, true, GrabModeAsync, GrabModeAsync);
+	}
+
+	// once on the root instead of on every window, the press lands on the root with the window under the pointer as its subwindow
+	XUngrabButton(x_display, AnyButton, AnyModifier, root);
+	for (u8 i = 0; i < 4 && all_grabs; ++i) {
+		XGrabButton(x_display, Button1, Mod4Mask | modifiers[i], root, false, ButtonPressMask | ButtonReleaseMask, GrabModeAsync, GrabModeAsync, None, None);
+		XGrabButton(
+		x_display, Button1, Mod4Mask | ControlMask | modifiers[i], root, false, ButtonPressMask | ButtonReleaseMask, GrabModeAsync, GrabModeAsync, None, None
+		);
 	}
 }
 
@@ -227,6 +427,20 @@ static void focus_window_impl (sl_display* restrict this, sl_window* restrict wi
 
 static void raise_window_impl (sl_display* restrict this, sl_window* restrict window) { XRaiseWindow(this->x_display, window->x_window); }
 
+static void raise_group_impl (sl_display* restrict this, size_t index) {
+	size_t const size = sl_window_stack_raise_group((sl_window_stack*)&this->window_stack, index);
+
+	if (size == 0) return;
+
+	// the group is now the top of the workspace, it goes to the server as one restack instead of a raise per window
+	Window windows[size];
+	for (size_t i = 0, j = sl_window_stack_get_raised_window_index((sl_window_stack*)&this->window_stack); i < size; ++i, j = this->window_stack.data[j].previous)
+		windows[i] = this->window_stack.data[j].window.x_window;
+
+	XRaiseWindow(this->x_display, windows[0]);
+	if (size > 1) XRestackWindows(this->x_display, windows, size);
+}
+
 static void delete_window_impl (sl_display* this, sl_window* restrict window, Time time) {
 	if (!(window->flags & window_protocols_delete_window_bit)) {
 		XKillClient(this->x_display, window->x_window);
@@ -251,6 +465,15 @@ static void delete_window_impl (sl_display* this, sl_window* restrict window, Ti
 	XSendEvent(this->x_display, window->x_window, false, 0, (XEvent*)&event);
 }
 
+static void schedule_process_priority_update (sl_display* restrict this) {
+	if (sl_timer_is_armed(&this->timers[timer_process_priority])) return;
+
+	u64 const now = sl_monotonic_time();
+	u64 const earliest = this->process_priority.last_update + M_process_priority_update_interval;
+
+	sl_timer_arm(&this->timers[timer_process_priority], max(now, earliest));
+}
+
 void sl_cycle_windows_up (sl_display* restrict this, Time time) {
 	sl_window_stack_cycle_up((sl_window_stack*)&this->window_stack);
 
@@ -273,73 +496,100 @@ void sl_cycle_windows_down (sl_display* restrict this, Time time) {
 	}
 }
 
-static void map_windows_for_current_workspace (sl_display* restrict this) {
-	if (!sl_window_stack_is_valid_index(sl_window_stack_get_raised_window_index((sl_window_stack*)&this->window_stack))) return;
+void sl_map_workspace (sl_display* restrict this, workspace_type workspace) {
+	size_t const raised = this->window_stack.workspace_vector.indexes[workspace];
+	if (!sl_window_stack_is_valid_index(raised)) return;
 
-	for (size_t i = this->window_stack.data[this->window_stack.workspace_vector.indexes[this->window_stack.current_workspace]].next;;
-	     i = this->window_stack.data[i].next) {
+	for (size_t i = this->window_stack.data[raised].next;; i = this->window_stack.data[i].next) {
 		XMapWindow(this->x_display, this->window_stack.data[i].window.x_window);
 
-		if (i == this->window_stack.workspace_vector.indexes[this->window_stack.current_workspace]) break;
+		if (i == raised) break;
 	}
 }
 
-static void unmap_windows_for_current_workspace (sl_display* restrict this) {
-	if (!sl_window_stack_is_valid_index(sl_window_stack_get_raised_window_index((sl_window_stack*)&this->window_stack))) return;
+void sl_unmap_workspace (sl_display* restrict this, workspace_type workspace) {
+	size_t const raised = this->window_stack.workspace_vector.indexes[workspace];
+	if (!sl_window_stack_is_valid_index(raised)) return;
 
-	for (size_t i = this->window_stack.data[this->window_stack.workspace_vector.indexes[this->window_stack.current_workspace]].next;;
-	     i = this->window_stack.data[i].next) {
+	for (size_t i = this->window_stack.data[raised].next;; i = this->window_stack.data[i].next) {
 		XUnmapWindow(this->x_display, this->window_stack.data[i].window.x_window);
 
-		if (i == this->window_stack.workspace_vector.indexes[this->window_stack.current_workspace]) break;
+		if (i == raised) break;
 	}
 }
 
-void sl_next_workspace (sl_display* restrict this, Time time) {
-	if (this->window_stack.workspace_vector.size == 1) return;
+void sl_focus_workspace (sl_display* restrict this, workspace_type workspace) {
+	if (workspace == this->window_stack.current_workspace) return;
 
-	unmap_windows_for_current_workspace(this);
-	sl_window_stack_cycle_workspace_up((sl_window_stack*)&this->window_stack);
-	map_windows_for_current_workspace(this);
+	sl_window_stack_set_current_workspace((sl_window_stack*)&this->window_stack, workspace);
 
-	sl_focus_raised_window(this, time);
+	schedule_process_priority_update(this);
 }
 
-void sl_previous_workspace (sl_display* restrict this, Time time) {
-	if (this->window_stack.workspace_vector.size == 1) return;
+// only the windows of the output are mapped and unmapped, the other outputs keep showing what they did
+static void show_on_output (sl_display* restrict this, size_t output, workspace_type workspace) {
+	sl_unmap_workspace(this, this->outputs.data[output].workspace);
+	sl_outputs_show((sl_outputs*)&this->outputs, output, workspace);
+	sl_map_workspace(this, workspace);
+
+	sl_window_stack_set_current_workspace((sl_window_stack*)&this->window_stack, workspace);
+}
 
-	unmap_windows_for_current_workspace(this);
-	sl_window_stack_cycle_workspace_down((sl_window_stack*)&this->window_stack);
-	map_windows_for_current_workspace(this);
+// the next workspace in the set of the output that no other output shows, the one it shows already when there is none
+static workspace_type next_in_set (sl_display const* restrict this, size_t output, bool up) {
+	workspace_type const size = this->window_stack.workspace_vector.size;
+	workspace_type const workspace = this->outputs.data[output].workspace;
+
+	for (workspace_type k = 1; k < size; ++k) {
+		workspace_type const candidate = up ? (workspace + k) % size : (workspace + size - k) % size;
+
+		if (sl_outputs_owner(&this->outputs, candidate) == output && sl_outputs_showing(&this->outputs, candidate) == (size_t)-1) return candidate;
+	}
+
+	return workspace;
+}
+
+static void step_workspace (sl_display* restrict this, bool up, Time time) {
+	size_t const output = sl_outputs_focused(this);
+	workspace_type const workspace = next_in_set(this, output, up);
+
+	if (workspace == this->outputs.data[output].workspace) return;
+
+	show_on_output(this, output, workspace);
+
+	schedule_process_priority_update(this);
 
 	sl_focus_raised_window(this, time);
 }
 
+void sl_next_workspace (sl_display* restrict this, Time time) { return step_workspace(this, true, time); }
+
+void sl_previous_workspace (sl_display* restrict this, Time time) { return step_workspace(this, false, time); }
+
 void sl_push_workspace (sl_display* restrict this) { return sl_window_stack_add_workspace((sl_window_stack*)&this->window_stack); }
 
 void sl_pop_workspace (sl_display* restrict this, Time time) {
-	if (this->window_stack.workspace_vector.size <= 1) return;
+	// every output has to be left with a workspace to show
+	if (this->window_stack.workspace_vector.size <= max(1, this->outputs.size)) return;
 
-	if (this->window_stack.current_workspace == this->window_stack.workspace_vector.size - 1) {
-		if (sl_window_stack_is_valid_index(this->window_stack.workspace_vector.indexes[this->window_stack.workspace_vector.size - 2]))
-			for (size_t i = this->window_stack.data[this->window_stack.workspace_vector.indexes[this->window_stack.workspace_vector.size - 2]].next;;
-			     i = this->window_stack.data[i].next) {
-				XMapWindow(this->x_display, this->window_stack.data[i].window.x_window);
+	workspace_type const last = this->window_stack.workspace_vector.size - 1;
+	size_t const last_output = sl_outputs_showing(&this->outputs, last);
+	size_t const below_output = sl_outputs_showing(&this->outputs, last - 1);
 
-				if (i == this->window_stack.workspace_vector.indexes[this->window_stack.workspace_vector.size - 2]) break;
-			}
-	} else if (this->window_stack.current_workspace == this->window_stack.workspace_vector.size - 2) {
-		if (sl_window_stack_is_valid_index(this->window_stack.workspace_vector.indexes[this->window_stack.workspace_vector.size - 1]))
-			for (size_t i = this->window_stack.data[this->window_stack.workspace_vector.indexes[this->window_stack.workspace_vector.size - 1]].next;;
-			     i = this->window_stack.data[i].next) {
-				XMapWindow(this->x_display, this->window_stack.data[i].window.x_window);
+	// the windows of the last workspace go to the one below it, which cannot happen while the two are shown on different outputs
+	if (last_output != (size_t)-1 && below_output != (size_t)-1) return;
 
-				if (i == this->window_stack.workspace_vector.indexes[this->window_stack.workspace_vector.size - 1]) break;
-			}
+	if (last_output != (size_t)-1) {
+		sl_map_workspace(this, last - 1);
+		sl_outputs_show((sl_outputs*)&this->outputs, last_output, last - 1);
+	} else if (below_output != (size_t)-1) {
+		sl_map_workspace(this, last);
 	}
 
 	sl_window_stack_remove_workspace((sl_window_stack*)&this->window_stack);
 
+	schedule_process_priority_update(this);
+
 	sl_focus_raised_window(this, time);
 }
 
@@ -348,43 +598,61 @@ void sl_switch_to_workspace (sl_display* restrict this, workspace_type workspace
 	if (workspace >= this->window_stack.workspace_vector.size) return;
 	if (this->window_stack.workspace_vector.size == 1) return;
 
-	unmap_windows_for_current_workspace(this);
-	sl_window_stack_set_current_workspace((sl_window_stack*)&this->window_stack, workspace);
-	map_windows_for_current_workspace(this);
+	// a workspace is shown on the output whose set it is in, or where it is already shown, the focus follows it there
+	if (sl_outputs_showing(&this->outputs, workspace) == (size_t)-1) show_on_output(this, sl_outputs_owner(&this->outputs, workspace), workspace);
+	else sl_window_stack_set_current_workspace((sl_window_stack*)&this->window_stack, workspace);
+
+	schedule_process_priority_update(this);
 
 	sl_focus_raised_window(this, time);
 }
 
-void sl_next_workspace_with_raised_window (sl_display* restrict this) {
-	if (this->window_stack.workspace_vector.size == 1) return;
+static void move_raised_group_to_workspace (sl_display* restrict this, bool up) {
+	sl_window_stack* const window_stack = (sl_window_stack*)&this->window_stack;
 
-	size_t index = this->window_stack.workspace_vector.indexes[this->window_stack.current_workspace];
+	size_t const raised = sl_window_stack_get_raised_window_index(window_stack);
+	if (!sl_window_stack_is_valid_index(raised)) return;
 
-	sl_window_stack_remove_window_from_its_workspace((sl_window_stack*)&this->window_stack, index);
+	size_t const output = sl_outputs_focused(this);
+	workspace_type const workspace = this->window_stack.current_workspace;
+	workspace_type const target = next_in_set(this, output, up);
 
-	unmap_windows_for_current_workspace(this);
-	sl_window_stack_cycle_workspace_up((sl_window_stack*)&this->window_stack);
-	map_windows_for_current_workspace(this);
+	if (target == workspace) return;
 
-	sl_window_stack_add_window_to_current_workspace((sl_window_stack*)&this->window_stack, index);
+	// the whole group the raised window belongs to goes along, its windows that are shown here at least
+	size_t const root = sl_window_stack_get_group_root(window_stack, raised);
 
-	raise_window_impl(this, (sl_window*)&this->window_stack.data[index].window);
-}
+	size_t size = 0;
+	for (size_t i = root; sl_window_stack_is_valid_index(i); i = sl_window_stack_get_next_in_group(window_stack, root, i))
+		if (sl_window_stack_is_in_workspace(window_stack, i, workspace)) ++size;
 
-void sl_previous_workspace_with_raised_window (sl_display* restrict this) {
-	if (this->window_stack.workspace_vector.size == 1) return;
+	size_t indexes[size];
+	for (size_t i = root, j = 0; sl_window_stack_is_valid_index(i); i = sl_window_stack_get_next_in_group(window_stack, root, i))
+		if (sl_window_stack_is_in_workspace(window_stack, i, workspace)) indexes[j++] = i;
 
-	size_t index = this->window_stack.workspace_vector.indexes[this->window_stack.current_workspace];
+	for (size_t i = 0; i < size; ++i)
+		sl_window_stack_remove_window_from_its_workspace(window_stack, indexes[i]);
 
-	sl_window_stack_remove_window_from_its_workspace((sl_window_stack*)&this->window_stack, index);
+	show_on_output(this, output, target);
 
-	unmap_windows_for_current_workspace(this);
-	sl_window_stack_cycle_workspace_down((sl_window_stack*)&this->window_stack);
-	map_windows_for_current_workspace(this);
+	for (size_t i = 0; i < size; ++i)
+		sl_window_stack_add_window_to_current_workspace(window_stack, indexes[i]);
 
-	sl_window_stack_add_window_to_current_workspace((sl_window_stack*)&this->window_stack, index);
+	schedule_process_priority_update(this);
 
-	raise_window_impl(this, (sl_window*)&this->window_stack.data[index].window);
+	raise_group_impl(this, root);
+}
+
+void sl_next_workspace_with_raised_window (sl_display* restrict this) {
+	if (this->window_stack.workspace_vector.size == 1) return;
+
+	move_raised_group_to_workspace(this, true);
+}
+
+void sl_previous_workspace_with_raised_window (sl_display* restrict this) {
+	if (this->window_stack.workspace_vector.size == 1) return;
+
+	move_raised_group_to_workspace(this, false);
 }
 
 void sl_focus_window (sl_display* restrict this, size_t index, Time time) {
@@ -402,9 +670,7 @@ void sl_raise_window (sl_display* restrict this, size_t index) {
 
 	if (raised_window == window) return;
 
-	sl_window_stack_set_raised_window((sl_window_stack*)&this->window_stack, index);
-
-	raise_window_impl(this, window);
+	raise_group_impl(this, index);
 }
 
 void sl_focus_and_raise_window (sl_display* restrict display, size_t index, Time time) {
@@ -435,6 +701,8 @@ void sl_set_window_as_focused (sl_display* restrict this, size_t index) {
 	.data = {.l = {M_net_wm_state_add, this->atoms[net_wm_state_focused], 0, 0, 0}}};
 
 	XSendEvent(this->x_display, this->root, false, 0, (XEvent*)&event);
+
+	schedule_process_priority_update(this);
 }
 
 void sl_unset_x_window_as_focused (sl_display* restrict this, Window x_window) {
@@ -452,9 +720,38 @@ void sl_unset_x_window_as_focused (sl_display* restrict this, Window x_window) {
 	.data = {.l = {M_net_wm_state_remove, this->atoms[net_wm_state_focused], 0, 0, 0}}};
 
 	XSendEvent(this->x_display, this->root, false, 0, (XEvent*)&event);
+
+	schedule_process_priority_update(this);
 }
 
-static void send_new_dimensions_to_window (sl_display* restrict this, sl_window* restrict window) {
+void sl_update_process_priorities (sl_display* restrict this) {
+	sl_process_priority* const process_priority = (sl_process_priority*)&this->process_priority;
+
+	sl_process_priority_begin(process_priority);
+
+	for (workspace_type j = 0; j < this->window_stack.workspace_vector.size; ++j) {
+		if (!sl_window_stack_is_valid_index(this->window_stack.workspace_vector.indexes[j])) continue;
+
+		u8 const class = sl_outputs_showing(&this->outputs, j) != (size_t)-1 ? process_priority_neutral : process_priority_background;
+
+		for (size_t i = this->window_stack.data[this->window_stack.workspace_vector.indexes[j]].next;; i = this->window_stack.data[i].next) {
+			sl_window const* const window = &this->window_stack.data[i].window;
+
+			if (!this->window_stack.data[i].flagged_for_deletion)
+				sl_process_priority_set(process_priority, window->pid, window->flags & window_keep_priority_bit ? process_priority_neutral : class);
+
+			if (i == this->window_stack.workspace_vector.indexes[j]) break;
+		}
+	}
+
+	sl_window* const focused_window = sl_window_stack_get_focused_window((sl_window_stack*)&this->window_stack);
+
+	if (focused_window) sl_process_priority_set(process_priority, focused_window->pid, process_priority_focused);
+
+	sl_process_priority_end(process_priority);
+}
+
+void sl_send_window_dimensions (sl_display* restrict this, sl_window* restrict window) {
 	/*
 	  Inter-Client Communication Conventions Manual: Chapter 4. Client-to-Window-Manager Communication: Client Responses to Window Manager Actions:
 
@@ -512,53 +809,106 @@ static void send_new_dimensions_to_window (sl_display* restrict this, sl_window*
 	XSendEvent(this->x_display, window->x_window, false, StructureNotifyMask, (XEvent*)&configure_event);
 }
 
+void sl_move_window_group (sl_display* restrict this, size_t index, i16 x, i16 y) {
+	sl_window const* const leader = (sl_window*)&this->window_stack.data[index].window;
+	i16 const dx = x - leader->dimensions.x;
+	i16 const dy = y - leader->dimensions.y;
+
+	if (dx == 0 && dy == 0) return;
+
+	// followers keep their place relative to the leader, the moves are flushed together with the rest of the batch
+	for (size_t i = index; sl_window_stack_is_valid_index(i); i = sl_window_stack_get_next_in_group((sl_window_stack*)&this->window_stack, index, i)) {
+		sl_window* const window = (sl_window*)&this->window_stack.data[i].window;
+		sl_move_window(this, window, window->dimensions.x + dx, window->dimensions.y + dy);
+	}
+}
+
 void sl_move_window (sl_display* restrict this, sl_window* restrict window, i16 x, i16 y) {
 	if (window->flags & window_type_splash_bit) return;
 	if (window->dimensions.x == x && window->dimensions.y == y) return;
 
 	window->dimensions.x = x;
 	window->dimensions.y = y;
+	sl_snap_update(this, window->x_window, window->dimensions);
 
 	XMoveWindow(this->x_display, window->x_window, window->dimensions.x, window->dimensions.y);
 
-	send_new_dimensions_to_window(this, window);
+	sl_send_window_dimensions(this, window);
 }
 
-void sl_resize_window (sl_display* restrict this, sl_window* restrict window, u16 width, u16 height) {
-	if (window->flags & window_type_splash_bit) return;
+/*
+  Inter-Client Communication Conventions Manual: Chapter 4. Client-to-Window-Manager Communication: Client Properties: WM_NORMAL_HINTS Property:
+
+  The min_aspect and max_aspect fields are fractions with the numerator first and
+  the denominator second, and they allow a client to specify the range of aspect
+  ratios it prefers. Window managers that honor aspect ratios should take into
+  account the base size in determining the preferred window size. If a base size is
+  provided along with the aspect ratio fields, the base size should be subtracted from
+  the window size prior to checking that the aspect ratio falls in range. If a base size
+  is not provided, nothing should be subtracted from the window size. (The minimum
+  size is not to be used in place of the base size for this purpose.)
+*/
+void sl_constrain_window_size (sl_window const* restrict window, u16* restrict width, u16* restrict height) {
+	// when there is no base size it was set to the minimum one, which then only counts for the increments
+	bool const base_is_min = window->normal_hints.base_width == window->normal_hints.min_width && window->normal_hints.base_height == window->normal_hints.min_height;
 
-	if (window->normal_hints.min_width != 0) {
-		if (window->normal_hints.max_width != 0) {
-			width = min(window->normal_hints.max_width, max(window->normal_hints.min_width, width));
-		} else {
-			width = max(window->normal_hints.min_width, width);
-		}
-	} else {
-		if (window->normal_hints.max_width != 0) {
-			width = min(window->normal_hints.max_width, width);
-		}
+	i32 w = *width, h = *height;
+
+	if (!base_is_min) {
+		w = max(0, w - window->normal_hints.base_width);
+		h = max(0, h - window->normal_hints.base_height);
 	}
 
-	if (window->normal_hints.min_height != 0) {
-		if (window->normal_hints.max_height != 0) {
-			height = min(window->normal_hints.max_height, max(window->normal_hints.min_height, height));
-		} else {
-			height = max(window->normal_hints.min_height, height);
-		}
-	} else {
-		if (window->normal_hints.max_height != 0) {
-			height = min(window->normal_hints.max_height, height);
+	if (window->normal_hints.min_aspect.numerator && window->normal_hints.min_aspect.denominator && window->normal_hints.max_aspect.numerator &&
+	    window->normal_hints.max_aspect.denominator) {
+		if ((i64)w * window->normal_hints.max_aspect.denominator > (i64)h * window->normal_hints.max_aspect.numerator) {
+			w = (i64)h * window->normal_hints.max_aspect.numerator / window->normal_hints.max_aspect.denominator;
+		} else if ((i64)w * window->normal_hints.min_aspect.denominator < (i64)h * window->normal_hints.min_aspect.numerator) {
+			h = (i64)w * window->normal_hints.min_aspect.denominator / window->normal_hints.min_aspect.numerator;
 		}
 	}
 
+	if (base_is_min) {
+		w = max(0, w - window->normal_hints.base_width);
+		h = max(0, h - window->normal_hints.base_height);
+	}
+
+	if (window->normal_hints.width_inc) w -= w % window->normal_hints.width_inc;
+	if (window->normal_hints.height_inc) h -= h % window->normal_hints.height_inc;
+
+	w += window->normal_hints.base_width;
+	h += window->normal_hints.base_height;
+
+	if (window->normal_hints.min_width != 0) w = max(window->normal_hints.min_width, w);
+	if (window->normal_hints.min_height != 0) h = max(window->normal_hints.min_height, h);
+	if (window->normal_hints.max_width != 0) w = min(window->normal_hints.max_width, w);
+	if (window->normal_hints.max_height != 0) h = min(window->normal_hints.max_height, h);
+
+	*width = max(1, w);
+	*height = max(1, h);
+}
+
+void sl_resize_window (sl_display* restrict this, sl_window* restrict window, u16 width, u16 height) {
+	if (window->flags & window_type_splash_bit) return;
+
+	sl_constrain_window_size(window, &width, &height);
+
 	if (window->dimensions.width == width && window->dimensions.height == height) return;
 
 	window->dimensions.width = width;
 	window->dimensions.height = height;
+	sl_snap_update(this, window->x_window, window->dimensions);
+
+	sl_commit_window_size(this, window);
+}
+
+void sl_commit_window_size (sl_display* restrict this, sl_window* restrict window) {
+	// a client still drawing the size before gets this one when it is done, by then it may well have been replaced by a newer one
+	if (sl_sync_resize_hold(this, window)) return;
 
 	XResizeWindow(this->x_display, window->x_window, window->dimensions.width, window->dimensions.height);
 
-	send_new_dimensions_to_window(this, window);
+	sl_send_window_dimensions(this, window);
 }
 
 void sl_move_and_resize_window (sl_display* restrict this, sl_window* restrict window, sl_window_dimensions dimensions) {
@@ -567,44 +917,79 @@ void sl_move_and_resize_window (sl_display* restrict this, sl_window* restrict w
 		return;
 
 	window->dimensions = dimensions;
+	sl_snap_update(this, window->x_window, window->dimensions);
 
 	XMoveResizeWindow(
 	this->x_display, window->x_window, window->dimensions.x, window->dimensions.y, window->dimensions.width, window->dimensions.height
 	);
 
-	send_new_dimensions_to_window(this, window);
+	sl_send_window_dimensions(this, window);
 }
 
 void sl_window_fullscreen_change_response (sl_display* restrict this, sl_window* restrict window) {
 	if ((window->flags & window_state_fullscreen_bit) != 0)
-		sl_move_and_resize_window(this, window, this->dimensions);
+		sl_move_and_resize_window(this, window, this->outputs.data[sl_outputs_of_window(this, window)].geometry);
 	else
 		sl_move_and_resize_window(this, window, window->saved_dimensions);
+
+	sl_layout_mark_dirty(this); // a fullscreen window leaves its cell to the others
 }
 
 void sl_window_maximized_change_response (sl_display* restrict this, sl_window* restrict window) {
 	if ((window->flags & window_state_fullscreen_bit) != 0) return;
 
+	sl_window_dimensions const area = sl_outputs_area(this, sl_outputs_of_window(this, window));
+
 	if (window->flags & window_state_maximized_horz_bit) {
-		if (window->flags & window_state_maximized_vert_bit) return sl_move_and_resize_window(this, window, this->dimensions);
+		if (window->flags & window_state_maximized_vert_bit) return sl_move_and_resize_window(this, window, area);
 
 		return sl_move_and_resize_window(
-		this, window,
-		(sl_window_dimensions
-		) {.x = this->dimensions.x, .y = window->saved_dimensions.y, .width = this->dimensions.width, .height = window->saved_dimensions.height}
+		this, window, (sl_window_dimensions) {.x = area.x, .y = window->saved_dimensions.y, .width = area.width, .height = window->saved_dimensions.height}
 		);
 	}
 
 	if (window->flags & window_state_maximized_vert_bit)
 		return sl_move_and_resize_window(
-		this, window,
-		(sl_window_dimensions
-		) {.x = window->saved_dimensions.x, .y = this->dimensions.y, .width = window->saved_dimensions.width, .height = this->dimensions.height}
+		this, window, (sl_window_dimensions) {.x = window->saved_dimensions.x, .y = area.y, .width = window->saved_dimensions.width, .height = area.height}
 		);
 
 	sl_move_and_resize_window(this, window, window->saved_dimensions);
 }
 
+void sl_workarea_change_response (sl_display* restrict this) {
+	sl_layout_mark_dirty(this); // a strut can move the area of one output and leave the one of the screen as it was
+
+	// fullscreen windows cover the panels anyway, only the maximized ones follow the workarea
+	for (size_t i = 0; i < this->window_stack.size; ++i) {
+		sl_window* const window = (sl_window*)&this->window_stack.data[i].window;
+
+		if (this->window_stack.data[i].flagged_for_deletion || !sl_window_stack_is_valid_index(this->window_stack.data[i].next)) continue;
+		if (!(window->flags & (window_state_maximized_horz_bit | window_state_maximized_vert_bit))) continue;
+
+		sl_window_maximized_change_response(this, window);
+	}
+}
+
+workspace_type sl_apply_window_rules (sl_display* restrict this, sl_window* restrict window) {
+	sl_rule const* const rule = sl_rules_match((sl_rules*)&this->rules, window->instance, window->class);
+
+	if (!rule) return this->window_stack.current_workspace;
+
+	if (rule->actions & rule_floating) window->flags |= window_floating_bit;
+	if (rule->actions & rule_keep_priority) window->flags |= window_keep_priority_bit;
+
+	if (rule->actions & rule_fullscreen) {
+		window->saved_dimensions = window->dimensions;
+		sl_window_set_fullscreen(window, this, true);
+		sl_window_fullscreen_change_response(this, window);
+	}
+
+	// a workspace that does not exist yet is ignored rather than created
+	if ((rule->actions & rule_workspace) && rule->workspace < this->window_stack.workspace_vector.size) return rule->workspace;
+
+	return this->window_stack.current_workspace;
+}
+
 void sl_maximize_raised_window (sl_display* restrict this) {
 	sl_window* window = sl_window_stack_get_raised_window((sl_window_stack*)&this->window_stack);
 
@@ -621,25 +1006,32 @@ void sl_expand_raised_window_to_max (sl_display* restrict this) {
 
 	if (window->flags & window_state_fullscreen_bit) return; // do nothing
 
-	window->saved_dimensions = this->dimensions;
+	sl_window_dimensions const area = sl_outputs_area(this, sl_outputs_of_window(this, window));
 
-	return sl_move_and_resize_window(this, window, this->dimensions);
+	window->saved_dimensions = area;
+
+	return sl_move_and_resize_window(this, window, area);
 }
 
 void sl_close_raised_window (sl_display* restrict this, Time time) { return sl_delete_raised_window(this, time); }
 
-void sl_delete_window (sl_display* restrict this, size_t index, Time time) {
-	sl_window* window = (sl_window*)&this->window_stack.data[index].window;
+static void delete_group_impl (sl_display* restrict this, size_t index, Time time) {
+	// closing a leader closes the dialogs it has open as well
+	for (size_t i = index; sl_window_stack_is_valid_index(i); i = sl_window_stack_get_next_in_group((sl_window_stack*)&this->window_stack, index, i)) {
+		sl_window* const window = (sl_window*)&this->window_stack.data[i].window;
 
-	if (window->flags & (window_state_normal_bit | window_state_iconified_bit)) delete_window_impl(this, window, time);
+		if (window->flags & (window_state_normal_bit | window_state_iconified_bit)) delete_window_impl(this, window, time);
+	}
 }
 
+void sl_delete_window (sl_display* restrict this, size_t index, Time time) { delete_group_impl(this, index, time); }
+
 void sl_delete_raised_window (sl_display* restrict this, Time time) {
-	sl_window* window = sl_window_stack_get_raised_window((sl_window_stack*)&this->window_stack);
+	size_t const index = sl_window_stack_get_raised_window_index((sl_window_stack*)&this->window_stack);
 
-	if (!window) return;
+	if (!sl_window_stack_is_valid_index(index)) return;
 
-	delete_window_impl(this, window, time);
+	delete_group_impl(this, index, time);
 }
 
 void sl_delete_all_windows (sl_display* restrict this, Time time) {
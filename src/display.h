@@ -20,9 +20,27 @@
 
 #include <X11/Xlib.h>
 
+#include "attribute-cache.h"
+#include "drag.h"
+#include "ewmh-publisher.h"
+#include "icon-cache.h"
+#include "layout.h"
+#include "low-latency.h"
+#include "media-control.h"
 #include "message.h"
+#include "output.h"
+#include "placement.h"
+#include "process-priority.h"
+#include "property.h"
+#include "request-queue.h"
+#include "rules.h"
+#include "snap.h"
+#include "sync-resize.h"
+#include "timer.h"
+#include "warm-pool.h"
 #include "window-dimensions.h"
 #include "window-stack.h"
+#include "workarea.h"
 #include "workspace-type.h"
 
 enum {
@@ -33,8 +51,15 @@ enum {
 	wm_delete_window,
 	wm_change_state,
 	net_supported,
+	net_client_list,
+	net_client_list_stacking,
+	net_number_of_desktops,
+	net_current_desktop,
+	net_active_window,
+	net_workarea,
 	net_wm_ping,
 	net_wm_sync_request,
+	net_wm_sync_request_counter,
 	net_wm_fullscreen_monitors,
 	net_wm_name,
 	net_wm_visible_name,
@@ -105,8 +130,15 @@ static char* const atoms_string_list[] = {
 "WM_DELETE_WINDOW",
 "WM_CHANGE_STATE",
 "_NET_SUPPORTED",
+"_NET_CLIENT_LIST",
+"_NET_CLIENT_LIST_STACKING",
+"_NET_NUMBER_OF_DESKTOPS",
+"_NET_CURRENT_DESKTOP",
+"_NET_ACTIVE_WINDOW",
+"_NET_WORKAREA",
 "_NET_WM_PING",
 "_NET_WM_SYNC_REQUEST",
+"_NET_WM_SYNC_REQUEST_COUNTER",
 "_NET_WM_FULLSCREEN_MONITORS",
 "_NET_WM_NAME",
 "_NET_WM_VISIBLE_NAME",
@@ -158,7 +190,7 @@ static char* const atoms_string_list[] = {
 "_NET_WM_STRUT",
 "_NET_WM_STRUT_PARTIAL",
 "_NET_WM_ICON_GEOMETRY",
-"_MET_WM_ICON",
+"_NET_WM_ICON",
 "_NET_WM_PID",
 "_NET_WM_HANDLED_ICONS",
 "_NET_WM_USER_TIME",
@@ -167,33 +199,62 @@ static char* const atoms_string_list[] = {
 "_NET_WM_OPAQUE_REGION",
 "_NET_WM_BYPASS_COMPOSITOR"};
 
+// one per _NET_WM_WINDOW_TYPE, _NET_WM_STATE and _NET_WM_ALLOWED_ACTIONS atom that has a window flag
+#define M_atom_flags_size 39
+
+typedef struct sl_atom_flag {
+	Atom atom;
+	u64 flag;
+} sl_atom_flag;
+
 #define M_net_wm_state_remove 0
 #define M_net_wm_state_add    1
 #define M_net_wm_state_toggle 2
 
 typedef struct sl_display {
 	Display* const x_display;
+	int const screen;
 	Window const root;
 	Cursor const cursor;
 	sl_window_stack const window_stack;
 	Atom const atoms[atoms_size];
+	sl_atom_flag const atom_flags[M_atom_flags_size]; // sorted by atom for bsearch
+	Atom const flag_atoms[64];                        // indexed by flag bit, None for the bits that have no atom
 	sl_window_dimensions const dimensions;
+	sl_workarea const workarea;
+	sl_outputs const outputs;
 
 	uint numlockmask;
 
-	struct sl_u32_position {
-		u32 x;
-		u32 y;
-	} mouse;
+	sl_timer timers[timers_size];
+	sl_process_priority const process_priority;
+	sl_warm_pool const warm_pool;
+	sl_media_control const media_control;
+	sl_property_prefetch const property_prefetch;
+	sl_attribute_cache const attribute_cache;
+	sl_request_queue const request_queue;
+	sl_ewmh_publisher const ewmh_publisher;
+	sl_icon_cache const icon_cache;
+	sl_rules const rules;
+	sl_drag const drag;
+	sl_sync_resize const sync_resize;
+	sl_snap const snap;
+	sl_placement const placement;
+	sl_layout const layout;
+	sl_low_latency const low_latency;
 } sl_display;
 
 typedef struct sl_window sl_window; // foward declaration
 
-extern sl_display* sl_display_create (Display* restrict);
+extern sl_display* sl_display_create (Display* restrict, int screen);
 extern void sl_display_delete (sl_display* restrict);
 
 extern void sl_grab_keys (sl_display* restrict);
 
+extern u64 sl_atom_to_flag (sl_display const* restrict, Atom);
+extern u64 sl_atom_list_to_flags (sl_display const* restrict, Atom const* restrict, size_t size, u64 mask);
+extern size_t sl_flags_to_atom_list (sl_display const* restrict, u64 flags, Atom* restrict);
+
 extern void sl_cycle_windows_up (sl_display* restrict, Time);
 extern void sl_cycle_windows_down (sl_display* restrict, Time);
 extern void sl_next_workspace (sl_display* restrict, Time);
@@ -203,6 +264,9 @@ extern void sl_next_workspace_with_raised_window (sl_display* restrict);
 extern void sl_previous_workspace_with_raised_window (sl_display* restrict);
 extern void sl_push_workspace (sl_display* restrict);
 extern void sl_pop_workspace (sl_display* restrict, Time);
+extern void sl_map_workspace (sl_display* restrict, workspace_type);
+extern void sl_unmap_workspace (sl_display* restrict, workspace_type);
+extern void sl_focus_workspace (sl_display* restrict, workspace_type); // moves the focus to the output already showing it
 
 extern void sl_focus_window (sl_display* restrict, size_t, Time);
 extern void sl_raise_window (sl_display* restrict, size_t);
@@ -212,11 +276,19 @@ extern void sl_focus_raised_window (sl_display* restrict, Time);
 extern void sl_set_window_as_focused (sl_display* restrict, size_t);
 extern void sl_unset_x_window_as_focused (sl_display* restrict, Window);
 
+extern void sl_update_process_priorities (sl_display* restrict);
+
 extern void sl_move_window (sl_display* restrict, sl_window* restrict, i16 x, i16 y);
+extern void sl_move_window_group (sl_display* restrict, size_t, i16 x, i16 y);
+extern void sl_constrain_window_size (sl_window const* restrict, u16* restrict width, u16* restrict height); // to the normal hints
 extern void sl_resize_window (sl_display* restrict, sl_window* restrict, u16 width, u16 height);
+extern void sl_commit_window_size (sl_display* restrict, sl_window* restrict);
+extern void sl_send_window_dimensions (sl_display* restrict, sl_window* restrict); // the synthetic ConfigureNotify of the icccm
 extern void sl_move_and_resize_window (sl_display* restrict, sl_window* restrict, sl_window_dimensions);
 extern void sl_window_fullscreen_change_response (sl_display* restrict, sl_window* restrict);
 extern void sl_window_maximized_change_response (sl_display* restrict, sl_window* restrict);
+extern void sl_workarea_change_response (sl_display* restrict);
+extern workspace_type sl_apply_window_rules (sl_display* restrict, sl_window* restrict);
 
 extern void sl_maximize_raised_window (sl_display* restrict);
 extern void sl_expand_raised_window_to_max (sl_display* restrict);
@@ -0,0 +1,318 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "drag.h"
+
+#include <X11/Xlib.h>
+
+#ifdef D_xrandr
+#	include <X11/extensions/Xrandr.h>
+#endif
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window-stack.h"
+
+#ifdef D_drag_log
+#	define drag_log(M_message)         warn_log(M_message)
+#	define drag_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define drag_log(M_message)
+#	define drag_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_nanoseconds_per_second 1000000000
+#define M_default_refresh_rate   60 // when randr is not there to ask
+
+typedef struct sl_drag_mutable {
+	u8 mode;
+	Window x_window;
+
+	sl_pointer_position origin;
+	sl_pointer_position applied;
+	sl_pointer_position latest;
+
+	bool outline;
+	bool outline_drawn;
+	bool server_grabbed;
+	sl_window_dimensions start;
+	sl_window_dimensions outline_dimensions;
+	GC gc;
+
+	u64 interval;
+	u64 last_update;
+
+	u64 motions;
+	u64 updates;
+	u64 outline_drags;
+} sl_drag_mutable;
+
+void sl_drag_create (sl_drag* restrict this) { *(sl_drag_mutable*)this = (sl_drag_mutable) {.mode = drag_none}; }
+
+void sl_drag_delete (sl_drag* restrict this, Display* x_display) {
+	if (this->gc) XFreeGC(x_display, this->gc);
+}
+
+static void draw_outline (sl_display* restrict display) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	if (!this->gc) {
+		// drawn over the windows and taken off again by drawing it a second time
+		XGCValues values = {
+		.function = GXxor,
+		.foreground = WhitePixel(display->x_display, display->screen) ^ BlackPixel(display->x_display, display->screen),
+		.line_width = 2,
+		.subwindow_mode = IncludeInferiors};
+		this->gc = XCreateGC(display->x_display, display->root, GCFunction | GCForeground | GCLineWidth | GCSubwindowMode, &values);
+	}
+
+	sl_window_dimensions const* const outline = &this->outline_dimensions;
+	XDrawRectangle(display->x_display, display->root, this->gc, outline->x, outline->y, max(outline->width, 2) - 1, max(outline->height, 2) - 1);
+
+	this->outline_drawn = !this->outline_drawn;
+}
+
+static void erase_outline (sl_display* restrict display) {
+	if (display->drag.outline_drawn) draw_outline(display);
+}
+
+static u64 refresh_interval (M_maybe_unused sl_display* restrict display, M_maybe_unused i32 x_root, M_maybe_unused i32 y_root) {
+	u64 interval = M_nanoseconds_per_second / M_default_refresh_rate;
+
+#ifdef D_xrandr
+	// link with -lXrandr
+	int event_base, error_base;
+	if (!XRRQueryExtension(display->x_display, &event_base, &error_base)) return interval;
+
+	XRRScreenResources* resources = XRRGetScreenResourcesCurrent(display->x_display, display->root);
+	if (!resources) return interval;
+
+	// the crtc the pointer is on, its mode gives the refresh as dot clock over the pixels of a whole frame
+	for (int i = 0; i < resources->ncrtc; ++i) {
+		XRRCrtcInfo* crtc = XRRGetCrtcInfo(display->x_display, resources, resources->crtcs[i]);
+		if (!crtc) continue;
+
+		bool const under_pointer =
+		crtc->mode != None && x_root >= crtc->x && x_root < crtc->x + (i32)crtc->width && y_root >= crtc->y && y_root < crtc->y + (i32)crtc->height;
+
+		for (int j = 0; under_pointer && j < resources->nmode; ++j) {
+			XRRModeInfo const* const mode = &resources->modes[j];
+			if (mode->id != crtc->mode) continue;
+
+			u64 lines = mode->vTotal;
+			if (mode->modeFlags & RR_DoubleScan) lines *= 2;
+			if (mode->modeFlags & RR_Interlace) lines /= 2;
+
+			if (mode->dotClock && mode->hTotal && lines) interval = (u64)mode->hTotal * lines * M_nanoseconds_per_second / mode->dotClock;
+			break;
+		}
+
+		XRRFreeCrtcInfo(crtc);
+		if (under_pointer) break;
+	}
+
+	XRRFreeScreenResources(resources);
+#endif
+
+	drag_log_va("refresh interval %lu ns", interval);
+
+	return interval;
+}
+
+static size_t find_window (sl_display* restrict display, Window x_window) {
+	size_t const raised = sl_window_stack_get_raised_window_index((sl_window_stack*)&display->window_stack);
+
+	if (!sl_window_stack_is_valid_index(raised)) return raised;
+
+	for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+		if (display->window_stack.data[i].window.x_window == x_window) return i;
+		if (i == raised) return (size_t)-1;
+	}
+}
+
+void sl_drag_start (sl_display* restrict display, Window x_window, u8 mode, i32 x_root, i32 y_root, Time time) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	if (this->mode != drag_none) return;
+
+	// replaces the grab the button press activated, motion is only selected for as long as the drag lasts
+	if (XGrabPointer(display->x_display, display->root, false, PointerMotionMask | ButtonReleaseMask, GrabModeAsync, GrabModeAsync, None, None, time) !=
+	    GrabSuccess) {
+		drag_log_va("[%lu] could not grab the pointer", x_window);
+		return;
+	}
+
+	this->mode = mode;
+	this->x_window = x_window;
+	this->origin = this->applied = this->latest = (sl_pointer_position) {.x = x_root, .y = y_root};
+	this->interval = refresh_interval(display, x_root, y_root);
+	this->last_update = 0;
+
+	size_t const index = find_window(display, x_window);
+	if (sl_window_stack_is_valid_index(index)) this->start = this->outline_dimensions = display->window_stack.data[index].window.dimensions;
+
+	if (this->outline && sl_window_stack_is_valid_index(index)) {
+		// nothing else may draw under the xored outline until it is taken off again, or taking it off would leave the other drawing mangled
+		XGrabServer(display->x_display);
+		this->server_grabbed = true;
+		draw_outline(display);
+		++this->outline_drags;
+	}
+
+	drag_log_va("[%lu] drag started, mode %u", x_window, mode);
+}
+
+void sl_drag_motion (sl_display* restrict display, i32 x_root, i32 y_root) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	if (this->mode == drag_none) return;
+
+	++this->motions;
+	this->latest = (sl_pointer_position) {.x = x_root, .y = y_root};
+
+	if (sl_timer_is_armed(&display->timers[timer_drag])) return;
+
+	sl_timer_arm(&display->timers[timer_drag], max(sl_monotonic_time(), this->last_update + this->interval));
+}
+
+/*
+  from where the window was when the button was pressed, a drag back and forth over the size hints or over an edge it snapped to does not drift away
+  from the pointer
+*/
+static sl_window_dimensions dimensions_at (sl_display* restrict display, sl_window const* restrict window, u8 mode, sl_window_dimensions start, i32 dx, i32 dy) {
+	if (mode == drag_move) return sl_snap_move(display, window, start.x + dx, start.y + dy);
+
+	u16 width = max(1, start.width + dx);
+	u16 height = max(1, start.height + dy);
+	sl_constrain_window_size(window, &width, &height);
+
+	return (sl_window_dimensions) {.x = start.x, .y = start.y, .width = width, .height = height};
+}
+
+static void end (sl_display* restrict display, Time time) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	erase_outline(display);
+
+	if (this->server_grabbed) {
+		XUngrabServer(display->x_display);
+		XFlush(display->x_display);
+		this->server_grabbed = false;
+	}
+
+	XUngrabPointer(display->x_display, time);
+	sl_timer_disarm(&display->timers[timer_drag]);
+
+	this->mode = drag_none;
+}
+
+void sl_drag_update (sl_display* restrict display) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	if (this->mode == drag_none) return;
+	if (this->latest.x == this->applied.x && this->latest.y == this->applied.y) return;
+
+	size_t const index = find_window(display, this->x_window);
+
+	// the window went away or left the workspace under the pointer
+	if (!sl_window_stack_is_valid_index(index)) return end(display, CurrentTime);
+
+	sl_window* const window = (sl_window*)&display->window_stack.data[index].window;
+	sl_window_dimensions const target = dimensions_at(display, window, this->mode, this->start, this->latest.x - this->origin.x, this->latest.y - this->origin.y);
+
+	if (this->outline_drawn) {
+		draw_outline(display);
+		this->outline_dimensions = target;
+		draw_outline(display);
+	} else if (!(window->flags & window_state_fullscreen_bit)) {
+		if (this->mode == drag_move) {
+			sl_move_window_group(display, index, target.x, target.y);
+
+			for (size_t i = index; sl_window_stack_is_valid_index(i); i = sl_window_stack_get_next_in_group((sl_window_stack*)&display->window_stack, index, i))
+				((sl_window*)&display->window_stack.data[i].window)->saved_dimensions = display->window_stack.data[i].window.dimensions;
+		} else {
+			// sized from the start of the drag, per frame deltas smaller than the resize increments would be rounded away one by one
+			sl_resize_window(display, window, target.width, target.height);
+
+			window->saved_dimensions = window->dimensions;
+		}
+	}
+
+	this->applied = this->latest;
+	this->last_update = sl_monotonic_time();
+	++this->updates;
+}
+
+void sl_drag_finish (sl_display* restrict display, i32 x_root, i32 y_root, Time time) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	if (this->mode == drag_none) return;
+
+	// the release is applied right away, the window ends up exactly where the pointer was let go
+	this->latest = (sl_pointer_position) {.x = x_root, .y = y_root};
+
+	if (this->outline_drawn) {
+		// taken off before the windows under it change
+		erase_outline(display);
+
+		size_t const index = find_window(display, this->x_window);
+
+		if (sl_window_stack_is_valid_index(index)) {
+			sl_window* const window = (sl_window*)&display->window_stack.data[index].window;
+			sl_window_dimensions const outline = dimensions_at(display, window, this->mode, this->start, this->latest.x - this->origin.x, this->latest.y - this->origin.y);
+
+			// a move keeps the group together, a resize is the single configure of the whole drag
+			if (this->mode == drag_move) {
+				sl_move_window_group(display, index, outline.x, outline.y);
+
+				for (size_t i = index; sl_window_stack_is_valid_index(i); i = sl_window_stack_get_next_in_group((sl_window_stack*)&display->window_stack, index, i))
+					((sl_window*)&display->window_stack.data[i].window)->saved_dimensions = display->window_stack.data[i].window.dimensions;
+			} else {
+				sl_move_and_resize_window(display, window, outline);
+				window->saved_dimensions = window->dimensions;
+			}
+		}
+	} else {
+		sl_drag_update(display);
+	}
+
+	drag_log_va("[%lu] drag finished", this->x_window);
+
+	end(display, time);
+
+	// left out of the snap index for the length of the drag
+	size_t const index = find_window(display, this->x_window);
+	if (sl_window_stack_is_valid_index(index)) sl_snap_update(display, this->x_window, display->window_stack.data[index].window.dimensions);
+}
+
+void sl_drag_toggle_outline (sl_display* restrict display) {
+	sl_drag_mutable* const this = (sl_drag_mutable*)&display->drag;
+
+	// the drag going on keeps the mode it started with
+	this->outline = !this->outline;
+
+	drag_log_va("outline mode %s", this->outline ? "on" : "off");
+}
+
+void sl_drag_log_statistics (M_maybe_unused sl_drag const* restrict this) {
+	log("drag: %lu motion events, %lu window updates, %lu outline drags", this->motions, this->updates, this->outline_drags);
+}
@@ -0,0 +1,70 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <X11/Xlib.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+enum { drag_none, drag_move, drag_resize };
+
+typedef struct sl_pointer_position {
+	i32 x;
+	i32 y;
+} sl_pointer_position;
+
+// an interactive move or resize, the pointer is grabbed for as long as it lasts
+typedef struct sl_drag {
+	u8 const mode;
+	Window const x_window;
+
+	sl_pointer_position const origin;  // on the root, where the button was pressed
+	sl_pointer_position const applied; // where the window was last brought to
+	sl_pointer_position const latest;  // the motions in between are dropped
+
+	// in outline mode only a rectangle follows the pointer, the window is configured once when the button is released
+	bool const outline;
+	bool const outline_drawn;
+	bool const server_grabbed;        // from the first outline of the drag until its end
+	sl_window_dimensions const start; // of the window when the drag started
+	sl_window_dimensions const outline_dimensions;
+	GC const gc; // xor on the root, created with the first outline
+
+	u64 const interval; // nanoseconds between two updates, one refresh of the output the drag started on
+	u64 const last_update;
+
+	u64 const motions;
+	u64 const updates;
+	u64 const outline_drags;
+} sl_drag;
+
+extern void sl_drag_create (sl_drag* restrict);
+extern void sl_drag_delete (sl_drag* restrict, Display*);
+
+extern void sl_drag_start (sl_display* restrict, Window, u8 mode, i32 x_root, i32 y_root, Time);
+extern void sl_drag_motion (sl_display* restrict, i32 x_root, i32 y_root);
+extern void sl_drag_finish (sl_display* restrict, i32 x_root, i32 y_root, Time);
+extern void sl_drag_update (sl_display* restrict); // the timer callback
+extern void sl_drag_toggle_outline (sl_display* restrict);
+
+extern void sl_drag_log_statistics (sl_drag const* restrict);
@@ -30,8 +30,10 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 
+#include "attribute-cache.h"
 #include "compiler-differences.h"
 #include "display.h"
+#include "property.h"
 #include "types.h"
 #include "util.h"
 #include "window-manager.h"
@@ -309,14 +311,15 @@
 #define parse_mask(m)      (m & ~(display->numlockmask | LockMask))
 #define parse_mask_long(m) (m & ~(display->numlockmask | LockMask) & (ShiftMask | ControlMask | Mod1Mask | Mod2Mask | Mod3Mask | Mod4Mask | Mod5Mask))
 
-#define cycle_windows_for_current_workspace_start \
-	if (sl_window_stack_is_valid_index(sl_window_stack_get_raised_window_index((sl_window_stack*)&display->window_stack))) \
-		for (size_t i = display->window_stack.data[display->window_stack.workspace_vector.indexes[display->window_stack.current_workspace]].next;; \
-		     i = display->window_stack.data[i].next) { \
-			sl_window* window = (sl_window*)&display->window_stack.data[i].window; \
-			if (window->x_window == event->window)
-#define cycle_windows_for_current_workspace_end \
-	if (i == display->window_stack.workspace_vector.indexes[display->window_stack.current_workspace]) break; \
+// every workspace an output shows, the one of the window found is j
+#define cycle_windows_for_shown_workspaces_start \
+	for (workspace_type j = 0; j < display->window_stack.workspace_vector.size; ++j) \
+		if (sl_window_stack_is_valid_index(display->window_stack.workspace_vector.indexes[j]) && sl_outputs_showing(&display->outputs, j) != (size_t)-1) \
+			for (size_t i = display->window_stack.data[display->window_stack.workspace_vector.indexes[j]].next;; i = display->window_stack.data[i].next) { \
+				sl_window* window = (sl_window*)&display->window_stack.data[i].window; \
+				if (window->x_window == event->window)
+#define cycle_windows_for_shown_workspaces_end \
+	if (i == display->window_stack.workspace_vector.indexes[j]) break; \
 	}
 
 #define cycle_all_mapped_windows_start \
@@ -336,18 +339,6 @@
 		if (window->x_window == event->window)
 #define cycle_all_windows_end }
 
-static void button_press_or_release (sl_display* display, XButtonEvent* event) {
-	if (!(parse_mask(event->state) == Mod4Mask || parse_mask(event->state) == (Mod4Mask | ControlMask))) return;
-
-	display->mouse.y = event->y_root;
-	display->mouse.x = event->x_root;
-
-	cycle_windows_for_current_workspace_start { return sl_focus_and_raise_window(display, i, event->time); }
-	cycle_windows_for_current_workspace_end
-
-	return sl_focus_raised_window(display, event->time);
-}
-
 void sl_button_press (sl_display* display, XButtonPressedEvent* event) {
 	/*
 	  Xlib - C Language X Interface: Chapter 10. Events: Keyboard and Pointer Events:
@@ -384,7 +375,24 @@ void sl_button_press (sl_display* display, XButtonPressedEvent* event) {
 	x_button_event_log_verbose(ButtonPress);
 #endif
 
-	return button_press_or_release(display, event);
+	if (!(parse_mask(event->state) == Mod4Mask || parse_mask(event->state) == (Mod4Mask | ControlMask))) return;
+
+	// the passive grabs are on the root, the top-level window the button went down in is the child it reports
+	if (event->window == display->root) event->window = event->subwindow;
+
+	cycle_windows_for_shown_workspaces_start {
+		sl_focus_workspace(display, j);
+		sl_focus_and_raise_window(display, i, event->time);
+
+		if (window->flags & window_state_fullscreen_bit) return;
+
+		sl_layout_float_window(display, i); // a tiled window that is dragged is let go of
+
+		return sl_drag_start(display, window->x_window, parse_mask(event->state) & ControlMask ? drag_resize : drag_move, event->x_root, event->y_root, event->time);
+	}
+	cycle_windows_for_shown_workspaces_end
+
+	return sl_focus_raised_window(display, event->time);
 }
 
 void sl_button_release (sl_display* display, XButtonReleasedEvent* event) {
@@ -424,7 +432,8 @@ void sl_button_release (sl_display* display, XButtonReleasedEvent* event) {
 	x_button_event_log_verbose(ButtonRelease);
 #endif
 
-	return button_press_or_release(display, event);
+	// the pointer grab of a drag reports the release on the root, whatever the modifiers are by then
+	return sl_drag_finish(display, event->x_root, event->y_root, event->time);
 }
 
 void sl_enter_notify (sl_display* display, XEnterWindowEvent* event) {
@@ -455,12 +464,14 @@ void sl_enter_notify (sl_display* display, XEnterWindowEvent* event) {
 
 	if (event->mode != NotifyNormal) return;
 
-	cycle_windows_for_current_workspace_start {
+	cycle_windows_for_shown_workspaces_start {
+		sl_focus_workspace(display, j); // the pointer went over to another output
+
 		if (event->focus) return sl_window_stack_set_focused_window((sl_window_stack*)&display->window_stack, i);
 
 		return sl_focus_window(display, i, CurrentTime);
 	}
-	cycle_windows_for_current_workspace_end
+	cycle_windows_for_shown_workspaces_end
 }
 
 void sl_leave_notify (M_maybe_unused sl_display* display, M_maybe_unused XLeaveWindowEvent* event) {
@@ -538,29 +549,8 @@ void sl_motion_notify (sl_display* display, XPointerMovedEvent* event) {
 	log_bool("same_screen %s", event->same_screen);
 #endif
 
-	sl_window* const raised_window = sl_window_stack_get_raised_window((sl_window_stack*)&display->window_stack);
-	if (!raised_window) return;
-
-	if (raised_window->flags & window_state_fullscreen_bit) return;
-
-	if (parse_mask(event->state) == (Button1MotionMask | Mod4Mask) || parse_mask(event->state) == (Button1MotionMask | Mod4Mask | ControlMask)) {
-		if (parse_mask(event->state) == (Button1MotionMask | Mod4Mask))
-			sl_move_window(
-			display, raised_window, raised_window->dimensions.x + event->x_root - display->mouse.x,
-			raised_window->dimensions.y + event->y_root - display->mouse.y
-			);
-
-		if (parse_mask(event->state) == (Button1MotionMask | Mod4Mask | ControlMask))
-			sl_resize_window(
-			display, raised_window, raised_window->dimensions.width + event->x_root - display->mouse.x,
-			raised_window->dimensions.height + event->y_root - display->mouse.y
-			);
-
-		raised_window->saved_dimensions = raised_window->dimensions;
-
-		display->mouse.x = event->x_root;
-		display->mouse.y = event->y_root;
-	}
+	// only the latest position is kept, the drag timer applies it at most once a refresh
+	return sl_drag_motion(display, event->x_root, event->y_root);
 }
 
 void sl_circulate_notify (M_maybe_unused sl_display* display, M_maybe_unused XCirculateEvent* event) {
@@ -588,7 +578,7 @@ void sl_circulate_notify (M_maybe_unused sl_display* display, M_maybe_unused XCi
 #endif
 }
 
-void sl_configure_notify (M_maybe_unused sl_display* display, M_maybe_unused XConfigureEvent* event) {
+void sl_configure_notify (sl_display* display, XConfigureEvent* event) {
 	/*
 	  Xlib - C Language X Interface: Chapter 10. Events: Window State Change Events:
 
@@ -617,6 +607,9 @@ void sl_configure_notify (M_maybe_unused sl_display* display, M_maybe_unused XCo
 #if defined(D_configure_notify_event_log_quiet) || defined(D_configure_notify_event_log_verbose)
 	log("[%lu]: ConfigureNotify", event->window);
 #endif
+
+	sl_attribute_cache_configure_notify((sl_attribute_cache*)&display->attribute_cache, event);
+	sl_snap_update(display, event->window, (sl_window_dimensions) {.x = event->x, .y = event->y, .width = event->width, .height = event->height});
 #if defined(D_configure_notify_event_log_verbose)
 	log("serial %lu", event->serial);
 	log_bool("send event %s", event->send_event);
@@ -655,29 +648,20 @@ void sl_create_notify (sl_display* display, XCreateWindowEvent* event) {
 	log_bool("override_redirect %s", event->override_redirect);
 #endif
 
-	XSelectInput(
-	event->display, event->window,
-	EnterWindowMask | LeaveWindowMask | StructureNotifyMask | SubstructureNotifyMask | SubstructureRedirectMask | FocusChangeMask | PropertyChangeMask
-	);
-
-	uint const modifiers[] = {0, LockMask, display->numlockmask, LockMask | display->numlockmask};
-	for (unsigned i = 0; i < 4; ++i) {
-		XGrabButton(
-		display->x_display, Button1, Mod4Mask | modifiers[i], event->window, false, ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
-		GrabModeAsync, GrabModeAsync, None, None
-		);
-		XGrabButton(
-		display->x_display, Button1, Mod4Mask | ControlMask | modifiers[i], event->window, false, ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
-		GrabModeAsync, GrabModeAsync, None, None
-		);
-	}
+	sl_attribute_cache_create_notify((sl_attribute_cache*)&display->attribute_cache, event);
 
 	if (event->parent != display->root) return;
 
+	/*
+	  the structure of top-level windows is already reported through the SubstructureNotifyMask of the root, and the buttons through the grabs on
+	  the root, a window only selects what happens on itself alone
+	*/
+	if (!event->override_redirect) XSelectInput(event->display, event->window, EnterWindowMask | FocusChangeMask | PropertyChangeMask);
+
+	sl_property_prefetch_start(display, event->window);
+
 	sl_window* const window = sl_window_stack_add_window((sl_window_stack*)&display->window_stack, &(sl_window) {.x_window = event->window});
-	XWindowAttributes attributes;
-	XGetWindowAttributes(event->display, event->window, &attributes);
-	window->dimensions = (sl_window_dimensions) {.x = attributes.x, .y = attributes.y, .width = attributes.width, .height = attributes.height};
+	window->dimensions = (sl_window_dimensions) {.x = event->x, .y = event->y, .width = event->width, .height = event->height};
 	window->saved_dimensions = window->dimensions;
 }
 
@@ -702,11 +686,17 @@ void sl_destroy_notify (sl_display* display, XDestroyWindowEvent* event) {
 	log("event %lu", event->event);
 #endif
 
+	sl_warm_pool_forget_x_window(display, event->window);
+	sl_property_prefetch_cancel(display, event->window);
+	sl_sync_resize_forget(display, event->window);
+	sl_attribute_cache_destroy_notify((sl_attribute_cache*)&display->attribute_cache, event);
+	if (sl_workarea_remove_strut((sl_workarea*)&display->workarea, event->window)) sl_workarea_change_response(display);
+
 	cycle_all_windows_start { return sl_window_stack_remove_window((sl_window_stack*)&display->window_stack, i); }
 	cycle_all_windows_end
 }
 
-void sl_gravity_notify (M_maybe_unused sl_display* display, M_maybe_unused XGravityEvent* event) {
+void sl_gravity_notify (sl_display* display, XGravityEvent* event) {
 	/*
 	  Xlib - C Language X Interface: Chapter 10. Events: Window State Change Events:
 
@@ -722,6 +712,8 @@ void sl_gravity_notify (M_maybe_unused sl_display* display, M_maybe_unused XGrav
 #if defined(D_gravity_notify_event_log_quiet) || defined(D_gravity_notify_event_log_verbose)
 	log("[%lu]: GravityNotify", event->window);
 #endif
+
+	sl_attribute_cache_gravity_notify((sl_attribute_cache*)&display->attribute_cache, event);
 #if defined(D_gravity_notify_event_log_verbose)
 	log("serial %lu", event->serial);
 	log_bool("send event %s", event->send_event);
@@ -731,7 +723,7 @@ void sl_gravity_notify (M_maybe_unused sl_display* display, M_maybe_unused XGrav
 #endif
 }
 
-void sl_map_notify (M_maybe_unused sl_display* display, M_maybe_unused XMapEvent* event) {
+void sl_map_notify (sl_display* display, XMapEvent* event) {
 	/*
 	  Xlib - C Language X Interface: Chapter 10. Events: Window State Change Events:
 
@@ -747,6 +739,8 @@ void sl_map_notify (M_maybe_unused sl_display* display, M_maybe_unused XMapEvent
 #if defined(D_map_notify_event_log_quiet) || defined(D_map_notify_event_log_verbose)
 	log("[%lu]: MapNotify", event->window);
 #endif
+
+	sl_attribute_cache_map_notify((sl_attribute_cache*)&display->attribute_cache, event);
 #if defined(D_map_notify_event_log_verbose)
 	log("serial %lu", event->serial);
 	log_bool("send event %s", event->send_event);
@@ -756,7 +750,7 @@ void sl_map_notify (M_maybe_unused sl_display* display, M_maybe_unused XMapEvent
 #endif
 }
 
-void sl_reparent_notify (M_maybe_unused sl_display* display, M_maybe_unused XReparentEvent* event) {
+void sl_reparent_notify (sl_display* display, XReparentEvent* event) {
 	/*
 	  Xlib - C Language X Interface: Chapter 10. Events: Window State Change Events:
 
@@ -770,6 +764,8 @@ void sl_reparent_notify (M_maybe_unused sl_display* display, M_maybe_unused XRep
 #if defined(D_reparent_notify_event_log_quiet) || defined(D_reparent_notify_event_log_verbose)
 	log("[%lu]: ReparentNotify", event->window);
 #endif
+
+	sl_attribute_cache_reparent_notify((sl_attribute_cache*)&display->attribute_cache, event);
 #if defined(D_reparent_notify_event_log_verbose)
 	log("serial %lu", event->serial);
 	log_bool("send event %s", event->send_event);
@@ -803,6 +799,8 @@ void sl_unmap_notify (sl_display* display, XUnmapEvent* event) {
 	log_bool("from_configure %s", event->from_configure);
 #endif
 
+	sl_attribute_cache_unmap_notify((sl_attribute_cache*)&display->attribute_cache, event);
+
 	/*
 	  For compatibility with obsolete clients, window managers should
 	  trigger the transition to the Withdrawn state on the real UnmapNotify
@@ -817,11 +815,15 @@ void sl_unmap_notify (sl_display* display, XUnmapEvent* event) {
 		if (event->send_event) {
 			sl_window_set_withdrawn(window);
 			sl_window_stack_remove_window_from_its_workspace((sl_window_stack*)&display->window_stack, i);
+			if (sl_workarea_remove_strut((sl_workarea*)&display->workarea, window->x_window)) sl_workarea_change_response(display);
 			return;
 		}
 
-		if (j == display->window_stack.current_workspace)
-			return sl_window_stack_remove_window_from_its_workspace((sl_window_stack*)&display->window_stack, i);
+		if (sl_outputs_showing(&display->outputs, j) != (size_t)-1) {
+			sl_window_stack_remove_window_from_its_workspace((sl_window_stack*)&display->window_stack, i);
+			if (sl_workarea_remove_strut((sl_workarea*)&display->workarea, window->x_window)) sl_workarea_change_response(display);
+			return;
+		}
 
 		return;
 	}
@@ -854,14 +856,17 @@ void sl_circulate_request (sl_display* display, XCirculateRequestEvent* event) {
 	log_parsed_2("place %s", event->place, PlaceOnTop, PlaceOnBottom);
 #endif
 
-	cycle_windows_for_current_workspace_start {
-		if (event->place == PlaceOnTop) return sl_focus_and_raise_window(display, i, CurrentTime);
+	cycle_windows_for_shown_workspaces_start {
+		if (event->place == PlaceOnTop) {
+			sl_focus_workspace(display, j);
+			return sl_focus_and_raise_window(display, i, CurrentTime);
+		}
 
 		warn_log("todo: implement PlaceOnBottom");
 
 		return;
 	}
-	cycle_windows_for_current_workspace_end
+	cycle_windows_for_shown_workspaces_end
 }
 
 void sl_configure_request (sl_display* display, XConfigureRequestEvent* event) {
@@ -905,8 +910,7 @@ void sl_configure_request (sl_display* display, XConfigureRequestEvent* event) {
 	log("value_mask %s", buffer);
 #endif
 
-	XWindowAttributes attributes;
-	XGetWindowAttributes(event->display, event->window, &attributes);
+	sl_cached_attributes const attributes = sl_attribute_cache_get(display, event->window);
 
 	/*
 	  To control window placement or to add decoration, a window manager often needs
@@ -938,6 +942,17 @@ void sl_configure_request (sl_display* display, XConfigureRequestEvent* event) {
 	}
 
 	cycle_all_windows_start {
+		// a tiled window keeps its cell, it is told where it is instead and only its stacking is changed
+		if (sl_layout_holds_window(&display->layout, window->x_window) && !(window->flags & window_floating_bit)) {
+			if (event->value_mask & (CWSibling | CWStackMode))
+				XConfigureWindow(
+				event->display, event->window, event->value_mask & (CWSibling | CWStackMode), &(XWindowChanges) {.sibling = event->above, .stack_mode = event->detail}
+				);
+
+			sl_send_window_dimensions(display, window);
+			return;
+		}
+
 		if (event->value_mask & (CWX | CWY | CWWidth | CWHeight)) {
 			if (event->value_mask & CWX) window->dimensions.x = event->x;
 			if (event->value_mask & CWY) window->dimensions.y = event->y;
@@ -1002,8 +1017,7 @@ void sl_map_request (sl_display* display, XMapRequestEvent* event) {
 	log("parent %lu", event->parent);
 #endif
 
-	XWindowAttributes attributes;
-	XGetWindowAttributes(event->display, event->window, &attributes);
+	sl_cached_attributes const attributes = sl_attribute_cache_get(display, event->window);
 
 	/*
 	  To control window placement or to add decoration, a window manager often needs
@@ -1025,24 +1039,38 @@ void sl_map_request (sl_display* display, XMapRequestEvent* event) {
 	}
 
 	cycle_all_windows_start {
+		if (sl_warm_pool_holds_x_window(&display->warm_pool, window->x_window)) return; // stays withdrawn until its launcher is used
+
+		workspace_type workspace = display->window_stack.current_workspace;
+
 		if (!(window->flags & window_started_bit)) {
 			window->flags |= window_started_bit;
-			sl_set_window_name(window, display);
-			sl_set_window_icon_name(window, display);
-			sl_set_window_normal_hints(window, display);
-			sl_set_window_hints(window, display);
-			sl_set_window_class(window, display);
-			sl_set_window_transient_for(window, display);
-			sl_set_window_protocols(window, display);
-			sl_set_window_colormap_windows(window, display);
-			sl_set_window_client_machine(window, display);
+
+			sl_property properties[prefetch_properties_size];
+			sl_property_prefetch_finish(display, window->x_window, properties);
+			sl_window_set_initial_properties(window, display, properties);
+			for (size_t j = 0; j < prefetch_properties_size; ++j)
+				sl_property_clear(&properties[j]);
+
+			sl_property_note_map(display, window->x_window);
+
+			workspace = sl_apply_window_rules(display, window);
+
+			if (sl_warm_pool_claim_window(display, i)) return;
+
+			sl_place_window(display, i, workspace);
 		} else {
 			sl_window_set_normal(window);
+			sl_window_set_net_wm_strut_partial(window, display); // dropped when the window was withdrawn
 		}
 
+		sl_window_stack_add_window_to_workspace((sl_window_stack*)&display->window_stack, i, workspace);
+
+		// a window sent to another workspace by a rule is mapped when that workspace is shown, and only takes the focus on the focused output
+		if (sl_outputs_showing(&display->outputs, workspace) == (size_t)-1) return;
+
 		XMapWindow(display->x_display, window->x_window);
-		sl_window_stack_add_window_to_current_workspace((sl_window_stack*)&display->window_stack, i);
-		sl_focus_raised_window(display, CurrentTime);
+		if (workspace == display->window_stack.current_workspace) sl_focus_raised_window(display, CurrentTime);
 
 		return;
 	}
@@ -1138,7 +1166,11 @@ void sl_property_notify (sl_display* display, XPropertyEvent* event) {
 	log_parsed_2("state %s", event->state, PropertyNewValue, PropertyDelete);
 #endif
 
-	cycle_windows_for_current_workspace_start {
+	if (sl_low_latency_defer_property(display, event)) return;
+
+	sl_property_prefetch_invalidate(display, event->window, event->atom);
+
+	cycle_windows_for_shown_workspaces_start {
 		// start of icccm:
 
 		property_log(XA_WM_NAME, return sl_set_window_name(window, display));
@@ -1180,7 +1212,7 @@ void sl_property_notify (sl_display* display, XPropertyEvent* event) {
 		warn_log("unsupported property in ProperyNotify");
 		return;
 	}
-	cycle_windows_for_current_workspace_end
+	cycle_windows_for_shown_workspaces_end
 }
 
 // empty mask events
@@ -1415,8 +1447,11 @@ void sl_focus_in (M_maybe_unused sl_display* display, M_maybe_unused XFocusInEve
 	x_focus_change_event_verbose(FocusIn);
 #endif
 
-	cycle_windows_for_current_workspace_start { return sl_set_window_as_focused(display, i); }
-	cycle_windows_for_current_workspace_end
+	cycle_windows_for_shown_workspaces_start {
+		sl_focus_workspace(display, j);
+		return sl_set_window_as_focused(display, i);
+	}
+	cycle_windows_for_shown_workspaces_end
 }
 
 void sl_focus_out (M_maybe_unused sl_display* display, M_maybe_unused XFocusOutEvent* event) {
@@ -1485,26 +1520,16 @@ void sl_key_press (sl_display* display, XKeyPressedEvent* event) {
 	if (parse_mask_long(event->state) == 0) { // {k}
 		switch (XLookupKeysym(event, 0)) {
 		// desktop environment behavior
-		case XF86XK_AudioLowerVolume: { // decrease volume
-			char* const args[] = {"amixer", "-q", "sset", "Master", "5%-", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_AudioRaiseVolume: { // increase volume
-			char* const args[] = {"amixer", "-q", "sset", "Master", "5%+", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_AudioMute: { // mute volume
-			char* const args[] = {"amixer", "-q", "sset", "Master", "toggle", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_MonBrightnessDown: { // increase display brightness
-			char* const args[] = {"xbacklight", "-", "5", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_MonBrightnessUp: { // decrease display brightness
-			char* const args[] = {"xbacklight", "+", "5", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XF86XK_AudioLowerVolume: // decrease volume
+			return sl_media_adjust(display, media_volume, -5);
+		case XF86XK_AudioRaiseVolume: // increase volume
+			return sl_media_adjust(display, media_volume, 5);
+		case XF86XK_AudioMute: // mute volume
+			return sl_media_toggle_mute(display);
+		case XF86XK_MonBrightnessDown: // decrease display brightness
+			return sl_media_adjust(display, media_brightness, -5);
+		case XF86XK_MonBrightnessUp: // increase display brightness
+			return sl_media_adjust(display, media_brightness, 5);
 		case XK_Print: { // print the screen
 			struct timespec timespec = {};
 #ifdef D_gcc
@@ -1537,24 +1562,16 @@ void sl_key_press (sl_display* display, XKeyPressedEvent* event) {
 	if (parse_mask_long(event->state) == ShiftMask) { // shift + {k}
 		switch (XLookupKeysym(event, 0)) {
 		// volume manipulation
-		case XF86XK_AudioLowerVolume: { // decrease volume (a little)
-			char* const args[] = {"amixer", "-q", "sset", "Master", "1%-", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_AudioRaiseVolume: { // increase volume (a little)
-			char* const args[] = {"amixer", "-q", "sset", "Master", "1%+", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XF86XK_AudioLowerVolume: // decrease volume (a little)
+			return sl_media_adjust(display, media_volume, -1);
+		case XF86XK_AudioRaiseVolume: // increase volume (a little)
+			return sl_media_adjust(display, media_volume, 1);
 
 		// brightness manipulation
-		case XF86XK_MonBrightnessDown: { // increase display brightness (a little)
-			char* const args[] = {"xbacklight", "-", "1", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_MonBrightnessUp: { // decrease display brightness (a little)
-			char* const args[] = {"xbacklight", "+", "1", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XF86XK_MonBrightnessDown: // decrease display brightness (a little)
+			return sl_media_adjust(display, media_brightness, -1);
+		case XF86XK_MonBrightnessUp: // increase display brightness (a little)
+			return sl_media_adjust(display, media_brightness, 1);
 
 		default: invalid_key_press;
 		}
@@ -1563,24 +1580,16 @@ void sl_key_press (sl_display* display, XKeyPressedEvent* event) {
 	if (parse_mask_long(event->state) == ControlMask) { // control + {k}
 		switch (XLookupKeysym(event, 0)) {
 		// volume manipulation
-		case XF86XK_AudioLowerVolume: { // decrease volume (a lot)
-			char* const args[] = {"amixer", "-q", "sset", "Master", "10%-", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_AudioRaiseVolume: { // increase volume (a lot)
-			char* const args[] = {"amixer", "-q", "sset", "Master", "10%+", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XF86XK_AudioLowerVolume: // decrease volume (a lot)
+			return sl_media_adjust(display, media_volume, -10);
+		case XF86XK_AudioRaiseVolume: // increase volume (a lot)
+			return sl_media_adjust(display, media_volume, 10);
 
 		// brightness manipulation
-		case XF86XK_MonBrightnessDown: { // increase display brightness (a lot)
-			char* const args[] = {"xbacklight", "-", "10", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XF86XK_MonBrightnessUp: { // decrease display brightness (a lot)
-			char* const args[] = {"xbacklight", "+", "10", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XF86XK_MonBrightnessDown: // decrease display brightness (a lot)
+			return sl_media_adjust(display, media_brightness, -10);
+		case XF86XK_MonBrightnessUp: // increase display brightness (a lot)
+			return sl_media_adjust(display, media_brightness, 10);
 
 		default: invalid_key_press;
 		}
@@ -1606,30 +1615,21 @@ void sl_key_press (sl_display* display, XKeyPressedEvent* event) {
 		case XK_c: // close
 			return sl_close_raised_window(display, event->time);
 
+		case XK_o: // toggle dragging windows as an outline
+			return sl_drag_toggle_outline(display);
+
+		case XK_space: // cycle the layout of the workspace
+			return sl_layout_cycle(display);
+
 		case XK_Tab: // cycle the windows
 			return sl_cycle_windows_up(display, event->time);
 
 		// program execution shortcuts
-		case XK_t: {
-			char* const args[] = {"lxterminal", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_d: {
-			char* const args[] = {"discord", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_f: {
-			char* const args[] = {"thunar", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_e: {
-			char* const args[] = {"firefox-bin", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_g: {
-			char* const args[] = {"gimp", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XK_t: return sl_launch(display, launcher_terminal, event->time);
+		case XK_d: return sl_launch(display, launcher_chat, event->time);
+		case XK_f: return sl_launch(display, launcher_file_manager, event->time);
+		case XK_e: return sl_launch(display, launcher_browser, event->time);
+		case XK_g: return sl_launch(display, launcher_image_editor, event->time);
 
 		// workspace manipulation
 		case XK_Right: // switch to workspace to the right
@@ -1699,46 +1699,26 @@ void sl_key_press (sl_display* display, XKeyPressedEvent* event) {
 	if (parse_mask_long(event->state) == (Mod4Mask | ControlMask)) { // control + super + {k}
 		switch (XLookupKeysym(event, 0)) {
 		// volume manipulation
-		case XK_0: { // set volume to 100% (not 0%)
-			char* const args[] = {"amixer", "-q", "sset", "Master", "100%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_1: { // set volume to 10%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "10%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_2: { // set volume to 20%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "20%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_3: { // set volume to 30%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "30%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_4: { // set volume to 40%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "40%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_5: { // set volume to 50%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "50%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_6: { // set volume to 60%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "60%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_7: { // set volume to 70%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "70%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_8: { // set volume to 80%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "80%", 0};
-			return exec_program(display->x_display, args);
-		}
-		case XK_9: { // set volume to 90%
-			char* const args[] = {"amixer", "-q", "sset", "Master", "90%", 0};
-			return exec_program(display->x_display, args);
-		}
+		case XK_0: // set volume to 100% (not 0%)
+			return sl_media_set(display, media_volume, 100);
+		case XK_1: // set volume to 10%
+			return sl_media_set(display, media_volume, 10);
+		case XK_2: // set volume to 20%
+			return sl_media_set(display, media_volume, 20);
+		case XK_3: // set volume to 30%
+			return sl_media_set(display, media_volume, 30);
+		case XK_4: // set volume to 40%
+			return sl_media_set(display, media_volume, 40);
+		case XK_5: // set volume to 50%
+			return sl_media_set(display, media_volume, 50);
+		case XK_6: // set volume to 60%
+			return sl_media_set(display, media_volume, 60);
+		case XK_7: // set volume to 70%
+			return sl_media_set(display, media_volume, 70);
+		case XK_8: // set volume to 80%
+			return sl_media_set(display, media_volume, 80);
+		case XK_9: // set volume to 90%
+			return sl_media_set(display, media_volume, 90);
 
 		// window manipulation
 		case XK_m: // expand to max
@@ -0,0 +1,266 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "ewmh-publisher.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window-mutable.h"
+
+#ifdef D_ewmh_publisher_log
+#	define ewmh_publisher_log(M_message)         warn_log(M_message)
+#	define ewmh_publisher_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define ewmh_publisher_log(M_message)
+#	define ewmh_publisher_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 16
+#define M_unpublished           ((u32)-1)
+
+typedef struct sl_ewmh_publisher_mutable {
+	Window* client_list;
+	size_t client_list_size;
+	Window* client_list_stacking;
+	size_t client_list_stacking_size;
+	size_t allocated_size;
+
+	u32 number_of_desktops;
+	u32 current_desktop;
+	Window active_window;
+	sl_window_dimensions workarea;
+	u32 workarea_desktops;
+
+	u64 flushes;
+	u64 appends;
+	u64 replaces;
+} sl_ewmh_publisher_mutable;
+
+void sl_ewmh_publisher_create (sl_ewmh_publisher* restrict this) {
+	// an xid never has the top bits set, so the first flush always writes _NET_ACTIVE_WINDOW
+	*(sl_ewmh_publisher_mutable*)this = (sl_ewmh_publisher_mutable
+	) {.number_of_desktops = M_unpublished, .current_desktop = M_unpublished, .active_window = (Window)-1, .workarea_desktops = M_unpublished};
+}
+
+void sl_ewmh_publisher_delete (sl_ewmh_publisher* restrict this) {
+	if (this->client_list) free(((sl_ewmh_publisher_mutable*)this)->client_list);
+	if (this->client_list_stacking) free(((sl_ewmh_publisher_mutable*)this)->client_list_stacking);
+}
+
+static bool ensure_capacity (sl_ewmh_publisher_mutable* restrict this, size_t size) {
+	if (size <= this->allocated_size) return true;
+
+	size_t allocated_size = max(this->allocated_size, M_smallest_nonzero_size);
+	while (allocated_size < size)
+		allocated_size <<= 1;
+
+	Window* client_list = realloc(this->client_list, sizeof(Window) * allocated_size);
+	if (!client_list) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+	this->client_list = client_list;
+
+	Window* client_list_stacking = realloc(this->client_list_stacking, sizeof(Window) * allocated_size);
+	if (!client_list_stacking) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+	this->client_list_stacking = client_list_stacking;
+
+	this->allocated_size = allocated_size;
+	return true;
+}
+
+static bool is_managed (sl_window_stack const* restrict window_stack, size_t index) {
+	return !window_stack->data[index].flagged_for_deletion && sl_window_stack_is_valid_index(window_stack->data[index].next);
+}
+
+/*
+  windows only ever get added at the end of the window stack, and compacting it keeps the order, so a window that was just mapped lands at the end
+  of the list and the write is an append. anything else, a window going away or an older one being mapped again, rewrites the whole list.
+*/
+static void publish_list (
+sl_display* restrict display, sl_ewmh_publisher_mutable* restrict this, Atom atom, Window* restrict published, size_t* restrict published_size,
+Window const* restrict list, size_t size
+) {
+	size_t const old_size = *published_size;
+
+	if (size == old_size && memcmp(list, published, sizeof(Window) * size) == 0) return;
+
+	if (old_size != 0 && size > old_size && memcmp(list, published, sizeof(Window) * old_size) == 0) {
+		XChangeProperty(display->x_display, display->root, atom, XA_WINDOW, 32, PropModeAppend, (uchar*)(list + old_size), size - old_size);
+		++this->appends;
+	} else {
+		XChangeProperty(display->x_display, display->root, atom, XA_WINDOW, 32, PropModeReplace, (uchar*)list, size);
+		++this->replaces;
+	}
+
+	memcpy(published, list, sizeof(Window) * size);
+	*published_size = size;
+}
+
+static void publish_client_lists (sl_display* restrict display, sl_ewmh_publisher_mutable* restrict this) {
+	sl_window_stack const* const window_stack = &display->window_stack;
+
+	size_t size = 0;
+	for (size_t i = 0; i < window_stack->size; ++i)
+		if (is_managed(window_stack, i)) ++size;
+
+	if (!ensure_capacity(this, size)) return;
+
+	Window list[max(size, 1)];
+
+	size_t j = 0;
+	for (size_t i = 0; i < window_stack->size; ++i)
+		if (is_managed(window_stack, i)) list[j++] = window_stack->data[i].window.x_window;
+
+	publish_list(display, this, display->atoms[net_client_list], this->client_list, &this->client_list_size, list, size);
+
+	// the other workspaces first and the current one last, each from the bottom of its ring up to its raised window
+	j = 0;
+	for (workspace_type k = 0; k < window_stack->workspace_vector.size; ++k) {
+		workspace_type const workspace = (window_stack->current_workspace + 1 + k) % window_stack->workspace_vector.size;
+		size_t const raised = window_stack->workspace_vector.indexes[workspace];
+
+		if (!sl_window_stack_is_valid_index(raised)) continue;
+
+		for (size_t i = window_stack->data[raised].next;; i = window_stack->data[i].next) {
+			list[j++] = window_stack->data[i].window.x_window;
+
+			if (i == raised) break;
+		}
+	}
+
+	publish_list(display, this, display->atoms[net_client_list_stacking], this->client_list_stacking, &this->client_list_stacking_size, list, j);
+}
+
+static void publish_window_desktops (sl_display* restrict display) {
+	sl_window_stack const* const window_stack = &display->window_stack;
+
+	for (workspace_type k = 0; k < window_stack->workspace_vector.size; ++k) {
+		size_t const raised = window_stack->workspace_vector.indexes[k];
+
+		if (!sl_window_stack_is_valid_index(raised)) continue;
+
+		for (size_t i = window_stack->data[raised].next;; i = window_stack->data[i].next) {
+			sl_window_mutable* const window = (sl_window_mutable*)&window_stack->data[i].window;
+
+			if (window->published_desktop != (u32)k + 1) {
+				long const desktop = k;
+				XChangeProperty(display->x_display, window->x_window, display->atoms[net_wm_desktop], XA_CARDINAL, 32, PropModeReplace, (uchar*)&desktop, 1);
+				window->published_desktop = k + 1;
+			}
+
+			if (i == raised) break;
+		}
+	}
+
+	// the window manager should remove the property whenever a window is withdrawn
+	for (size_t i = 0; i < window_stack->size; ++i) {
+		sl_window_mutable* const window = (sl_window_mutable*)&window_stack->data[i].window;
+
+		if (window->published_desktop == 0 || sl_window_stack_is_valid_index(window_stack->data[i].next)) continue;
+
+		if (!window_stack->data[i].flagged_for_deletion) XDeleteProperty(display->x_display, window->x_window, display->atoms[net_wm_desktop]);
+		window->published_desktop = 0;
+	}
+}
+
+static void publish_cardinal (sl_display* restrict display, Atom atom, u32* restrict published, u32 value) {
+	if (*published == value) return;
+
+	long const data = value;
+	XChangeProperty(display->x_display, display->root, atom, XA_CARDINAL, 32, PropModeReplace, (uchar*)&data, 1);
+	*published = value;
+}
+
+static void publish_workarea (sl_display* restrict display, sl_ewmh_publisher_mutable* restrict this) {
+	sl_window_dimensions const area = display->workarea.area;
+	u32 const desktops = display->window_stack.workspace_vector.size;
+
+	if (desktops == this->workarea_desktops && area.x == this->workarea.x && area.y == this->workarea.y && area.width == this->workarea.width &&
+	    area.height == this->workarea.height)
+		return;
+
+	long data[desktops * 4];
+	for (u32 i = 0; i < desktops; ++i) {
+		data[i * 4 + 0] = area.x;
+		data[i * 4 + 1] = area.y;
+		data[i * 4 + 2] = area.width;
+		data[i * 4 + 3] = area.height;
+	}
+
+	XChangeProperty(display->x_display, display->root, display->atoms[net_workarea], XA_CARDINAL, 32, PropModeReplace, (uchar*)data, desktops * 4);
+	this->workarea = area;
+	this->workarea_desktops = desktops;
+}
+
+void sl_ewmh_publisher_flush (sl_display* restrict display) {
+	u8 const changes = display->window_stack.changes;
+
+	sl_ewmh_publisher* const publisher = (sl_ewmh_publisher*)&display->ewmh_publisher;
+	sl_ewmh_publisher_mutable* const this = (sl_ewmh_publisher_mutable*)publisher;
+	sl_window_stack const* const window_stack = &display->window_stack;
+
+	// struts change the workarea without touching the window stack
+	publish_workarea(display, this);
+
+	if (!changes) return;
+
+	ewmh_publisher_log_va("flushing changes %x", changes);
+
+	++this->flushes;
+
+	if (changes & (window_stack_changed_clients | window_stack_changed_stacking | window_stack_changed_current_workspace))
+		publish_client_lists(display, this);
+
+	if (changes & (window_stack_changed_clients | window_stack_changed_workspaces)) publish_window_desktops(display);
+
+	publish_cardinal(display, display->atoms[net_number_of_desktops], &this->number_of_desktops, window_stack->workspace_vector.size);
+	publish_cardinal(display, display->atoms[net_current_desktop], &this->current_desktop, window_stack->current_workspace);
+
+	{
+		size_t const focused = window_stack->focused_window_index;
+		Window const active_window =
+		sl_window_stack_is_valid_index(focused) && !window_stack->data[focused].flagged_for_deletion ? window_stack->data[focused].window.x_window : None;
+
+		if (active_window != this->active_window) {
+			XChangeProperty(
+			display->x_display, display->root, display->atoms[net_active_window], XA_WINDOW, 32, PropModeReplace, (uchar*)&active_window, 1
+			);
+			this->active_window = active_window;
+		}
+	}
+
+	sl_window_stack_clear_changes((sl_window_stack*)&display->window_stack);
+}
+
+void sl_ewmh_publisher_log_statistics (M_maybe_unused sl_ewmh_publisher const* restrict this) {
+	log("ewmh publisher: %lu flushes, %lu list appends, %lu list replaces", this->flushes, this->appends, this->replaces);
+}
@@ -0,0 +1,57 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/X.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+/*
+  the root window properties pagers and bars read instead of walking the tree. the window stack records what changed, flush writes only that,
+  once per batch of events.
+*/
+typedef struct sl_ewmh_publisher {
+	Window const* client_list; // as last written to _NET_CLIENT_LIST
+	size_t const client_list_size;
+	Window const* client_list_stacking; // as last written to _NET_CLIENT_LIST_STACKING, bottom to top
+	size_t const client_list_stacking_size;
+	size_t const allocated_size; // of both lists
+
+	u32 const number_of_desktops;
+	u32 const current_desktop;
+	Window const active_window;
+	sl_window_dimensions const workarea; // as last written to _NET_WORKAREA, the same for every desktop
+	u32 const workarea_desktops;
+
+	u64 const flushes;
+	u64 const appends;
+	u64 const replaces;
+} sl_ewmh_publisher;
+
+extern void sl_ewmh_publisher_create (sl_ewmh_publisher* restrict);
+extern void sl_ewmh_publisher_delete (sl_ewmh_publisher* restrict);
+
+extern void sl_ewmh_publisher_flush (sl_display* restrict);
+extern void sl_ewmh_publisher_log_statistics (sl_ewmh_publisher const* restrict);
@@ -0,0 +1,337 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "icon-cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <X11/Xatom.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "property.h"
+#include "window-mutable.h"
+#include "window.h"
+
+#ifdef D_icon_cache_log
+#	define icon_cache_log(M_message)         warn_log(M_message)
+#	define icon_cache_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define icon_cache_log(M_message)
+#	define icon_cache_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a > b) ? b : a)
+
+#define M_smallest_nonzero_size 8
+
+// in 32 bit units, icons are read this much at a time so that a big one does not need a reply of several megabytes
+#define M_icon_chunk_length 16384
+
+// a _NET_WM_ICON with more icons than this or a side longer than this is taken as garbage
+#define M_icons_size       16
+#define M_icon_side_length 1024
+
+typedef struct sl_icon_mutable {
+	u64 hash;
+	u16 size;
+	u16 width;
+	u16 height;
+	u32* pixels;
+} sl_icon_mutable;
+
+struct sl_icon_entry {
+	sl_icon_mutable icon;
+	u64 last_use;
+};
+
+typedef struct sl_icon_cache_mutable {
+	struct sl_icon_entry* entries;
+	size_t size;
+	size_t allocated_size;
+
+	size_t resident_size;
+	u64 tick;
+
+	u64 hits;
+	u64 misses;
+	u64 deduplicated;
+	u64 evictions;
+} sl_icon_cache_mutable;
+
+// where one of the icons in _NET_WM_ICON starts, in 32 bit units
+typedef struct icon_header {
+	long offset;
+	u16 width;
+	u16 height;
+} icon_header;
+
+void sl_icon_cache_create (sl_icon_cache* restrict this) { *(sl_icon_cache_mutable*)this = (sl_icon_cache_mutable) {}; }
+
+void sl_icon_cache_delete (sl_icon_cache* restrict this) {
+	for (size_t i = 0; i < this->size; ++i)
+		free(this->entries[i].icon.pixels);
+
+	if (this->entries) free(((sl_icon_cache_mutable*)this)->entries);
+}
+
+static size_t find_icon (sl_icon_cache_mutable const* restrict this, u64 hash, u16 size) {
+	size_t i = 0;
+	for (; i < this->size; ++i)
+		if (this->entries[i].icon.hash == hash && this->entries[i].icon.size == size) break;
+
+	return i;
+}
+
+// the smallest icon at least size wide and high, the biggest one when they are all smaller. only the headers are read
+static bool select_icon (sl_display* restrict display, Window x_window, u16 size, icon_header* restrict best) {
+	bool found = false;
+	long offset = 0;
+
+	for (u8 i = 0; i < M_icons_size; ++i) {
+		sl_property header = sl_property_get_range(display, x_window, display->atoms[net_wm_icon], XA_CARDINAL, offset, 2);
+
+		if (header.format != 32 || header.items_size < 2) {
+			sl_property_clear(&header);
+			break;
+		}
+
+		ulong const width = ((long*)header.data)[0];
+		ulong const height = ((long*)header.data)[1];
+		sl_property_clear(&header);
+
+		if (width == 0 || height == 0 || width > M_icon_side_length || height > M_icon_side_length) break;
+
+		u16 const side = max(width, height);
+		u16 const best_side = max(best->width, best->height);
+
+		if (!found || (best_side < size && side > best_side) || (side >= size && side < best_side))
+			*best = (icon_header) {.offset = offset, .width = width, .height = height};
+
+		found = true;
+		offset += 2 + width * height;
+	}
+
+	return found;
+}
+
+static u32* fetch_pixels (sl_display* restrict display, Window x_window, icon_header const* restrict header) {
+	long const length = (long)header->width * header->height;
+	u32* const pixels = malloc(sizeof(u32) * length);
+
+	if (!pixels) {
+		warn_log_va("size of %lu is invalid", length);
+		return NULL;
+	}
+
+	for (long done = 0; done < length;) {
+		sl_property chunk = sl_property_get_range(
+		display, x_window, display->atoms[net_wm_icon], XA_CARDINAL, header->offset + 2 + done, min(length - done, M_icon_chunk_length)
+		);
+
+		// the client replaced the icon while it was being read
+		if (chunk.format != 32 || chunk.items_size == 0) {
+			sl_property_clear(&chunk);
+			free(pixels);
+			return NULL;
+		}
+
+		ulong const items_size = min(chunk.items_size, (ulong)(length - done));
+		for (ulong i = 0; i < items_size; ++i)
+			pixels[done + i] = ((long*)chunk.data)[i];
+
+		done += items_size;
+		sl_property_clear(&chunk);
+	}
+
+	return pixels;
+}
+
+// fnv-1a over the dimensions and the pixels, never 0 so that 0 can mean unknown
+static u64 icon_hash (u16 width, u16 height, u32 const* restrict pixels) {
+	u64 hash = 0xcbf29ce484222325;
+
+	hash = (hash ^ width) * 0x100000001b3;
+	hash = (hash ^ height) * 0x100000001b3;
+
+	u8 const* const bytes = (u8 const*)pixels;
+	for (size_t i = 0; i < sizeof(u32) * width * height; ++i)
+		hash = (hash ^ bytes[i]) * 0x100000001b3;
+
+	return hash ? hash : 1;
+}
+
+// adds the channels of a source row to one plane each, a plain loop over whole arrays that the compiler vectorizes
+static void add_row (u32 const* restrict line, size_t size, u32* restrict alpha, u32* restrict red, u32* restrict green, u32* restrict blue) {
+	for (size_t i = 0; i < size; ++i) {
+		alpha[i] += line[i] >> 24;
+		red[i] += (line[i] >> 16) & 0xff;
+		green[i] += (line[i] >> 8) & 0xff;
+		blue[i] += line[i] & 0xff;
+	}
+}
+
+static u32 add_columns (u32 const* restrict plane, u16 begin, u16 end) {
+	u32 sum = 0;
+	for (u16 i = begin; i < end; ++i)
+		sum += plane[i];
+
+	return sum;
+}
+
+/*
+  box filter, every destination pixel is the average of the source pixels under it. the source rows under a destination row are added up first,
+  which touches every source pixel once and is where nearly all of the work is, then the columns under each destination pixel are added up from
+  the planes.
+*/
+static void scale_down (u32 const* restrict source, u16 source_width, u16 source_height, u32* restrict destination, u16 width, u16 height) {
+	u32 alpha[source_width], red[source_width], green[source_width], blue[source_width];
+
+	for (u16 y = 0; y < height; ++y) {
+		u16 const row_begin = (u32)y * source_height / height;
+		u16 const row_end = max((u32)(y + 1) * source_height / height, (u32)row_begin + 1);
+
+		memset(alpha, 0, sizeof(alpha));
+		memset(red, 0, sizeof(red));
+		memset(green, 0, sizeof(green));
+		memset(blue, 0, sizeof(blue));
+
+		for (u16 row = row_begin; row < row_end; ++row)
+			add_row(source + (size_t)row * source_width, source_width, alpha, red, green, blue);
+
+		for (u16 x = 0; x < width; ++x) {
+			u16 const begin = (u32)x * source_width / width;
+			u16 const end = max((u32)(x + 1) * source_width / width, (u32)begin + 1);
+			u32 const count = (u32)(row_end - row_begin) * (end - begin);
+
+			destination[(size_t)y * width + x] = add_columns(alpha, begin, end) / count << 24 | add_columns(red, begin, end) / count << 16 |
+			                                     add_columns(green, begin, end) / count << 8 | add_columns(blue, begin, end) / count;
+		}
+	}
+}
+
+static void evict (sl_icon_cache_mutable* restrict this, size_t needed) {
+	while (this->size != 0 && this->resident_size + needed > D_icon_cache_size) {
+		size_t oldest = 0;
+		for (size_t i = 1; i < this->size; ++i)
+			if (this->entries[i].last_use < this->entries[oldest].last_use) oldest = i;
+
+		sl_icon_mutable* const icon = &this->entries[oldest].icon;
+
+		icon_cache_log_va("evicting icon %lx at %u", icon->hash, icon->size);
+
+		this->resident_size -= sizeof(u32) * icon->width * icon->height;
+		free(icon->pixels);
+		this->entries[oldest] = this->entries[--this->size];
+		++this->evictions;
+	}
+}
+
+static sl_icon const* insert (sl_icon_cache_mutable* restrict this, sl_icon_mutable const* restrict icon) {
+	evict(this, sizeof(u32) * icon->width * icon->height);
+
+	if (this->size == this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		struct sl_icon_entry* entries = realloc(this->entries, sizeof(struct sl_icon_entry) * allocated_size);
+
+		if (!entries) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			free(icon->pixels);
+			return NULL;
+		}
+
+		this->entries = entries;
+		this->allocated_size = allocated_size;
+	}
+
+	this->entries[this->size] = (struct sl_icon_entry) {.icon = *icon, .last_use = this->tick};
+	this->resident_size += sizeof(u32) * icon->width * icon->height;
+
+	return (sl_icon const*)&this->entries[this->size++].icon;
+}
+
+sl_icon const* sl_icon_cache_get (sl_display* restrict display, sl_window* restrict window, u16 size) {
+	sl_icon_cache* const icon_cache = (sl_icon_cache*)&display->icon_cache;
+	sl_icon_cache_mutable* const this = (sl_icon_cache_mutable*)icon_cache;
+
+	if (size == 0) return NULL;
+
+	++this->tick;
+
+	if (window->icon_hash != 0) {
+		size_t const i = find_icon(this, window->icon_hash, size);
+
+		if (i != this->size) {
+			++this->hits;
+			this->entries[i].last_use = this->tick;
+			return (sl_icon const*)&this->entries[i].icon;
+		}
+	}
+
+	++this->misses;
+
+	icon_header header = (icon_header) {};
+	if (!select_icon(display, window->x_window, size, &header)) return NULL;
+
+	u32* pixels = fetch_pixels(display, window->x_window, &header);
+	if (!pixels) return NULL;
+
+	u64 const hash = icon_hash(header.width, header.height, pixels);
+	((sl_window_mutable*)window)->icon_hash = hash;
+
+	{
+		size_t const i = find_icon(this, hash, size);
+
+		if (i != this->size) {
+			icon_cache_log_va("[%lu] icon %lx is already cached", window->x_window, hash);
+
+			free(pixels);
+			++this->deduplicated;
+			this->entries[i].last_use = this->tick;
+			return (sl_icon const*)&this->entries[i].icon;
+		}
+	}
+
+	sl_icon_mutable icon = (sl_icon_mutable) {.hash = hash, .size = size, .width = header.width, .height = header.height, .pixels = pixels};
+
+	if (max(header.width, header.height) > size) {
+		icon.width = max((u32)header.width * size / max(header.width, header.height), 1);
+		icon.height = max((u32)header.height * size / max(header.width, header.height), 1);
+
+		if (!(icon.pixels = malloc(sizeof(u32) * icon.width * icon.height))) {
+			free(pixels);
+			return NULL;
+		}
+
+		scale_down(pixels, header.width, header.height, icon.pixels, icon.width, icon.height);
+		free(pixels);
+	}
+
+	icon_cache_log_va("[%lu] icon %lx, %ux%u scaled to %ux%u", window->x_window, hash, header.width, header.height, icon.width, icon.height);
+
+	return insert(this, &icon);
+}
+
+void sl_icon_cache_log_statistics (M_maybe_unused sl_icon_cache const* restrict this) {
+	log("icon cache: %lu hits, %lu misses (%lu%% hit rate), %lu deduplicated, %lu evictions, %lu icons in %lu bytes", this->hits, this->misses,
+	    this->hits * 100 / max(this->hits + this->misses, 1), this->deduplicated, this->evictions, this->size, this->resident_size);
+}
@@ -0,0 +1,63 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/X.h>
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+typedef struct sl_window sl_window;   // foward declaration
+
+// bytes of scaled icons kept around, override it with -DD_icon_cache_size=... in predefined.mk
+#ifndef D_icon_cache_size
+#	define D_icon_cache_size (4 << 20)
+#endif
+
+typedef struct sl_icon {
+	u64 const hash; // of the icon as the client set it, windows of the same application share it
+	u16 const size; // the size it was asked for, the icon itself fits in size x size
+	u16 const width;
+	u16 const height;
+	u32 const* pixels; // ARGB, rows left to right and top to bottom
+} sl_icon;
+
+typedef struct sl_icon_cache {
+	struct sl_icon_entry const* entries;
+	size_t const size;
+	size_t const allocated_size;
+
+	size_t const resident_size; // bytes of pixels
+	u64 const tick;
+
+	u64 const hits;
+	u64 const misses;
+	u64 const deduplicated; // misses whose icon turned out to be cached for another window already
+	u64 const evictions;
+} sl_icon_cache;
+
+extern void sl_icon_cache_create (sl_icon_cache* restrict);
+extern void sl_icon_cache_delete (sl_icon_cache* restrict);
+
+// the window's icon best fitting size, read from the server only when it is not cached. NULL when the window has none, valid until the next call
+extern sl_icon const* sl_icon_cache_get (sl_display* restrict, sl_window* restrict, u16 size);
+extern void sl_icon_cache_log_statistics (sl_icon_cache const* restrict);
@@ -0,0 +1,317 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "layout.h"
+
+#include <stdlib.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window-stack.h"
+#include "window.h"
+
+#ifdef D_layout_log
+#	define layout_log(M_message)         warn_log(M_message)
+#	define layout_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define layout_log(M_message)
+#	define layout_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 8
+
+// the share of the width the master window gets, in percent
+#define M_master_share 55
+
+typedef struct sl_layout_slot_mutable {
+	Window x_window;
+	workspace_type workspace;
+	size_t index;
+	sl_window_dimensions cell;
+	sl_window_dimensions committed;
+} sl_layout_slot_mutable;
+
+typedef struct sl_layout_mutable {
+	u8* kinds;
+	size_t kinds_size;
+
+	sl_layout_slot_mutable* slots;
+	size_t size;
+	size_t allocated_size;
+
+	u32 generation;
+	sl_window_dimensions workarea;
+	bool dirty;
+
+	u64 relayouts;
+	u64 configured;
+	u64 unchanged;
+} sl_layout_mutable;
+
+void sl_layout_create (sl_layout* restrict this) { *(sl_layout_mutable*)this = (sl_layout_mutable) {}; }
+
+void sl_layout_delete (sl_layout* restrict layout) {
+	sl_layout_mutable* const this = (sl_layout_mutable*)layout;
+
+	if (this->kinds) free(this->kinds);
+	if (this->slots) free(this->slots);
+}
+
+static bool ensure_capacity (sl_layout_mutable* restrict this, size_t size) {
+	if (size <= this->allocated_size) return true;
+
+	size_t allocated_size = max(this->allocated_size, M_smallest_nonzero_size);
+	while (allocated_size < size)
+		allocated_size <<= 1;
+
+	sl_layout_slot_mutable* const slots = realloc(this->slots, sizeof(sl_layout_slot_mutable) * allocated_size);
+
+	if (!slots) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+
+	this->slots = slots;
+	this->allocated_size = allocated_size;
+	return true;
+}
+
+static bool same_dimensions (sl_window_dimensions a, sl_window_dimensions b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static u8 kind_of (sl_layout_mutable const* restrict this, workspace_type workspace) {
+	return workspace < this->kinds_size ? this->kinds[workspace] : layout_floating;
+}
+
+// normal windows only, the ones with a leader stay over it and the ones the user let go of float
+static bool is_tiled (sl_display const* restrict display, size_t index) {
+	sl_window const* const window = &display->window_stack.data[index].window;
+
+	if (window->flags & (window_floating_bit | window_state_fullscreen_bit | window_state_hidden_bit | window_state_iconified_bit)) return false;
+	if ((window->flags & window_all_types) && !(window->flags & window_type_normal_bit)) return false;
+
+	return !sl_window_stack_is_valid_index(display->window_stack.data[index].leader);
+}
+
+// the k-th of the n columns or rows area splits into, the remainder spread so that the cells meet without gaps
+static void split (i32 start, u32 length, size_t k, size_t n, i16* position, u16* size) {
+	i32 const first = start + (i32)(length * k / n);
+	i32 const past_end = start + (i32)(length * (k + 1) / n);
+
+	*position = first;
+	*size = max(1, past_end - first);
+}
+
+static sl_window_dimensions cell_of (u8 kind, size_t k, size_t n, sl_window_dimensions area) {
+	sl_window_dimensions cell = area;
+
+	switch (kind) {
+	case layout_master_stack:
+		if (n == 1) break;
+
+		if (k == 0) {
+			cell.width = max(1, area.width * M_master_share / 100);
+			break;
+		}
+
+		cell.x = area.x + area.width * M_master_share / 100;
+		cell.width = max(1, area.width - area.width * M_master_share / 100);
+		split(area.y, area.height, k - 1, n - 1, &cell.y, &cell.height);
+		break;
+
+	case layout_grid: {
+		size_t columns = 1;
+		while (columns * columns < n)
+			++columns;
+		size_t const rows = (n + columns - 1) / columns;
+		size_t const row = k / columns;
+
+		// the last row may be short, its windows share the whole width
+		size_t const in_row = row == rows - 1 ? n - row * columns : columns;
+
+		split(area.x, area.width, k % columns, in_row, &cell.x, &cell.width);
+		split(area.y, area.height, row, rows, &cell.y, &cell.height);
+		break;
+	}
+
+	case layout_monocle: break;
+	}
+
+	return cell;
+}
+
+static void relayout (sl_display* restrict display, workspace_type workspace) {
+	sl_layout_mutable* const this = (sl_layout_mutable*)&display->layout;
+	u8 const kind = kind_of(this, workspace);
+
+	if (kind == layout_floating) return;
+
+	++this->relayouts;
+
+	for (size_t j = 0; j < this->size; ++j)
+		if (this->slots[j].workspace == workspace) this->slots[j].index = (size_t)-1;
+
+	// the windows already tiled keep their place, new ones are added at the end, a workspace holds few enough windows for a linear lookup
+	size_t const raised = display->window_stack.workspace_vector.indexes[workspace];
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			if (is_tiled(display, i)) {
+				Window const x_window = display->window_stack.data[i].window.x_window;
+
+				size_t j = 0;
+				for (; j < this->size; ++j)
+					if (this->slots[j].x_window == x_window) break;
+
+				if (j < this->size) {
+					this->slots[j].workspace = workspace;
+					this->slots[j].index = i;
+				} else if (ensure_capacity(this, this->size + 1)) {
+					this->slots[this->size++] = (sl_layout_slot_mutable) {.x_window = x_window, .workspace = workspace, .index = i};
+				}
+			}
+
+			if (i == raised) break;
+		}
+
+	size_t size = 0, n = 0;
+	for (size_t j = 0; j < this->size; ++j) {
+		if (this->slots[j].workspace == workspace && !sl_window_stack_is_valid_index(this->slots[j].index)) continue;
+		if (this->slots[j].workspace == workspace) ++n;
+		this->slots[size++] = this->slots[j];
+	}
+	this->size = size;
+
+	size_t const output = sl_outputs_showing(&display->outputs, workspace);
+	sl_window_dimensions const area = sl_outputs_area(display, output == (size_t)-1 ? sl_outputs_owner(&display->outputs, workspace) : output);
+
+	size_t k = 0;
+	for (size_t j = 0; j < this->size; ++j) {
+		sl_layout_slot_mutable* const slot = &this->slots[j];
+		if (slot->workspace != workspace) continue;
+
+		sl_window* const window = (sl_window*)&display->window_stack.data[slot->index].window;
+		sl_window_dimensions const cell = cell_of(kind, k++, n, area);
+
+		// the geometry only has to be solved again when the cell or the window moved since it was last committed
+		if (same_dimensions(cell, slot->cell) && same_dimensions(slot->committed, window->dimensions)) {
+			++this->unchanged;
+			continue;
+		}
+
+		sl_window_dimensions dimensions = cell;
+		sl_constrain_window_size(window, &dimensions.width, &dimensions.height);
+
+		sl_move_and_resize_window(display, window, dimensions);
+		slot->cell = cell;
+		slot->committed = window->dimensions;
+		++this->configured;
+	}
+
+	layout_log_va("workspace %u laid out with %lu windows", workspace, n);
+}
+
+void sl_layout_cycle (sl_display* restrict display) {
+	sl_layout_mutable* const this = (sl_layout_mutable*)&display->layout;
+	workspace_type const workspace = display->window_stack.current_workspace;
+
+	if (workspace >= this->kinds_size) {
+		u8* const kinds = realloc(this->kinds, sizeof(u8) * (workspace + 1));
+
+		if (!kinds) {
+			warn_log_va("size of %u is invalid", workspace + 1);
+			return;
+		}
+
+		for (size_t i = this->kinds_size; i <= workspace; ++i)
+			kinds[i] = layout_floating;
+
+		this->kinds = kinds;
+		this->kinds_size = workspace + 1;
+	}
+
+	this->kinds[workspace] = (this->kinds[workspace] + 1) % layouts_size;
+	this->dirty = true;
+
+	// back to floating, the windows go back to where they were before they were tiled
+	if (this->kinds[workspace] == layout_floating) {
+		size_t size = 0;
+
+		for (size_t j = 0; j < this->size; ++j) {
+			if (this->slots[j].workspace != workspace) {
+				this->slots[size++] = this->slots[j];
+				continue;
+			}
+
+			size_t const i = this->slots[j].index;
+			if (sl_window_stack_is_valid_index(i) && i < display->window_stack.size && display->window_stack.data[i].window.x_window == this->slots[j].x_window) {
+				sl_window* const window = (sl_window*)&display->window_stack.data[i].window;
+				sl_move_and_resize_window(display, window, window->saved_dimensions);
+			}
+		}
+
+		this->size = size;
+	}
+
+	layout_log_va("workspace %u now has layout %u", workspace, this->kinds[workspace]);
+}
+
+void sl_layout_mark_dirty (sl_display* restrict display) {
+	sl_layout_mutable* const this = (sl_layout_mutable*)&display->layout;
+	this->dirty = true;
+}
+
+void sl_layout_flush (sl_display* restrict display) {
+	sl_layout_mutable* const this = (sl_layout_mutable*)&display->layout;
+
+	// only the workspaces shown are laid out, the others are when they are switched to, which moves the generation on
+	if (!this->dirty && this->generation == display->window_stack.generation && same_dimensions(this->workarea, display->workarea.area)) return;
+
+	this->dirty = false;
+	this->generation = display->window_stack.generation;
+	this->workarea = display->workarea.area;
+
+	// the cells of the outputs that did not change come out the same and their windows are left alone
+	for (size_t i = 0; i < display->outputs.size; ++i)
+		relayout(display, display->outputs.data[i].workspace);
+}
+
+bool sl_layout_holds_window (sl_layout const* restrict this, Window x_window) {
+	for (size_t j = 0; j < this->size; ++j)
+		if (this->slots[j].x_window == x_window) return true;
+
+	return false;
+}
+
+void sl_layout_float_window (sl_display* restrict display, size_t index) {
+	sl_layout_mutable* const this = (sl_layout_mutable*)&display->layout;
+	sl_window* const window = (sl_window*)&display->window_stack.data[index].window;
+
+	if (!sl_layout_holds_window(&display->layout, window->x_window)) return;
+
+	window->flags |= window_floating_bit;
+	this->dirty = true;
+}
+
+void sl_layout_log_statistics (M_maybe_unused sl_layout const* restrict this) {
+	log("layout: %lu relayouts, %lu windows configured, %lu left unchanged", this->relayouts, this->configured, this->unchanged);
+}
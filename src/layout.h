@@ -0,0 +1,70 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/X.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+#include "workspace-type.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+enum { layout_floating, layout_master_stack, layout_grid, layout_monocle, layouts_size };
+
+// a window tiled on a workspace, the slots of a workspace are in the order its windows were first tiled in
+typedef struct sl_layout_slot {
+	Window const x_window;
+	workspace_type const workspace;
+	size_t const index; // in the window stack, as of the last relayout
+	sl_window_dimensions const cell;
+	sl_window_dimensions const committed; // what the cell was solved to and the window was configured with
+} sl_layout_slot;
+
+typedef struct sl_layout {
+	u8 const* kinds; // one per workspace, the ones past the end are floating
+	size_t const kinds_size;
+
+	sl_layout_slot const* slots;
+	size_t const size;
+	size_t const allocated_size;
+
+	u32 const generation; // of the window stack the shown workspaces were laid out at
+	sl_window_dimensions const workarea;
+	bool const dirty;
+
+	u64 const relayouts;
+	u64 const configured;
+	u64 const unchanged;
+} sl_layout;
+
+extern void sl_layout_create (sl_layout* restrict);
+extern void sl_layout_delete (sl_layout* restrict);
+
+extern void sl_layout_cycle (sl_display* restrict); // the layout of the current workspace
+extern void sl_layout_mark_dirty (sl_display* restrict);
+extern void sl_layout_flush (sl_display* restrict); // lays the shown workspaces out again if anything they depend on changed
+
+extern bool sl_layout_holds_window (sl_layout const* restrict, Window);
+extern void sl_layout_float_window (sl_display* restrict, size_t index); // takes it out of the tiling for good
+
+extern void sl_layout_log_statistics (sl_layout const* restrict);
@@ -0,0 +1,128 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "level-backend.h"
+
+#ifdef D_alsa
+
+#	include <alsa/asoundlib.h>
+
+#	include "compiler-differences.h"
+#	include "message.h"
+
+// link with -lasound
+
+#	define M_alsa_card         "default"
+#	define M_alsa_mixer_element "Master"
+
+struct alsa_state {
+	snd_mixer_t* mixer;
+	snd_mixer_elem_t* element;
+	long min;
+	long max;
+};
+
+static bool alsa_open (M_maybe_unused sl_display* restrict display, void** state) {
+	struct alsa_state* alsa = malloc(sizeof(struct alsa_state));
+	if (!alsa) return false;
+
+	int error;
+
+	if ((error = snd_mixer_open(&alsa->mixer, 0)) < 0) goto out_free;
+	if ((error = snd_mixer_attach(alsa->mixer, M_alsa_card)) < 0) goto out_close;
+	if ((error = snd_mixer_selem_register(alsa->mixer, NULL, NULL)) < 0) goto out_close;
+	if ((error = snd_mixer_load(alsa->mixer)) < 0) goto out_close;
+
+	{
+		snd_mixer_selem_id_t* id;
+		if ((error = snd_mixer_selem_id_malloc(&id)) < 0) goto out_close;
+
+		snd_mixer_selem_id_set_index(id, 0);
+		snd_mixer_selem_id_set_name(id, M_alsa_mixer_element);
+		alsa->element = snd_mixer_find_selem(alsa->mixer, id);
+
+		snd_mixer_selem_id_free(id);
+	}
+
+	if (!alsa->element) {
+		warn_log("alsa: no " M_alsa_mixer_element " mixer element");
+		goto out_close_quiet;
+	}
+
+	if ((error = snd_mixer_selem_get_playback_volume_range(alsa->element, &alsa->min, &alsa->max)) < 0) goto out_close;
+	if (alsa->max <= alsa->min) goto out_close_quiet;
+
+	*state = alsa;
+	return true;
+
+out_close:
+	warn_log_va("alsa: %s", snd_strerror(error));
+out_close_quiet:
+	snd_mixer_close(alsa->mixer);
+	free(alsa);
+	return false;
+out_free:
+	warn_log_va("alsa: %s", snd_strerror(error));
+	free(alsa);
+	return false;
+}
+
+static void alsa_close (void* state) {
+	struct alsa_state* alsa = state;
+
+	snd_mixer_close(alsa->mixer);
+	free(alsa);
+}
+
+static bool alsa_get (void* state, i32* percent) {
+	struct alsa_state* alsa = state;
+
+	// pick up changes made by other mixers since the last time we looked
+	snd_mixer_handle_events(alsa->mixer);
+
+	long value;
+	if (snd_mixer_selem_get_playback_volume(alsa->element, SND_MIXER_SCHN_FRONT_LEFT, &value) < 0) return false;
+
+	*percent = ((value - alsa->min) * 100 + (alsa->max - alsa->min) / 2) / (alsa->max - alsa->min);
+	return true;
+}
+
+static bool alsa_set (void* state, i32 percent) {
+	struct alsa_state* alsa = state;
+
+	return snd_mixer_selem_set_playback_volume_all(alsa->element, alsa->min + (percent * (alsa->max - alsa->min) + 50) / 100) >= 0;
+}
+
+static bool alsa_toggle_mute (void* state) {
+	struct alsa_state* alsa = state;
+
+	if (!snd_mixer_selem_has_playback_switch(alsa->element)) return false;
+
+	snd_mixer_handle_events(alsa->mixer);
+
+	int on;
+	if (snd_mixer_selem_get_playback_switch(alsa->element, SND_MIXER_SCHN_FRONT_LEFT, &on) < 0) return false;
+
+	return snd_mixer_selem_set_playback_switch_all(alsa->element, !on) >= 0;
+}
+
+sl_level_backend const sl_alsa_volume_backend = {
+.name = "alsa", .open = &alsa_open, .close = &alsa_close, .get = &alsa_get, .set = &alsa_set, .toggle_mute = &alsa_toggle_mute};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "level-backend.h"
+
+#include <stdio.h>
+
+#include "compiler-differences.h"
+#include "util.h"
+
+/*
+  the fallbacks for when no in-process backend is available, they still fork a process for every change but the changes coming from a held key
+  are merged into one
+*/
+
+static bool stateless_open (M_maybe_unused sl_display* restrict display, void** state) {
+	*state = NULL;
+	return true;
+}
+
+static void stateless_close (M_maybe_unused void* state) {}
+
+static bool amixer_add (M_maybe_unused void* state, i32 delta) {
+	char amount[16];
+	snprintf(amount, sizeof(amount), "%i%%%c", delta < 0 ? -delta : delta, delta < 0 ? '-' : '+');
+
+	char* const args[] = {"amixer", "-q", "sset", "Master", amount, 0};
+	exec_program(NULL, args);
+	return true;
+}
+
+static bool amixer_set (M_maybe_unused void* state, i32 percent) {
+	char amount[16];
+	snprintf(amount, sizeof(amount), "%i%%", percent);
+
+	char* const args[] = {"amixer", "-q", "sset", "Master", amount, 0};
+	exec_program(NULL, args);
+	return true;
+}
+
+static bool amixer_toggle_mute (M_maybe_unused void* state) {
+	char* const args[] = {"amixer", "-q", "sset", "Master", "toggle", 0};
+	exec_program(NULL, args);
+	return true;
+}
+
+sl_level_backend const sl_amixer_volume_backend = {
+.name = "amixer", .open = &stateless_open, .close = &stateless_close, .set = &amixer_set, .add = &amixer_add, .toggle_mute = &amixer_toggle_mute};
+
+static bool xbacklight_add (M_maybe_unused void* state, i32 delta) {
+	char amount[16];
+	snprintf(amount, sizeof(amount), "%i", delta < 0 ? -delta : delta);
+
+	char* const args[] = {"xbacklight", delta < 0 ? "-" : "+", amount, 0};
+	exec_program(NULL, args);
+	return true;
+}
+
+static bool xbacklight_set (M_maybe_unused void* state, i32 percent) {
+	char amount[16];
+	snprintf(amount, sizeof(amount), "%i", percent);
+
+	char* const args[] = {"xbacklight", "-set", amount, 0};
+	exec_program(NULL, args);
+	return true;
+}
+
+sl_level_backend const sl_xbacklight_backend = {
+.name = "xbacklight", .open = &stateless_open, .close = &stateless_close, .set = &xbacklight_set, .add = &xbacklight_add};
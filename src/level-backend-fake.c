@@ -0,0 +1,110 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "level-backend.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "compiler-differences.h"
+#include "message.h"
+
+/*
+  a backend that keeps the level in a plain file instead of touching any hardware, for trying the key handling out on a machine (or in a nested
+  X server) where the real mixer or backlight should be left alone. the file holds the level followed by the mute switch.
+*/
+
+#ifndef D_fake_media_directory
+#	define D_fake_media_directory "/tmp/glass-shard"
+#endif
+
+struct fake_state {
+	char path[PATH_MAX];
+};
+
+static bool fake_read (struct fake_state const* fake, i32* percent, i32* muted) {
+	FILE* stream = fopen(fake->path, "r");
+	if (!stream) return false;
+
+	bool const success = fscanf(stream, "%i %i", percent, muted) == 2;
+
+	fclose(stream);
+	return success;
+}
+
+static bool fake_write (struct fake_state const* fake, i32 percent, i32 muted) {
+	FILE* stream = fopen(fake->path, "w");
+	if (!stream) return false;
+
+	bool success = fprintf(stream, "%i %i\n", percent, muted) > 0;
+	if (fclose(stream) != 0) success = false;
+
+	return success;
+}
+
+static bool fake_open (char const* name, void** state) {
+	if (mkdir(D_fake_media_directory, 0700) == -1 && errno != EEXIST) return false;
+
+	struct fake_state* fake = malloc(sizeof(struct fake_state));
+	if (!fake) return false;
+
+	snprintf(fake->path, sizeof(fake->path), D_fake_media_directory "/%s", name);
+
+	i32 percent, muted;
+	if (!fake_read(fake, &percent, &muted) && !fake_write(fake, 50, 0)) {
+		free(fake);
+		return false;
+	}
+
+	*state = fake;
+	return true;
+}
+
+static bool fake_volume_open (M_maybe_unused sl_display* restrict display, void** state) { return fake_open("volume", state); }
+
+static bool fake_brightness_open (M_maybe_unused sl_display* restrict display, void** state) { return fake_open("brightness", state); }
+
+static void fake_close (void* state) { free(state); }
+
+static bool fake_get (void* state, i32* percent) {
+	i32 muted;
+	return fake_read(state, percent, &muted);
+}
+
+static bool fake_set (void* state, i32 percent) {
+	i32 old_percent, muted;
+	if (!fake_read(state, &old_percent, &muted)) muted = 0;
+
+	return fake_write(state, percent, muted);
+}
+
+static bool fake_toggle_mute (void* state) {
+	i32 percent, muted;
+	if (!fake_read(state, &percent, &muted)) return false;
+
+	return fake_write(state, percent, !muted);
+}
+
+sl_level_backend const sl_fake_volume_backend = {
+.name = "fake", .open = &fake_volume_open, .close = &fake_close, .get = &fake_get, .set = &fake_set, .toggle_mute = &fake_toggle_mute};
+
+sl_level_backend const sl_fake_brightness_backend = {
+.name = "fake", .open = &fake_brightness_open, .close = &fake_close, .get = &fake_get, .set = &fake_set};
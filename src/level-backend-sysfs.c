@@ -0,0 +1,111 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "level-backend.h"
+
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "compiler-differences.h"
+#include "message.h"
+
+#define M_sysfs_backlight_directory "/sys/class/backlight"
+
+/*
+  writing the brightness file needs write access to it, usually granted to the video group by a udev rule. without it the backend is not used.
+*/
+
+struct sysfs_state {
+	char brightness_path[PATH_MAX];
+	char actual_brightness_path[PATH_MAX];
+	i32 max;
+};
+
+static bool read_i32 (char const* path, i32* value) {
+	FILE* stream = fopen(path, "r");
+	if (!stream) return false;
+
+	bool const success = fscanf(stream, "%i", value) == 1;
+
+	fclose(stream);
+	return success;
+}
+
+static bool sysfs_open (M_maybe_unused sl_display* restrict display, void** state) {
+	DIR* directory = opendir(M_sysfs_backlight_directory);
+	if (!directory) return false;
+
+	struct sysfs_state* sysfs = NULL;
+
+	for (struct dirent* entry; (entry = readdir(directory));) {
+		if (entry->d_name[0] == '.') continue;
+
+		char path[PATH_MAX];
+		i32 max;
+
+		snprintf(path, sizeof(path), M_sysfs_backlight_directory "/%s/max_brightness", entry->d_name);
+		if (!read_i32(path, &max) || max <= 0) continue;
+
+		snprintf(path, sizeof(path), M_sysfs_backlight_directory "/%s/brightness", entry->d_name);
+		if (access(path, W_OK) != 0) continue;
+
+		if (!(sysfs = malloc(sizeof(struct sysfs_state)))) break;
+
+		sysfs->max = max;
+		memcpy(sysfs->brightness_path, path, sizeof(path));
+		snprintf(sysfs->actual_brightness_path, sizeof(sysfs->actual_brightness_path), M_sysfs_backlight_directory "/%s/actual_brightness", entry->d_name);
+		break;
+	}
+
+	closedir(directory);
+
+	if (!sysfs) return false;
+
+	*state = sysfs;
+	return true;
+}
+
+static void sysfs_close (void* state) { free(state); }
+
+static bool sysfs_get (void* state, i32* percent) {
+	struct sysfs_state* sysfs = state;
+
+	i32 value;
+	if (!read_i32(sysfs->actual_brightness_path, &value) && !read_i32(sysfs->brightness_path, &value)) return false;
+
+	*percent = (value * 100 + sysfs->max / 2) / sysfs->max;
+	return true;
+}
+
+static bool sysfs_set (void* state, i32 percent) {
+	struct sysfs_state* sysfs = state;
+
+	FILE* stream = fopen(sysfs->brightness_path, "w");
+	if (!stream) return false;
+
+	bool success = fprintf(stream, "%i", (percent * sysfs->max + 50) / 100) > 0;
+	if (fclose(stream) != 0) success = false;
+
+	return success;
+}
+
+sl_level_backend const sl_sysfs_backlight_backend = {.name = "sysfs", .open = &sysfs_open, .close = &sysfs_close, .get = &sysfs_get, .set = &sysfs_set};
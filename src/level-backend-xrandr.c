@@ -0,0 +1,122 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "level-backend.h"
+
+#ifdef D_xrandr
+
+#	include <X11/Xatom.h>
+#	include <X11/Xlib.h>
+#	include <X11/extensions/Xrandr.h>
+
+#	include "display.h"
+#	include "message.h"
+
+// link with -lXrandr
+
+/*
+  drivers that expose the panel backlight through randr publish it as an integer output property with a range, "Backlight" on most drivers and
+  "BACKLIGHT" on some older ones
+*/
+
+struct xrandr_state {
+	Display* x_display;
+	RROutput output;
+	Atom property;
+	long min;
+	long max;
+};
+
+static bool find_backlight (Display* x_display, RROutput output, Atom property, struct xrandr_state* xrandr) {
+	if (property == None) return false;
+
+	XRRPropertyInfo* info = XRRQueryOutputProperty(x_display, output, property);
+	if (!info) return false;
+
+	bool const found = info->range && info->num_values == 2 && info->values[1] > info->values[0];
+
+	if (found) *xrandr = (struct xrandr_state) {.x_display = x_display, .output = output, .property = property, .min = info->values[0], .max = info->values[1]};
+
+	XFree(info);
+	return found;
+}
+
+static bool xrandr_open (sl_display* restrict display, void** state) {
+	int event_base, error_base;
+	if (!XRRQueryExtension(display->x_display, &event_base, &error_base)) return false;
+
+	XRRScreenResources* resources = XRRGetScreenResourcesCurrent(display->x_display, display->root);
+	if (!resources) return false;
+
+	Atom const backlight = XInternAtom(display->x_display, "Backlight", true);
+	Atom const legacy_backlight = XInternAtom(display->x_display, "BACKLIGHT", true);
+
+	struct xrandr_state xrandr;
+	bool found = false;
+
+	for (int i = 0; i < resources->noutput && !found; ++i)
+		found = find_backlight(display->x_display, resources->outputs[i], backlight, &xrandr) ||
+		find_backlight(display->x_display, resources->outputs[i], legacy_backlight, &xrandr);
+
+	XRRFreeScreenResources(resources);
+
+	if (!found) return false;
+
+	struct xrandr_state* copy = malloc(sizeof(struct xrandr_state));
+	if (!copy) return false;
+
+	*copy = xrandr;
+	*state = copy;
+	return true;
+}
+
+static void xrandr_close (void* state) { free(state); }
+
+static bool xrandr_get (void* state, i32* percent) {
+	struct xrandr_state* xrandr = state;
+
+	Atom actual_type;
+	int actual_format;
+	ulong items_size;
+	ulong bytes_after;
+	uchar* prop = NULL;
+
+	if (XRRGetOutputProperty(xrandr->x_display, xrandr->output, xrandr->property, 0, 1, false, false, XA_INTEGER, &actual_type, &actual_format, &items_size, &bytes_after, &prop) != Success)
+		return false;
+
+	bool const success = actual_type == XA_INTEGER && actual_format == 32 && items_size == 1;
+
+	if (success) *percent = ((*(long*)prop - xrandr->min) * 100 + (xrandr->max - xrandr->min) / 2) / (xrandr->max - xrandr->min);
+
+	if (prop) XFree(prop);
+	return success;
+}
+
+static bool xrandr_set (void* state, i32 percent) {
+	struct xrandr_state* xrandr = state;
+
+	long value = xrandr->min + (percent * (xrandr->max - xrandr->min) + 50) / 100;
+
+	XRRChangeOutputProperty(xrandr->x_display, xrandr->output, xrandr->property, XA_INTEGER, 32, PropModeReplace, (uchar*)&value, 1);
+	return true;
+}
+
+sl_level_backend const sl_xrandr_backlight_backend = {.name = "xrandr", .open = &xrandr_open, .close = &xrandr_close, .get = &xrandr_get, .set = &xrandr_set};
+
+#endif
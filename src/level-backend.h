@@ -0,0 +1,54 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+/*
+  a level backend controls one 0 to 100 percent level, the volume or the display brightness. backends which can read the current level implement
+  get and receive the pending changes as one absolute set, the ones that can not (the command line fallbacks) receive their sum through add.
+*/
+typedef struct sl_level_backend {
+	char const* name;
+
+	bool (*open) (sl_display* restrict, void** state); // false when the backend is not usable on this system
+	void (*close) (void* state);
+
+	bool (*get) (void* state, i32* percent);
+	bool (*set) (void* state, i32 percent);
+	bool (*add) (void* state, i32 delta);
+	bool (*toggle_mute) (void* state);
+} sl_level_backend;
+
+#ifdef D_alsa
+extern sl_level_backend const sl_alsa_volume_backend;
+#endif
+extern sl_level_backend const sl_amixer_volume_backend;
+
+#ifdef D_xrandr
+extern sl_level_backend const sl_xrandr_backlight_backend;
+#endif
+extern sl_level_backend const sl_sysfs_backlight_backend;
+extern sl_level_backend const sl_xbacklight_backend;
+
+extern sl_level_backend const sl_fake_volume_backend;
+extern sl_level_backend const sl_fake_brightness_backend;
@@ -0,0 +1,193 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "low-latency.h"
+
+#include <stdlib.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "event-responses.h"
+#include "message.h"
+#include "timer.h"
+#include "window-stack.h"
+#include "window.h"
+
+#ifdef D_low_latency_log
+#	define low_latency_log(M_message)         warn_log(M_message)
+#	define low_latency_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define low_latency_log(M_message)
+#	define low_latency_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 8
+
+typedef struct sl_deferred_property_mutable {
+	Window x_window;
+	Atom atom;
+} sl_deferred_property_mutable;
+
+typedef struct sl_low_latency_mutable {
+	bool active;
+	Window x_window;
+
+	sl_deferred_property_mutable* deferred;
+	size_t size;
+	size_t allocated_size;
+
+	u64 entered;
+	u64 properties_deferred;
+	u64 properties_coalesced;
+	u64 timers_deferred;
+} sl_low_latency_mutable;
+
+// the timers that only tidy up after the user, the others either answer the window in front or were asked for just now
+static size_t const paused_timers[] = {timer_process_priority};
+
+void sl_low_latency_create (sl_low_latency* restrict this) { *(sl_low_latency_mutable*)this = (sl_low_latency_mutable) {}; }
+
+void sl_low_latency_delete (sl_low_latency* restrict low_latency) {
+	sl_low_latency_mutable* const this = (sl_low_latency_mutable*)low_latency;
+
+	if (this->deferred) free(this->deferred);
+}
+
+static bool ensure_capacity (sl_low_latency_mutable* restrict this, size_t size) {
+	if (size <= this->allocated_size) return true;
+
+	size_t allocated_size = max(this->allocated_size, M_smallest_nonzero_size);
+	while (allocated_size < size)
+		allocated_size <<= 1;
+
+	sl_deferred_property_mutable* const deferred = realloc(this->deferred, sizeof(sl_deferred_property_mutable) * allocated_size);
+
+	if (!deferred) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+
+	this->deferred = deferred;
+	this->allocated_size = allocated_size;
+	return true;
+}
+
+static void enter (sl_display* restrict display, Window x_window) {
+	sl_low_latency_mutable* const this = (sl_low_latency_mutable*)&display->low_latency;
+
+	low_latency_log_va("[%lu] fullscreen window focused, entering low latency mode", x_window);
+
+	this->active = true;
+	this->x_window = x_window;
+	++this->entered;
+
+	for (size_t i = 0; i < sizeof(paused_timers) / sizeof(paused_timers[0]); ++i) {
+		sl_timer* const timer = &display->timers[paused_timers[i]];
+
+		// what was already due is done now, the focus that got us here is the one it is about
+		if (sl_timer_is_armed(timer)) {
+			sl_timer_disarm(timer);
+			if (timer->callback) timer->callback(display);
+		}
+
+		timer->paused = true;
+	}
+
+#ifdef D_low_latency_ungrab_keys
+	sl_grab_keys(display);
+#endif
+
+	sl_log_suspended = true;
+}
+
+static void leave (sl_display* restrict display) {
+	sl_low_latency_mutable* const this = (sl_low_latency_mutable*)&display->low_latency;
+
+	sl_log_suspended = false;
+
+	low_latency_log_va("[%lu] leaving low latency mode, %lu properties deferred", this->x_window, this->size);
+
+	this->active = false;
+	this->x_window = None;
+
+#ifdef D_low_latency_ungrab_keys
+	sl_grab_keys(display);
+#endif
+
+	for (size_t i = 0; i < sizeof(paused_timers) / sizeof(paused_timers[0]); ++i) {
+		sl_timer* const timer = &display->timers[paused_timers[i]];
+
+		if (sl_timer_is_armed(timer)) ++this->timers_deferred;
+		timer->paused = false;
+	}
+
+	// as if they had just changed, the newest value is read since they are read again from the window
+	for (size_t i = 0; i < this->size; ++i) {
+		XPropertyEvent event = {
+		.type = PropertyNotify,
+		.display = display->x_display,
+		.window = this->deferred[i].x_window,
+		.atom = this->deferred[i].atom,
+		.time = CurrentTime,
+		.state = PropertyNewValue};
+
+		sl_property_notify(display, &event);
+	}
+
+	this->size = 0;
+}
+
+void sl_low_latency_update (sl_display* restrict display) {
+	sl_low_latency_mutable* const this = (sl_low_latency_mutable*)&display->low_latency;
+
+	sl_window const* const focused = sl_window_stack_get_focused_window((sl_window_stack*)&display->window_stack);
+	Window const x_window = focused && (focused->flags & window_state_fullscreen_bit) ? focused->x_window : None;
+
+	if (x_window == this->x_window) return;
+
+	if (this->active) leave(display);
+	if (x_window != None) enter(display, x_window);
+}
+
+bool sl_low_latency_defer_property (sl_display* restrict display, XPropertyEvent const* restrict event) {
+	sl_low_latency_mutable* const this = (sl_low_latency_mutable*)&display->low_latency;
+
+	if (!this->active || event->window == this->x_window || event->window == display->root) return false;
+
+	for (size_t i = 0; i < this->size; ++i)
+		if (this->deferred[i].x_window == event->window && this->deferred[i].atom == event->atom) {
+			++this->properties_deferred;
+			++this->properties_coalesced;
+			return true;
+		}
+
+	if (!ensure_capacity(this, this->size + 1)) return false;
+
+	this->deferred[this->size++] = (sl_deferred_property_mutable) {.x_window = event->window, .atom = event->atom};
+	++this->properties_deferred;
+	return true;
+}
+
+void sl_low_latency_log_statistics (M_maybe_unused sl_low_latency const* restrict this) {
+	log("low latency: entered %lu times, %lu property notifications deferred, %lu of them coalesced, %lu timer expirations deferred, %lu messages "
+	    "not logged",
+	    this->entered, this->properties_deferred, this->properties_coalesced, this->timers_deferred, sl_logs_suppressed);
+}
@@ -0,0 +1,59 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/Xlib.h>
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+typedef struct sl_deferred_property {
+	Window const x_window;
+	Atom const atom;
+} sl_deferred_property;
+
+/*
+  while a fullscreen window has the focus the window manager keeps out of its way: logging is suspended, the properties of the other windows are
+  read when it is left, and the timers that are not needed pause (the messages that were not logged are counted by sl_logs_suppressed)
+*/
+typedef struct sl_low_latency {
+	bool const active;
+	Window const x_window; // the fullscreen window, None when it is not active
+
+	sl_deferred_property const* deferred; // each property once, however often it changed
+	size_t const size;
+	size_t const allocated_size;
+
+	u64 const entered;
+	u64 const properties_deferred;  // notifications that were not handled as they came
+	u64 const properties_coalesced; // of them, the ones that were already pending
+	u64 const timers_deferred;      // expirations that waited for the mode to be left
+} sl_low_latency;
+
+extern void sl_low_latency_create (sl_low_latency* restrict);
+extern void sl_low_latency_delete (sl_low_latency* restrict);
+
+extern void sl_low_latency_update (sl_display* restrict); // enters or leaves the mode as the focus and the fullscreen state say
+extern bool sl_low_latency_defer_property (sl_display* restrict, XPropertyEvent const* restrict); // whether it was put aside
+
+extern void sl_low_latency_log_statistics (sl_low_latency const* restrict);
@@ -0,0 +1,165 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "media-control.h"
+
+#include "display.h"
+#include "message.h"
+#include "timer.h"
+
+#ifdef D_media_control_log
+#	define media_control_log(M_message)         warn_log(M_message)
+#	define media_control_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define media_control_log(M_message)
+#	define media_control_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a > b) ? b : a)
+
+/*
+  a held key repeats every few tens of milliseconds, the changes coming in during this window are added together and applied as one absolute level
+*/
+#define M_media_coalesce_interval (40 * M_nanoseconds_per_millisecond)
+
+typedef struct sl_media_channel_mutable {
+	sl_level_backend const* backend;
+	void* state;
+
+	i32 pending_delta;
+} sl_media_channel_mutable;
+
+typedef struct sl_media_control_mutable {
+	sl_media_channel_mutable channels[media_channels_size];
+} sl_media_control_mutable;
+
+static sl_level_backend const* const volume_backends[] = {
+#ifdef D_fake_media_backends
+&sl_fake_volume_backend,
+#endif
+#ifdef D_alsa
+&sl_alsa_volume_backend,
+#endif
+&sl_amixer_volume_backend};
+
+static sl_level_backend const* const brightness_backends[] = {
+#ifdef D_fake_media_backends
+&sl_fake_brightness_backend,
+#endif
+#ifdef D_xrandr
+&sl_xrandr_backlight_backend,
+#endif
+&sl_sysfs_backlight_backend, &sl_xbacklight_backend};
+
+static u8 const channel_timers[media_channels_size] = {[media_volume] = timer_volume, [media_brightness] = timer_brightness};
+
+static void open_channel (sl_media_channel_mutable* restrict channel, sl_display* restrict display, sl_level_backend const* const* backends, size_t size) {
+	// the first backend that opens wins, the last one of each list always does
+	for (size_t i = 0; i < size; ++i) {
+		if (!backends[i]->open(display, &channel->state)) continue;
+
+		media_control_log_va("using the %s backend", backends[i]->name);
+		channel->backend = backends[i];
+		return;
+	}
+}
+
+void sl_media_control_create (sl_media_control* restrict this, sl_display* restrict display) {
+	sl_media_control_mutable* const control = (sl_media_control_mutable*)this;
+
+	*control = (sl_media_control_mutable) {};
+
+	open_channel(&control->channels[media_volume], display, volume_backends, sizeof(volume_backends) / sizeof(volume_backends[0]));
+	open_channel(&control->channels[media_brightness], display, brightness_backends, sizeof(brightness_backends) / sizeof(brightness_backends[0]));
+}
+
+void sl_media_control_delete (sl_media_control* restrict this) {
+	for (u8 i = 0; i < media_channels_size; ++i)
+		if (this->channels[i].backend) this->channels[i].backend->close(this->channels[i].state);
+
+	*(sl_media_control_mutable*)this = (sl_media_control_mutable) {};
+}
+
+static void flush_channel (sl_display* restrict display, u8 index) {
+	sl_media_control* const control = (sl_media_control*)&display->media_control;
+	sl_media_channel_mutable* const channel = &((sl_media_control_mutable*)control)->channels[index];
+
+	i32 const delta = channel->pending_delta;
+	channel->pending_delta = 0;
+
+	if (!channel->backend || delta == 0) return;
+
+	if (channel->backend->get && channel->backend->set) {
+		i32 percent;
+		if (channel->backend->get(channel->state, &percent)) {
+			percent = min(100, max(0, percent + delta));
+
+			media_control_log_va("setting level to %i%%", percent);
+			if (!channel->backend->set(channel->state, percent)) warn_log_va("the %s backend could not set the level", channel->backend->name);
+
+			return;
+		}
+	}
+
+	if (channel->backend->add) {
+		media_control_log_va("adding %i%% to the level", delta);
+		if (!channel->backend->add(channel->state, delta)) warn_log_va("the %s backend could not change the level", channel->backend->name);
+	}
+}
+
+void sl_media_flush_volume (sl_display* restrict display) { flush_channel(display, media_volume); }
+
+void sl_media_flush_brightness (sl_display* restrict display) { flush_channel(display, media_brightness); }
+
+void sl_media_adjust (sl_display* restrict display, u8 index, i32 delta) {
+	sl_media_control* const control = (sl_media_control*)&display->media_control;
+	sl_media_channel_mutable* const channel = &((sl_media_control_mutable*)control)->channels[index];
+
+	channel->pending_delta += delta;
+
+	sl_timer* const timer = &display->timers[channel_timers[index]];
+
+	if (!sl_timer_is_armed(timer)) sl_timer_arm(timer, sl_monotonic_time() + M_media_coalesce_interval);
+}
+
+void sl_media_set (sl_display* restrict display, u8 index, i32 percent) {
+	sl_media_control* const control = (sl_media_control*)&display->media_control;
+	sl_media_channel_mutable* const channel = &((sl_media_control_mutable*)control)->channels[index];
+
+	// an absolute level replaces whatever was still pending
+	sl_timer_disarm(&display->timers[channel_timers[index]]);
+	channel->pending_delta = 0;
+
+	if (!channel->backend || !channel->backend->set) return;
+
+	if (!channel->backend->set(channel->state, min(100, max(0, percent)))) warn_log_va("the %s backend could not set the level", channel->backend->name);
+}
+
+void sl_media_toggle_mute (sl_display* restrict display) {
+	sl_media_channel const* const channel = &display->media_control.channels[media_volume];
+
+	if (!channel->backend || !channel->backend->toggle_mute) return;
+
+	// apply the pending changes first so that the order of the key presses is kept
+	sl_timer_disarm(&display->timers[timer_volume]);
+	sl_media_flush_volume(display);
+
+	if (!channel->backend->toggle_mute(channel->state)) warn_log_va("the %s backend could not toggle mute", channel->backend->name);
+}
@@ -0,0 +1,52 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "level-backend.h"
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+enum {
+	media_volume,
+	media_brightness,
+	media_channels_size
+};
+
+typedef struct sl_media_channel {
+	sl_level_backend const* const backend;
+	void* const state;
+
+	i32 const pending_delta; // sum of the changes not yet sent to the backend
+} sl_media_channel;
+
+typedef struct sl_media_control {
+	sl_media_channel const channels[media_channels_size];
+} sl_media_control;
+
+extern void sl_media_control_create (sl_media_control* restrict, sl_display* restrict);
+extern void sl_media_control_delete (sl_media_control* restrict);
+
+extern void sl_media_adjust (sl_display* restrict, u8 channel, i32 delta);
+extern void sl_media_set (sl_display* restrict, u8 channel, i32 percent);
+extern void sl_media_toggle_mute (sl_display* restrict);
+
+extern void sl_media_flush_volume (sl_display* restrict);
+extern void sl_media_flush_brightness (sl_display* restrict);
@@ -16,17 +16,500 @@
   along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 
+
 #include "message.h"
 
+#include "compiler-differences.h"
+
 #ifndef D_quiet
+#	include <linux/futex.h>
+#	include <pthread.h>
+#	include <signal.h>
+#	include <stdarg.h>
+#	include <stddef.h>
+#	include <stdint.h>
+#	include <string.h>
+#	include <sys/syscall.h>
+#	include <time.h>
+#	include <unistd.h>
+#endif
+
+_Thread_local bool sl_log_suspended;
+_Thread_local u64 sl_logs_suppressed;
+
+_Atomic u8 sl_log_level = log_level_info;
+
+static void clamp_level (int level) { sl_log_level = level < log_level_error ? log_level_error : level > log_level_info ? log_level_info : level; }
+
+#ifndef D_quiet
+
+#	define M_log_entry_size     256 // bytes, arguments that do not fit are cut off
+#	define M_log_ring_size      256 // entries, a power of two
+#	define M_log_rotate_size    (8 * 1024 * 1024)
+#	define M_log_line_size      1024
+
+/*
+  a record is the format string of the log site, which is a literal and so stays where it is and serves as the id of the site, the time and the
+  arguments as they were passed. only the strings are copied, as they may be gone by the time the writer gets to them. turning it into text is
+  left to the writer thread.
+*/
+typedef struct sl_log_record {
+	char const* format;
+	u64 timestamp;
+	u16 size;
+	bool truncated;
+	u8 arguments[M_log_entry_size - 2 * sizeof(u64) - sizeof(u16) - sizeof(bool)];
+} sl_log_record;
+
+// single producer, single consumer: only its own thread moves the head of a ring and only the writer moves the tail
+typedef struct sl_log_ring {
+	sl_log_record records[M_log_ring_size];
+	_Atomic size_t head;
+	_Atomic size_t tail;
+	_Atomic u64 dropped;
+
+	struct sl_log_ring* next;
+} sl_log_ring;
+
+static _Atomic(sl_log_ring*) rings;
+static _Thread_local sl_log_ring* ring;
+static _Thread_local bool writing; // a signal handler logging in the middle of a write drops its message
+
+static atomic_bool running;
+static pthread_t writer;
+
+/*
+  a futex word, 1 while the writer is parked on it. pthread condition variables can not be signalled from the signal handlers that log, a futex
+  wake is a plain system call and can.
+*/
+static _Atomic u32 writer_parked;
+
+// taken by the writer to rotate the file and by the errors, which are written right away
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE* output;
+static size_t output_size;
+
+static void open_output () {
+	output = fopen("./out.log", "w");
+	if (!output) exit(-1);
+	output_size = 0;
+}
+
+enum { length_none, length_char, length_short, length_long, length_long_long, length_max, length_size, length_difference, length_long_double };
+
+// the conversion that starts right after a '%', the stars are the width and precision that are passed as arguments
+typedef struct sl_conversion {
+	char const* end; // one past the conversion character
+	u8 length;
+	u8 stars;
+	bool star_precision; // the last star is the precision, after the '.', and not the width
+	int precision;       // the one written out in the format, -1 when there is none
+	char character;
+} sl_conversion;
+
+static sl_conversion parse_conversion (char const* format) {
+	sl_conversion conversion = {.precision = -1};
+
+	while (*format && strchr("-+ #0'", *format))
+		++format;
 
-FILE* output_file () {
-	static FILE* output;
-	if (!output) {
-		output = fopen("./out.log", "w");
-		if (!output) exit(-1);
+	for (u8 part = 0; part < 2; ++part) {
+		if (part == 1) {
+			if (*format != '.') break;
+			++format;
+		}
+
+		if (*format == '*') {
+			++conversion.stars;
+			conversion.star_precision = part == 1;
+			++format;
+		} else {
+			int value = 0;
+			while (*format >= '0' && *format <= '9')
+				value = value * 10 + (*format++ - '0');
+
+			if (part == 1) conversion.precision = value;
+		}
+	}
+
+	switch (*format) {
+	case 'h':
+		conversion.length = format[1] == 'h' ? length_char : length_short;
+		format += format[1] == 'h' ? 2 : 1;
+		break;
+	case 'l':
+		conversion.length = format[1] == 'l' ? length_long_long : length_long;
+		format += format[1] == 'l' ? 2 : 1;
+		break;
+	case 'j': conversion.length = length_max, ++format; break;
+	case 'z': conversion.length = length_size, ++format; break;
+	case 't': conversion.length = length_difference, ++format; break;
+	case 'L': conversion.length = length_long_double, ++format; break;
 	}
-	return output;
+
+	conversion.character = *format;
+	conversion.end = *format ? format + 1 : format;
+	return conversion;
+}
+
+static bool is_integer (char character) { return character && strchr("diouxXc", character); }
+static bool is_floating (char character) { return character && strchr("fFeEgGaA", character); }
+
+static bool put (sl_log_record* restrict record, void const* restrict data, size_t size) {
+	if (record->truncated || record->size + size > sizeof(record->arguments)) return record->truncated = true, false;
+
+	memcpy(record->arguments + record->size, data, size);
+	record->size += size;
+	return true;
+}
+
+static u64 take_integer (u8 length, va_list* arguments) {
+	switch (length) {
+	case length_long: return va_arg(*arguments, long);
+	case length_long_long: return va_arg(*arguments, long long);
+	case length_max: return va_arg(*arguments, intmax_t);
+	case length_size: return va_arg(*arguments, size_t);
+	case length_difference: return va_arg(*arguments, ptrdiff_t);
+	default: return va_arg(*arguments, int);
+	}
+}
+
+static void encode (sl_log_record* restrict record, char const* restrict format, va_list* arguments) {
+	for (char const* at = strchr(format, '%'); at; at = strchr(at, '%')) {
+		if (at[1] == '%') {
+			at += 2;
+			continue;
+		}
+
+		sl_conversion const conversion = parse_conversion(at + 1);
+		at = conversion.end;
+
+		int stars[2] = {-1, -1};
+		for (u8 i = 0; i < conversion.stars; ++i) {
+			stars[i] = va_arg(*arguments, int);
+			put(record, &stars[i], sizeof(int));
+		}
+
+		if (is_integer(conversion.character)) {
+			u64 const value = take_integer(conversion.length, arguments);
+			put(record, &value, sizeof(value));
+		} else if (is_floating(conversion.character)) {
+			if (conversion.length == length_long_double) {
+				long double const value = va_arg(*arguments, long double);
+				put(record, &value, sizeof(value));
+			} else {
+				double const value = va_arg(*arguments, double);
+				put(record, &value, sizeof(value));
+			}
+		} else if (conversion.character == 'p') {
+			void* const value = va_arg(*arguments, void*);
+			put(record, &value, sizeof(value));
+		} else if (conversion.character == 's') {
+			// a precision bounds how much is read, the string does not have to be terminated then
+			char const* const value = va_arg(*arguments, char const*);
+			int const precision = conversion.star_precision ? stars[conversion.stars - 1] : conversion.precision;
+			size_t size = value ? (precision >= 0 ? strnlen(value, precision) : strlen(value)) : 0;
+
+			if (record->truncated || record->size + sizeof(u16) >= sizeof(record->arguments)) {
+				record->truncated = true;
+				continue;
+			}
+
+			size_t const room = sizeof(record->arguments) - record->size - sizeof(u16);
+			if (size > room) size = room, record->truncated = true;
+
+			u16 const stored = size;
+			put(record, &stored, sizeof(stored));
+			memcpy(record->arguments + record->size, value, size);
+			record->size += size;
+		} else {
+			return; // a conversion that is not known, the arguments after it could not be found
+		}
+	}
+}
+
+static void wake_writer () {
+	// pairs with the fence in park_writer, either the writer sees the record or we see it parked
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (atomic_load_explicit(&writer_parked, memory_order_relaxed) && atomic_exchange_explicit(&writer_parked, 0, memory_order_relaxed))
+		syscall(SYS_futex, &writer_parked, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+void sl_log_set_level (int level) {
+	clamp_level(level);
+	wake_writer(); // it writes the change down
+}
+
+void sl_log_register_thread () {
+	if (ring) return;
+
+	ring = calloc(1, sizeof(sl_log_ring));
+	if (!ring) return;
+
+	// rings are never taken off the list, the ones of threads that are gone are left empty
+	ring->next = atomic_load_explicit(&rings, memory_order_relaxed);
+	while (!atomic_compare_exchange_weak_explicit(&rings, &ring->next, ring, memory_order_release, memory_order_relaxed)) {}
+}
+
+void sl_log_write (char const* restrict format, ...) {
+	if (writing) return;
+	writing = true;
+
+	sl_log_register_thread();
+
+	if (ring) {
+		size_t const head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+		if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == M_log_ring_size) {
+			atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+		} else {
+			sl_log_record* const record = &ring->records[head & (M_log_ring_size - 1)];
+			struct timespec timespec;
+			clock_gettime(CLOCK_MONOTONIC, &timespec);
+
+			record->format = format;
+			record->timestamp = (u64)timespec.tv_sec * 1000000000 + timespec.tv_nsec;
+			record->size = 0;
+			record->truncated = false;
+
+			va_list arguments;
+			va_start(arguments, format);
+			encode(record, format, &arguments);
+			va_end(arguments);
+
+			atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+		}
+
+		wake_writer();
+	}
+
+	writing = false;
 }
 
+// one conversion of the record at a time, with the part of the format that describes it
+#	define print_conversion(M_value) \
+		(conversion.stars == 0 ? snprintf(line + size, room, specification, M_value) : \
+		 conversion.stars == 1 ? snprintf(line + size, room, specification, stars[0], M_value) : \
+		                         snprintf(line + size, room, specification, stars[0], stars[1], M_value))
+
+#	define take(M_type) \
+		({ \
+			M_type M_value = 0; \
+			if (offset + sizeof(M_type) <= record->size) memcpy(&M_value, record->arguments + offset, sizeof(M_type)); \
+			else missing = true; \
+			offset += sizeof(M_type); \
+			M_value; \
+		})
+
+static size_t decode (sl_log_record const* restrict record, char* restrict line) {
+	size_t size = snprintf(line, M_log_line_size, "[%5lu.%06lu] ", record->timestamp / 1000000000, record->timestamp % 1000000000 / 1000);
+	size_t offset = 0;
+	bool missing = false;
+
+	for (char const* at = record->format; *at && size < M_log_line_size - 1;) {
+		char const* const next = strchr(at, '%');
+		size_t const literal = next ? (size_t)(next - at) : strlen(at);
+		size_t const copied = literal < M_log_line_size - 1 - size ? literal : M_log_line_size - 1 - size;
+
+		memcpy(line + size, at, copied);
+		size += copied;
+		if (!next) break;
+
+		if (next[1] == '%') {
+			line[size++] = '%';
+			at = next + 2;
+			continue;
+		}
+
+		sl_conversion const conversion = parse_conversion(next + 1);
+		at = conversion.end;
+
+		char specification[32];
+		size_t const specification_size = conversion.end - next < (ptrdiff_t)sizeof(specification) ? (size_t)(conversion.end - next) : 0;
+		if (!specification_size || !conversion.character) break;
+
+		memcpy(specification, next, specification_size);
+		specification[specification_size] = '\0';
+
+		int stars[2] = {};
+		for (u8 i = 0; i < conversion.stars; ++i)
+			stars[i] = take(int);
+
+		size_t const room = M_log_line_size - size;
+		int printed = 0;
+
+		if (is_integer(conversion.character)) {
+			u64 const value = take(u64);
+
+			switch (conversion.length) {
+			case length_long: printed = print_conversion((long)value); break;
+			case length_long_long: printed = print_conversion((long long)value); break;
+			case length_max: printed = print_conversion((intmax_t)value); break;
+			case length_size: printed = print_conversion((size_t)value); break;
+			case length_difference: printed = print_conversion((ptrdiff_t)value); break;
+			default: printed = print_conversion((int)value); break;
+			}
+		} else if (is_floating(conversion.character)) {
+			if (conversion.length == length_long_double) printed = print_conversion(take(long double));
+			else printed = print_conversion(take(double));
+		} else if (conversion.character == 'p') {
+			printed = print_conversion(take(void*));
+		} else if (conversion.character == 's') {
+			u16 const stored = take(u16);
+			char string[sizeof(record->arguments) + 1];
+			size_t const available = offset <= record->size ? record->size - offset : 0;
+			size_t const string_size = stored < available ? stored : available;
+
+			memcpy(string, record->arguments + (offset <= record->size ? offset : record->size), string_size);
+			string[string_size] = '\0';
+			offset += stored;
+
+			printed = print_conversion(string);
+		}
+
+		if (missing) break;
+		if (printed > 0) size += (size_t)printed < room ? (size_t)printed : room - 1;
+	}
+
+	if (record->truncated || missing) size += snprintf(line + size, M_log_line_size - size, " [truncated]\n");
+
+	return size < M_log_line_size ? size : M_log_line_size - 1;
+}
+
+static void rotate () {
+	pthread_mutex_lock(&output_lock);
+
+	fclose(output);
+	rename("./out.log", "./out.log.1");
+	open_output();
+
+	pthread_mutex_unlock(&output_lock);
+}
+
+static void write_line (char const* restrict line, size_t size) {
+	fwrite(line, 1, size, output);
+	output_size += size;
+}
+
+static bool drain () {
+	static u8 level = log_level_info;
+	bool drained = false;
+
+	if (sl_log_level != level) {
+		level = sl_log_level;
+		fprintf(output, "[log] level %u\n", level);
+		drained = true;
+	}
+
+	for (sl_log_ring* this = atomic_load_explicit(&rings, memory_order_acquire); this; this = this->next) {
+		size_t const head = atomic_load_explicit(&this->head, memory_order_acquire);
+		size_t tail = atomic_load_explicit(&this->tail, memory_order_relaxed);
+
+		for (; tail != head; ++tail) {
+			char line[M_log_line_size];
+			write_line(line, decode(&this->records[tail & (M_log_ring_size - 1)], line));
+			atomic_store_explicit(&this->tail, tail + 1, memory_order_release);
+			drained = true;
+		}
+
+		u64 const dropped = atomic_exchange_explicit(&this->dropped, 0, memory_order_relaxed);
+		if (dropped) {
+			char line[M_log_line_size];
+			write_line(line, snprintf(line, sizeof(line), "[warning] %lu messages dropped, the log could not keep up\n", dropped));
+			drained = true;
+		}
+	}
+
+	if (drained) fflush(output);
+	if (output_size >= M_log_rotate_size) rotate();
+
+	return drained;
+}
+
+static void park_writer () {
+	atomic_store_explicit(&writer_parked, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	// a record published before the fence is drained here, one published after it finds the writer parked and wakes it
+	if (drain() || !atomic_load_explicit(&running, memory_order_relaxed)) {
+		atomic_store_explicit(&writer_parked, 0, memory_order_relaxed);
+		return;
+	}
+
+	// returns right away when the word was cleared in the meantime
+	syscall(SYS_futex, &writer_parked, FUTEX_WAIT_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static void* write_logs (M_maybe_unused void* argument) {
+	// the signal handlers log, they are left to the threads that have a ring
+	sigset_t signals;
+	sigfillset(&signals);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	while (atomic_load_explicit(&running, memory_order_relaxed))
+		if (!drain()) park_writer();
+
+	drain();
+	return NULL;
+}
+
+void sl_log_fatal (char const* restrict format, ...) {
+	pthread_mutex_lock(&output_lock);
+
+	if (!output) open_output();
+
+	va_list arguments;
+	va_start(arguments, format);
+	vfprintf(output, format, arguments);
+	va_end(arguments);
+	fflush(output);
+
+	pthread_mutex_unlock(&output_lock);
+}
+
+void sl_log_start () {
+	char const* const level = getenv("GLASS_SHARD_LOG_LEVEL");
+
+	if (level) {
+		if (strcmp(level, "error") == 0) sl_log_set_level(log_level_error);
+		else if (strcmp(level, "warning") == 0) sl_log_set_level(log_level_warning);
+		else if (strcmp(level, "info") == 0) sl_log_set_level(log_level_info);
+		else sl_log_set_level(atoi(level));
+	}
+
+	pthread_mutex_lock(&output_lock);
+	if (!output) open_output();
+	pthread_mutex_unlock(&output_lock);
+
+	atomic_store(&running, true);
+	if (pthread_create(&writer, NULL, &write_logs, NULL) != 0) exit(-1);
+}
+
+void sl_log_stop () {
+	atomic_store(&running, false);
+	wake_writer();
+	pthread_join(writer, NULL);
+
+	for (sl_log_ring* this = atomic_exchange(&rings, NULL); this;) {
+		sl_log_ring* const next = this->next;
+		free(this);
+		this = next;
+	}
+
+	ring = NULL;
+	fclose(output);
+	output = NULL;
+}
+
+#else
+
+void sl_log_set_level (int level) { clamp_level(level); }
+
+void sl_log_start () {}
+
+void sl_log_stop () {}
+
+void sl_log_register_thread () {}
+
 #endif
@@ -18,8 +18,30 @@
 
 #pragma once
 
+#include <stdatomic.h>
 #include <stdlib.h>
 
+#include "types.h"
+
+// while it is set the messages of the thread are only counted, errors and assertions are always written
+extern _Thread_local bool sl_log_suspended;
+extern _Thread_local u64 sl_logs_suppressed;
+
+enum { log_level_error, log_level_warning, log_level_info };
+
+// the messages above it are not even queued, set from GLASS_SHARD_LOG_LEVEL at the start and moved by SIGUSR1 (more) and SIGUSR2 (less)
+extern _Atomic u8 sl_log_level;
+extern void sl_log_set_level (int);
+
+/*
+  every display thread queues its messages as binary records in a ring of its own and a thread started by sl_log_start formats them and writes
+  them to the file, which is rotated once it grows too large, so that neither formatting nor a slow disk holds up the event loops. a full ring
+  drops the message rather than waiting.
+*/
+extern void sl_log_start ();
+extern void sl_log_stop ();            // writes out whatever is left
+extern void sl_log_register_thread (); // done on the first message otherwise, which may come from a signal handler
+
 #ifdef D_quiet
 
 #	define perror(M_message)
@@ -63,24 +85,28 @@
 
 #	include <stdio.h>
 
-extern FILE* output_file ();
+extern void sl_log_write (char const* restrict format, ...) __attribute__((format(printf, 1, 2)));
+extern void sl_log_fatal (char const* restrict format, ...) __attribute__((format(printf, 1, 2))); // written right away
+
+#	define log_at(M_level, ...) \
+		(sl_log_level < M_level ? (void)0 : sl_log_suspended ? (void)++sl_logs_suppressed : sl_log_write(__VA_ARGS__))
 
 #	if defined(D_release)
 
-#		define log_message(M_message) fprintf(output_file(), " M_message "\n, __LINE__)
-#		define log(M_message, ...)    fprintf(output_file(), " M_message "\n, __LINE__, __VA_ARGS__)
+#		define log_message(M_message) log_at(log_level_info, M_message "\n")
+#		define log(M_message, ...)    log_at(log_level_info, M_message "\n", __VA_ARGS__)
 
-#		define warn_log(M_message)         fprintf(output_file(), "[warning] " M_message "\n")
-#		define warn_log_va(M_message, ...) fprintf(output_file(), "[warning] " M_message "\n", __VA_ARGS__)
+#		define warn_log(M_message)         log_at(log_level_warning, "[warning] " M_message "\n")
+#		define warn_log_va(M_message, ...) log_at(log_level_warning, "[warning] " M_message "\n", __VA_ARGS__)
 
 #		define error_log(M_message) \
 			{ \
-				fprintf(output_file(), "[error] " M_message "\n"); \
+				sl_log_fatal("[error] " M_message "\n"); \
 				exit(0); \
 			}
 #		define error_log_va(M_message, ...) \
 			{ \
-				fprintf(output_file(), "[error] " M_message "\n", __VA_ARGS__); \
+				sl_log_fatal("[error] " M_message "\n", __VA_ARGS__); \
 				exit(0); \
 			}
 
@@ -92,33 +118,33 @@ extern FILE* output_file ();
 
 #	elif defined(D_debug)
 
-#		define log_message(M_message) fprintf(output_file(), __FILE__ ":%u: " M_message "\n", __LINE__)
-#		define log(M_message, ...)    fprintf(output_file(), __FILE__ ":%u: " M_message "\n", __LINE__, __VA_ARGS__)
+#		define log_message(M_message) log_at(log_level_info, __FILE__ ":%u: " M_message "\n", __LINE__)
+#		define log(M_message, ...)    log_at(log_level_info, __FILE__ ":%u: " M_message "\n", __LINE__, __VA_ARGS__)
 
-#		define warn_log(M_message)         fprintf(output_file(), "[warning] " __FILE__ ":%u: " M_message "\n", __LINE__)
-#		define warn_log_va(M_message, ...) fprintf(output_file(), "[warning] " __FILE__ ":%u: " M_message "\n", __LINE__, __VA_ARGS__)
+#		define warn_log(M_message)         log_at(log_level_warning, "[warning] " __FILE__ ":%u: " M_message "\n", __LINE__)
+#		define warn_log_va(M_message, ...) log_at(log_level_warning, "[warning] " __FILE__ ":%u: " M_message "\n", __LINE__, __VA_ARGS__)
 
 #		define error_log(M_message) \
 			{ \
-				fprintf(output_file(), "[error] " __FILE__ ":%u: " M_message "\n", __LINE__); \
+				sl_log_fatal("[error] " __FILE__ ":%u: " M_message "\n", __LINE__); \
 				exit(-1); \
 			}
 #		define error_log_va(M_message, ...) \
 			{ \
-				fprintf(output_file(), "[error] " __FILE__ ":%u: " M_message "\n", __LINE__, __VA_ARGS__); \
+				sl_log_fatal("[error] " __FILE__ ":%u: " M_message "\n", __LINE__, __VA_ARGS__); \
 				exit(-1); \
 			}
 
 #		define assert(M_condition) \
 			{ \
 				if (!(M_condition)) { \
-					fprintf(output_file(), "[assert] " __FILE__ ":%u: assertion M_condititon reached", __LINE__); \
+					sl_log_fatal("[assert] " __FILE__ ":%u: assertion M_condititon reached", __LINE__); \
 					exit(-1); \
 				} \
 			}
 #		define assert_not_reached() \
 			{ \
-				fprintf(output_file(), "[assert_not_reached] " __FILE__ ":%u", __LINE__); \
+				sl_log_fatal("[assert_not_reached] " __FILE__ ":%u", __LINE__); \
 				exit(-1); \
 			}
 
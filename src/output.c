@@ -0,0 +1,349 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "output.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef D_xrandr
+#	include <X11/extensions/Xrandr.h>
+#endif
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window.h"
+
+// link with -lXrandr when built with D_xrandr
+
+#ifdef D_output_log
+#	define output_log(M_message)         warn_log(M_message)
+#	define output_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define output_log(M_message)
+#	define output_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a > b) ? b : a)
+
+#define M_smallest_nonzero_size 4
+
+typedef struct sl_output_mutable {
+	XID id;
+	sl_window_dimensions geometry;
+	workspace_type workspace;
+} sl_output_mutable;
+
+typedef struct sl_outputs_mutable {
+	sl_output_mutable* data;
+	size_t size;
+	size_t allocated_size;
+
+	bool available;
+	int event_base;
+
+	u64 screen_changes;
+	u64 outputs_changed;
+	u64 windows_adjusted;
+} sl_outputs_mutable;
+
+static bool ensure_capacity (sl_outputs_mutable* restrict this, size_t size) {
+	if (size <= this->allocated_size) return true;
+
+	size_t allocated_size = max(this->allocated_size, M_smallest_nonzero_size);
+	while (allocated_size < size)
+		allocated_size <<= 1;
+
+	sl_output_mutable* const data = realloc(this->data, sizeof(sl_output_mutable) * allocated_size);
+
+	if (!data) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+
+	this->data = data;
+	this->allocated_size = allocated_size;
+	return true;
+}
+
+static bool same_dimensions (sl_window_dimensions a, sl_window_dimensions b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static int compare_outputs (void const* a, void const* b) {
+	sl_window_dimensions const a_geometry = ((sl_output_mutable const*)a)->geometry;
+	sl_window_dimensions const b_geometry = ((sl_output_mutable const*)b)->geometry;
+
+	if (a_geometry.x != b_geometry.x) return (a_geometry.x > b_geometry.x) - (a_geometry.x < b_geometry.x);
+	return (a_geometry.y > b_geometry.y) - (a_geometry.y < b_geometry.y);
+}
+
+// the workspaces are left for the caller to hand out
+static void query (sl_outputs_mutable* restrict this, M_maybe_unused Display* x_display, M_maybe_unused Window root, sl_window_dimensions screen) {
+	this->size = 0;
+
+#ifdef D_xrandr
+	XRRScreenResources* const resources = this->available ? XRRGetScreenResourcesCurrent(x_display, root) : NULL;
+
+	if (resources) {
+		for (int i = 0; i < resources->ncrtc; ++i) {
+			XRRCrtcInfo* const info = XRRGetCrtcInfo(x_display, resources, resources->crtcs[i]);
+			if (!info) continue;
+
+			// a crtc without a mode is turned off, two with the same geometry mirror each other and are one output here
+			if (info->mode != None && info->noutput > 0 && info->width && info->height) {
+				sl_window_dimensions const geometry = {.x = info->x, .y = info->y, .width = info->width, .height = info->height};
+
+				size_t j = 0;
+				for (; j < this->size; ++j)
+					if (same_dimensions(this->data[j].geometry, geometry)) break;
+
+				if (j == this->size && ensure_capacity(this, this->size + 1))
+					this->data[this->size++] = (sl_output_mutable) {.id = info->outputs[0], .geometry = geometry};
+			}
+
+			XRRFreeCrtcInfo(info);
+		}
+
+		XRRFreeScreenResources(resources);
+	}
+#endif
+
+	if (this->size == 0 && ensure_capacity(this, 1)) this->data[this->size++] = (sl_output_mutable) {.id = None, .geometry = screen};
+
+	qsort(this->data, this->size, sizeof(sl_output_mutable), &compare_outputs);
+}
+
+void sl_outputs_create (sl_outputs* restrict outputs, Display* x_display, Window root, sl_window_dimensions screen) {
+	sl_outputs_mutable* const this = (sl_outputs_mutable*)outputs;
+
+	*this = (sl_outputs_mutable) {};
+
+#ifdef D_xrandr
+	int error_base;
+	this->available = XRRQueryExtension(x_display, &this->event_base, &error_base);
+
+	if (this->available) XRRSelectInput(x_display, root, RRScreenChangeNotifyMask);
+	else warn_log("the server has no randr extension, the screen is taken as one output");
+#endif
+
+	query(this, x_display, root, screen);
+
+	for (size_t i = 0; i < this->size; ++i)
+		this->data[i].workspace = i;
+
+	output_log_va("%lu outputs", this->size);
+}
+
+void sl_outputs_delete (sl_outputs* restrict outputs) {
+	sl_outputs_mutable* const this = (sl_outputs_mutable*)outputs;
+
+	if (this->data) free(this->data);
+}
+
+bool sl_outputs_is_screen_change (M_maybe_unused sl_outputs const* restrict this, M_maybe_unused XEvent const* restrict event) {
+#ifdef D_xrandr
+	return this->available && event->type == this->event_base + RRScreenChangeNotify;
+#else
+	return false;
+#endif
+}
+
+// moved along with the output it was on and kept inside it, in case the output shrank
+static sl_window_dimensions follow (sl_window_dimensions dimensions, sl_window_dimensions from, sl_window_dimensions to) {
+	u16 const width = min(dimensions.width, to.width), height = min(dimensions.height, to.height);
+	i32 const x = dimensions.x + to.x - from.x, y = dimensions.y + to.y - from.y;
+
+	return (sl_window_dimensions) {
+	.x = max(to.x, min(x, to.x + to.width - width)), .y = max(to.y, min(y, to.y + to.height - height)), .width = width, .height = height};
+}
+
+static void adjust_windows (sl_display* restrict display, workspace_type workspace, sl_window_dimensions from, sl_window_dimensions to) {
+	sl_outputs_mutable* const this = (sl_outputs_mutable*)&display->outputs;
+	size_t const raised = display->window_stack.workspace_vector.indexes[workspace];
+
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			sl_window* const window = (sl_window*)&display->window_stack.data[i].window;
+
+			if (!display->window_stack.data[i].flagged_for_deletion) {
+				window->saved_dimensions = follow(window->saved_dimensions, from, to);
+
+				if (window->flags & window_state_fullscreen_bit) sl_window_fullscreen_change_response(display, window);
+				else if (window->flags & (window_state_maximized_horz_bit | window_state_maximized_vert_bit)) sl_window_maximized_change_response(display, window);
+				else if (!sl_layout_holds_window(&display->layout, window->x_window))
+					sl_move_and_resize_window(display, window, follow(window->dimensions, from, to));
+
+				++this->windows_adjusted;
+			}
+
+			if (i == raised) break;
+		}
+}
+
+static bool is_shown (sl_outputs_mutable const* restrict this, workspace_type workspace) {
+	for (size_t i = 0; i < this->size; ++i)
+		if (this->data[i].workspace == workspace) return true;
+
+	return false;
+}
+
+void sl_outputs_screen_change (sl_display* restrict display, M_maybe_unused XEvent* restrict event) {
+	sl_outputs_mutable* const this = (sl_outputs_mutable*)&display->outputs;
+
+	++this->screen_changes;
+
+#ifdef D_xrandr
+	XRRUpdateConfiguration(event);
+#endif
+
+	sl_window_dimensions const screen = {
+	.x = 0, .y = 0, .width = XDisplayWidth(display->x_display, display->screen), .height = XDisplayHeight(display->x_display, display->screen)};
+
+	*(sl_window_dimensions*)&display->dimensions = screen;
+
+	size_t const previous_size = this->size;
+	sl_output_mutable previous[previous_size + 1];
+	memcpy(previous, this->data, sizeof(sl_output_mutable) * previous_size);
+
+	query(this, display->x_display, display->root, screen);
+
+	while (display->window_stack.workspace_vector.size < this->size)
+		sl_push_workspace(display);
+
+	// the outputs that are still there keep their workspace, their windows are only touched if their geometry changed
+	bool taken[previous_size + 1];
+	memset(taken, 0, sizeof(taken));
+
+	size_t from[this->size + 1];
+
+	for (size_t i = 0; i < this->size; ++i) {
+		this->data[i].workspace = (workspace_type)-1;
+		from[i] = previous_size;
+
+		for (size_t j = 0; j < previous_size; ++j)
+			if (!taken[j] && previous[j].id == this->data[i].id) {
+				taken[j] = true;
+				this->data[i].workspace = previous[j].workspace;
+				from[i] = j;
+				break;
+			}
+	}
+
+	// an output that was plugged in takes the workspace of one that went away first, so that its windows do not disappear along with it
+	for (size_t i = 0; i < this->size; ++i) {
+		if (this->data[i].workspace != (workspace_type)-1) continue;
+
+		for (size_t j = 0; j < previous_size; ++j)
+			if (!taken[j]) {
+				taken[j] = true;
+				this->data[i].workspace = previous[j].workspace;
+				from[i] = j;
+				break;
+			}
+
+		if (this->data[i].workspace != (workspace_type)-1) continue;
+
+		workspace_type workspace = 0;
+		while (is_shown(this, workspace))
+			++workspace;
+
+		this->data[i].workspace = workspace;
+		sl_map_workspace(display, workspace);
+	}
+
+	for (size_t j = 0; j < previous_size; ++j)
+		if (!taken[j]) sl_unmap_workspace(display, previous[j].workspace);
+
+	if (!is_shown(this, display->window_stack.current_workspace))
+		sl_window_stack_set_current_workspace((sl_window_stack*)&display->window_stack, this->data[0].workspace);
+
+	if (sl_workarea_set_screen((sl_workarea*)&display->workarea, screen)) sl_workarea_change_response(display);
+
+	for (size_t i = 0; i < this->size; ++i) {
+		sl_window_dimensions const geometry = from[i] < previous_size ? previous[from[i]].geometry : this->data[i].geometry;
+
+		if (from[i] < previous_size && previous[from[i]].id == this->data[i].id && same_dimensions(geometry, this->data[i].geometry)) continue;
+
+		++this->outputs_changed;
+		output_log_va("output %lu now shows workspace %u at %d %d %u %u", this->data[i].id, this->data[i].workspace, this->data[i].geometry.x,
+		              this->data[i].geometry.y, this->data[i].geometry.width, this->data[i].geometry.height);
+
+		adjust_windows(display, this->data[i].workspace, geometry, this->data[i].geometry);
+	}
+
+	sl_layout_mark_dirty(display);
+	sl_update_process_priorities(display);
+}
+
+size_t sl_outputs_showing (sl_outputs const* restrict this, workspace_type workspace) {
+	for (size_t i = 0; i < this->size; ++i)
+		if (this->data[i].workspace == workspace) return i;
+
+	return (size_t)-1;
+}
+
+size_t sl_outputs_owner (sl_outputs const* restrict this, workspace_type workspace) { return this->size ? workspace % this->size : 0; }
+
+size_t sl_outputs_focused (sl_display const* restrict display) {
+	size_t const output = sl_outputs_showing(&display->outputs, display->window_stack.current_workspace);
+
+	return output == (size_t)-1 ? 0 : output;
+}
+
+size_t sl_outputs_of_window (sl_display* restrict display, sl_window const* restrict window) {
+	sl_outputs const* const this = &display->outputs;
+	sl_window_stack* const window_stack = (sl_window_stack*)&display->window_stack;
+	size_t const index = sl_window_stack_get_window_index(window_stack, window);
+
+	if (index < display->window_stack.size && sl_window_stack_is_valid_index(display->window_stack.data[index].next))
+		for (workspace_type j = 0; j < display->window_stack.workspace_vector.size; ++j)
+			if (sl_window_stack_is_in_workspace(window_stack, index, j)) {
+				size_t const output = sl_outputs_showing(this, j);
+				if (output != (size_t)-1) return output;
+				break;
+			}
+
+	// a window that is not shown yet goes by its center
+	i32 const x = window->dimensions.x + window->dimensions.width / 2, y = window->dimensions.y + window->dimensions.height / 2;
+
+	for (size_t i = 0; i < this->size; ++i) {
+		sl_window_dimensions const geometry = this->data[i].geometry;
+		if (x >= geometry.x && x < geometry.x + geometry.width && y >= geometry.y && y < geometry.y + geometry.height) return i;
+	}
+
+	return sl_outputs_focused(display);
+}
+
+void sl_outputs_show (sl_outputs* restrict outputs, size_t index, workspace_type workspace) {
+	sl_outputs_mutable* const this = (sl_outputs_mutable*)outputs;
+
+	this->data[index].workspace = workspace;
+}
+
+sl_window_dimensions sl_outputs_area (sl_display const* restrict display, size_t index) {
+	return sl_workarea_area_within(&display->workarea, display->outputs.data[index].geometry);
+}
+
+void sl_outputs_log_statistics (M_maybe_unused sl_outputs const* restrict this) {
+	log("outputs: %lu shown, %lu screen changes, %lu outputs changed, %lu windows adjusted", this->size, this->screen_changes, this->outputs_changed,
+	    this->windows_adjusted);
+}
@@ -0,0 +1,70 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/Xlib.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+#include "workspace-type.h"
+
+typedef struct sl_display sl_display; // foward declaration
+typedef struct sl_window sl_window;   // foward declaration
+
+typedef struct sl_output {
+	XID const id; // the RandR output the crtc drives, None for the whole screen when RandR is not used
+	sl_window_dimensions const geometry;
+	workspace_type const workspace; // the one shown on it
+} sl_output;
+
+/*
+  every output shows a workspace of its own, the workspaces are split into one set per output (the ones equal to the index of the output modulo the
+  number of outputs) and the focused output is the one showing the current workspace of the window stack
+*/
+typedef struct sl_outputs {
+	sl_output const* data; // sorted from left to right, then top to bottom
+	size_t const size;
+	size_t const allocated_size;
+
+	bool const available; // the server has RandR and glass shard was built with it
+	int const event_base;
+
+	u64 const screen_changes;
+	u64 const outputs_changed;
+	u64 const windows_adjusted;
+} sl_outputs;
+
+extern void sl_outputs_create (sl_outputs* restrict, Display*, Window root, sl_window_dimensions screen);
+extern void sl_outputs_delete (sl_outputs* restrict);
+
+extern bool sl_outputs_is_screen_change (sl_outputs const* restrict, XEvent const* restrict);
+extern void sl_outputs_screen_change (sl_display* restrict, XEvent* restrict); // only the windows of the outputs that changed are touched
+
+extern size_t sl_outputs_showing (sl_outputs const* restrict, workspace_type); // (size_t)-1 when the workspace is not shown
+extern size_t sl_outputs_owner (sl_outputs const* restrict, workspace_type);   // the output whose set the workspace is in
+extern size_t sl_outputs_focused (sl_display const* restrict);
+extern size_t sl_outputs_of_window (sl_display* restrict, sl_window const* restrict); // the one showing its workspace, or the one holding its center
+extern void sl_outputs_show (sl_outputs* restrict, size_t index, workspace_type);
+
+extern sl_window_dimensions sl_outputs_area (sl_display const* restrict, size_t index); // the part of the workarea on the output
+
+extern void sl_outputs_log_statistics (sl_outputs const* restrict);
@@ -0,0 +1,281 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "placement.h"
+
+#include <stdlib.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window-stack.h"
+#include "window.h"
+
+#ifdef D_placement_log
+#	define placement_log(M_message)         warn_log(M_message)
+#	define placement_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define placement_log(M_message)
+#	define placement_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a < b) ? a : b)
+
+#define M_smallest_nonzero_size 8
+
+typedef struct sl_placement_event_mutable {
+	i32 y;
+	u32 first;
+	u32 past_end;
+	i32 delta;
+} sl_placement_event_mutable;
+
+typedef struct sl_placement_mutable {
+	sl_placement_event_mutable* events;
+	i32* coordinates;
+	i32* tree;
+	i32* tree_delta;
+	size_t allocated_size;
+
+	u64 placements;
+	u64 user_positioned;
+	u64 overlap_free;
+} sl_placement_mutable;
+
+void sl_placement_create (sl_placement* restrict this) { *(sl_placement_mutable*)this = (sl_placement_mutable) {}; }
+
+void sl_placement_delete (sl_placement* restrict placement) {
+	sl_placement_mutable* const this = (sl_placement_mutable*)placement;
+
+	if (this->events) free(this->events);
+	if (this->coordinates) free(this->coordinates);
+	if (this->tree) free(this->tree);
+	if (this->tree_delta) free(this->tree_delta);
+}
+
+static bool ensure_capacity (sl_placement_mutable* restrict this, size_t size) {
+	if (size <= this->allocated_size) return true;
+
+	size_t allocated_size = max(this->allocated_size, M_smallest_nonzero_size);
+	while (allocated_size < size)
+		allocated_size <<= 1;
+
+	sl_placement_event_mutable* const events = realloc(this->events, sizeof(sl_placement_event_mutable) * allocated_size);
+	if (events) this->events = events;
+	i32* const coordinates = realloc(this->coordinates, sizeof(i32) * allocated_size);
+	if (coordinates) this->coordinates = coordinates;
+	i32* const tree = realloc(this->tree, sizeof(i32) * allocated_size * 4);
+	if (tree) this->tree = tree;
+	i32* const tree_delta = realloc(this->tree_delta, sizeof(i32) * allocated_size * 4);
+	if (tree_delta) this->tree_delta = tree_delta;
+
+	if (!(events && coordinates && tree && tree_delta)) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+
+	this->allocated_size = allocated_size;
+	return true;
+}
+
+static int compare_coordinates (void const* a, void const* b) {
+	i32 const left = *(i32 const*)a;
+	i32 const right = *(i32 const*)b;
+	return (left > right) - (left < right);
+}
+
+static int compare_events (void const* a, void const* b) {
+	i32 const left = ((sl_placement_event_mutable const*)a)->y;
+	i32 const right = ((sl_placement_event_mutable const*)b)->y;
+	return (left > right) - (left < right);
+}
+
+static u32 slot_of (i32 const* coordinates, size_t size, i32 x) {
+	size_t low = 0, high = size;
+
+	while (low < high) {
+		size_t const middle = low + (high - low) / 2;
+		if (coordinates[middle] < x) low = middle + 1;
+		else high = middle;
+	}
+
+	return low;
+}
+
+static void tree_add (sl_placement_mutable* restrict this, size_t node, u32 low, u32 high, u32 first, u32 past_end, i32 delta) {
+	if (past_end <= low || high <= first) return;
+
+	if (first <= low && high <= past_end) {
+		this->tree[node] += delta;
+		this->tree_delta[node] += delta;
+		return;
+	}
+
+	u32 const middle = low + (high - low) / 2;
+	tree_add(this, node * 2, low, middle, first, past_end, delta);
+	tree_add(this, node * 2 + 1, middle, high, first, past_end, delta);
+	this->tree[node] = min(this->tree[node * 2], this->tree[node * 2 + 1]) + this->tree_delta[node];
+}
+
+// the leftmost slot holding the fewest windows, what is added to a whole node does not change which of its children is smaller
+static u32 tree_leftmost_minimum (sl_placement_mutable const* restrict this, u32 slots) {
+	size_t node = 1;
+	u32 low = 0, high = slots;
+
+	while (high - low > 1) {
+		u32 const middle = low + (high - low) / 2;
+
+		if (this->tree[node * 2] <= this->tree[node * 2 + 1]) {
+			node = node * 2;
+			high = middle;
+		} else {
+			node = node * 2 + 1;
+			low = middle;
+		}
+	}
+
+	return low;
+}
+
+static bool is_an_obstacle (sl_window const* restrict window) {
+	return !(window->flags & (window_type_desktop_bit | window_type_dock_bit | window_state_hidden_bit));
+}
+
+/*
+  a window at x and y overlaps another when x is within (other.x - width, other.x + other.width) and y within the same on the other axis, so every window
+  on the workspace forbids a rectangle of positions; sweeping those rectangles from the top with a segment tree over x finds the position covered by
+  the fewest of them in O(n log n)
+*/
+void sl_place_window (sl_display* restrict display, size_t index, workspace_type workspace) {
+	sl_placement_mutable* const this = (sl_placement_mutable*)&display->placement;
+	sl_window* const window = (sl_window*)&display->window_stack.data[index].window;
+
+	if (window->flags & window_user_position_bit) {
+		++this->user_positioned;
+		return;
+	}
+
+	if (window->flags & (window_all_types & ~(window_type_normal_bit | window_type_dialog_bit | window_type_utility_bit | window_type_toolbar_bit)))
+		return;
+
+	if (sl_window_stack_is_valid_index(display->window_stack.data[index].leader)) return; // kept where its leader put it
+
+	// on the output the workspace is shown on, or the one whose set it is in
+	size_t const output = sl_outputs_showing(&display->outputs, workspace);
+	sl_window_dimensions const area = sl_outputs_area(display, output == (size_t)-1 ? sl_outputs_owner(&display->outputs, workspace) : output);
+	i32 const width = window->dimensions.width, height = window->dimensions.height;
+	i32 const x_first = area.x, x_last = max(area.x, area.x + area.width - width);
+	i32 const y_first = area.y, y_last = max(area.y, area.y + area.height - height);
+
+	size_t const raised = display->window_stack.workspace_vector.indexes[workspace];
+
+	size_t windows_size = 0;
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			++windows_size;
+			if (i == raised) break;
+		}
+
+	if (!ensure_capacity(this, windows_size * 2 + 2)) return;
+
+	size_t coordinates_size = 0;
+	this->coordinates[coordinates_size++] = x_first;
+	this->coordinates[coordinates_size++] = x_last + 1;
+
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			sl_window const* const other = &display->window_stack.data[i].window;
+
+			if (i != index && is_an_obstacle(other)) {
+				i32 const first = max(x_first, other->dimensions.x - width + 1), last = min(x_last, other->dimensions.x + other->dimensions.width - 1);
+
+				if (first <= last) {
+					this->coordinates[coordinates_size++] = first;
+					this->coordinates[coordinates_size++] = last + 1;
+				}
+			}
+
+			if (i == raised) break;
+		}
+
+	qsort(this->coordinates, coordinates_size, sizeof(i32), &compare_coordinates);
+
+	size_t unique_size = 1;
+	for (size_t i = 1; i < coordinates_size; ++i)
+		if (this->coordinates[i] != this->coordinates[unique_size - 1]) this->coordinates[unique_size++] = this->coordinates[i];
+
+	u32 const slots = unique_size - 1;
+
+	size_t events_size = 0;
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			sl_window const* const other = &display->window_stack.data[i].window;
+
+			if (i != index && is_an_obstacle(other)) {
+				i32 const first = max(x_first, other->dimensions.x - width + 1), last = min(x_last, other->dimensions.x + other->dimensions.width - 1);
+				i32 const top = max(y_first, other->dimensions.y - height + 1), bottom = min(y_last, other->dimensions.y + other->dimensions.height - 1);
+
+				if (first <= last && top <= bottom) {
+					u32 const first_slot = slot_of(this->coordinates, unique_size, first);
+					u32 const past_end_slot = slot_of(this->coordinates, unique_size, last + 1);
+
+					this->events[events_size++] = (sl_placement_event_mutable) {.y = top, .first = first_slot, .past_end = past_end_slot, .delta = 1};
+					if (bottom < y_last)
+						this->events[events_size++] = (sl_placement_event_mutable) {.y = bottom + 1, .first = first_slot, .past_end = past_end_slot, .delta = -1};
+				}
+			}
+
+			if (i == raised) break;
+		}
+
+	qsort(this->events, events_size, sizeof(sl_placement_event_mutable), &compare_events);
+
+	for (size_t i = 0; i < (size_t)slots * 4; ++i)
+		this->tree[i] = this->tree_delta[i] = 0;
+
+	i32 best = -1, best_x = x_first, best_y = y_first;
+
+	// the fewest windows overlapped holds from one row with events to the next, only those rows have to be looked at
+	size_t i = 0;
+	for (i32 y = y_first;; y = this->events[i].y) {
+		for (; i < events_size && this->events[i].y == y; ++i)
+			tree_add(this, 1, 0, slots, this->events[i].first, this->events[i].past_end, this->events[i].delta);
+
+		if (best == -1 || this->tree[1] < best) {
+			best = this->tree[1];
+			best_x = this->coordinates[tree_leftmost_minimum(this, slots)];
+			best_y = y;
+		}
+
+		if (best == 0 || i == events_size) break;
+	}
+
+	++this->placements;
+	if (best == 0) ++this->overlap_free;
+
+	placement_log_va("[%lu] placed at %i, %i over %i windows, %lu events", window->x_window, best_x, best_y, best, events_size);
+
+	sl_move_window(display, window, best_x, best_y);
+	window->saved_dimensions = window->dimensions;
+}
+
+void sl_placement_log_statistics (M_maybe_unused sl_placement const* restrict this) {
+	log("placement: %lu windows placed, %lu without overlap, %lu left where the user put them", this->placements, this->overlap_free, this->user_positioned);
+}
@@ -0,0 +1,59 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+#include "workspace-type.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+typedef struct sl_placement_event {
+	i32 const y;
+	u32 const first;    // of the slots between the x coordinates
+	u32 const past_end; // the slot after the last one
+	i32 const delta;
+} sl_placement_event;
+
+/*
+  the buffers of the sweep that places a new window, kept between placements
+  the position chosen is the one overlapping the fewest windows, the topmost and then leftmost of them
+*/
+typedef struct sl_placement {
+	sl_placement_event const* events;
+	i32 const* coordinates;      // the x coordinates bounding the slots, sorted
+	i32 const* tree;             // a segment tree over the slots, the fewest windows overlapped below each node
+	i32 const* tree_delta;       // added to the whole of a node
+	size_t const allocated_size; // of events and coordinates, tree and tree_delta are four times as large
+
+	u64 const placements;
+	u64 const user_positioned;
+	u64 const overlap_free;
+} sl_placement;
+
+extern void sl_placement_create (sl_placement* restrict);
+extern void sl_placement_delete (sl_placement* restrict);
+
+// moves a window that is about to be mapped for the first time, nothing happens when its position was given by the user
+extern void sl_place_window (sl_display* restrict, size_t index, workspace_type workspace);
+
+extern void sl_placement_log_statistics (sl_placement const* restrict);
@@ -0,0 +1,288 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#define _GNU_SOURCE // prlimit
+
+#include "process-priority.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "message.h"
+#include "timer.h"
+
+#ifdef D_process_priority_log
+#	define process_priority_log(M_message)         warn_log(M_message)
+#	define process_priority_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define process_priority_log(M_message)
+#	define process_priority_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a > b) ? b : a)
+
+#define M_smallest_nonzero_size 4
+
+/*
+  raising the priority of the focused process needs RLIMIT_NICE (or CAP_SYS_NICE) and lowering its oom_score_adj needs CAP_SYS_RESOURCE, when
+  we are not allowed to we simply leave the original value in place. the background penalties can always be applied, but taking them back lowers
+  the value again and needs the same privilege, so a penalty is only applied when we know it can be undone. oom_score_adj is the exception: an
+  unprivileged write may go back down to the lowest value the process ever had, which is its original one.
+
+  writes to /proc/<pid>/autogroup are rate limited to one every 100ms for everyone without CAP_SYS_ADMIN, a pass that changes two processes would
+  already have its second write refused, so without it autogroups are left alone.
+*/
+#define M_focused_nice_delta              -5
+#define M_focused_autogroup_nice_delta    -5
+#define M_focused_oom_score_adj_delta     -100
+#define M_background_nice_delta           5
+#define M_background_autogroup_nice_delta 5
+#define M_background_oom_score_adj_delta  200
+
+#define M_cap_sys_admin 21
+#define M_cap_sys_nice  23
+
+typedef struct sl_process_priority_mutable {
+	struct sl_process_priority_entry* entries;
+	size_t size;
+	size_t allocated_size;
+
+	u64 last_update;
+	bool may_lower_nice;
+	bool may_set_autogroup;
+} sl_process_priority_mutable;
+
+static bool read_proc_int (pid_t pid, char const* file, char const* format, int* value) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%i/%s", pid, file);
+
+	FILE* stream = fopen(path, "r");
+	if (!stream) return false;
+
+	bool const success = fscanf(stream, format, value) == 1;
+
+	fclose(stream);
+	return success;
+}
+
+static bool write_proc_int (pid_t pid, char const* file, int value) {
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%i/%s", pid, file);
+
+	FILE* stream = fopen(path, "w");
+	if (!stream) return false;
+
+	bool success = fprintf(stream, "%i", value) > 0;
+	if (fclose(stream) != 0) success = false;
+
+	return success;
+}
+
+static u64 effective_capabilities () {
+	FILE* stream = fopen("/proc/self/status", "r");
+	if (!stream) return 0;
+
+	char line[128];
+	u64 capabilities = 0;
+
+	while (fgets(line, sizeof(line), stream))
+		if (sscanf(line, "CapEff: %lx", &capabilities) == 1) break;
+
+	fclose(stream);
+	return capabilities;
+}
+
+// whether the nice value of pid may be lowered back to nice, see can_nice in the kernel
+static bool may_lower_nice_to (sl_process_priority const* restrict this, pid_t pid, int nice) {
+	if (this->may_lower_nice) return true;
+
+	struct rlimit limit;
+	if (prlimit(pid, RLIMIT_NICE, NULL, &limit) != 0) return false;
+
+	return limit.rlim_cur == RLIM_INFINITY || 20 - nice <= (int)limit.rlim_cur;
+}
+
+static bool set_nice (pid_t pid, int nice) {
+	/*
+	  on linux the nice value is a per thread attribute and setpriority(PRIO_PROCESS, pid) only changes the thread whose tid is pid, so walk every
+	  thread of the process
+	*/
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%i/task", pid);
+
+	DIR* directory = opendir(path);
+	if (!directory) return setpriority(PRIO_PROCESS, pid, nice) == 0;
+
+	bool success = true;
+	for (struct dirent* entry; (entry = readdir(directory));) {
+		if (entry->d_name[0] == '.') continue;
+		if (setpriority(PRIO_PROCESS, atoi(entry->d_name), nice) != 0) success = false;
+	}
+
+	closedir(directory);
+	return success;
+}
+
+static void apply_values (sl_process_priority_entry const* restrict entry, int nice_delta, int autogroup_nice_delta, int oom_score_adj_delta) {
+	// if the preferred value is refused fall back to the original one
+
+	if (nice_delta > 0 && !entry->nice_restorable) nice_delta = 0;
+
+	if (!set_nice(entry->pid, min(19, max(-20, entry->nice + nice_delta)))) {
+		process_priority_log_va("[%i] could not set nice value: %s", entry->pid, strerror(errno));
+		set_nice(entry->pid, entry->nice);
+	}
+
+	if (entry->has_autogroup && !write_proc_int(entry->pid, "autogroup", min(19, max(-20, entry->autogroup_nice + autogroup_nice_delta)))) {
+		process_priority_log_va("[%i] could not set autogroup nice value", entry->pid);
+		write_proc_int(entry->pid, "autogroup", entry->autogroup_nice);
+	}
+
+	if (entry->has_oom_score_adj && !write_proc_int(entry->pid, "oom_score_adj", min(1000, max(-1000, entry->oom_score_adj + oom_score_adj_delta)))) {
+		process_priority_log_va("[%i] could not set oom_score_adj", entry->pid);
+		write_proc_int(entry->pid, "oom_score_adj", entry->oom_score_adj);
+	}
+}
+
+static void apply_class (sl_process_priority_entry const* restrict entry) {
+	process_priority_log_va(
+	"[%i] priority class %s", entry->pid,
+	entry->class == process_priority_focused    ? "focused" :
+	entry->class == process_priority_background ? "background" :
+	                                              "neutral"
+	);
+
+	switch (entry->class) {
+	case process_priority_focused:
+		return apply_values(entry, M_focused_nice_delta, M_focused_autogroup_nice_delta, M_focused_oom_score_adj_delta);
+	case process_priority_background:
+		return apply_values(entry, M_background_nice_delta, M_background_autogroup_nice_delta, M_background_oom_score_adj_delta);
+	default: return apply_values(entry, 0, 0, 0);
+	}
+}
+
+static bool capture_original_values (sl_process_priority const* restrict this, sl_process_priority_entry* restrict entry) {
+	errno = 0;
+	entry->nice = getpriority(PRIO_PROCESS, entry->pid);
+	if (errno != 0) return false; // the process is gone
+
+	entry->nice_restorable = may_lower_nice_to(this, entry->pid, entry->nice);
+
+	// the autogroup is checked against our own limits, and only for negative values
+	entry->has_autogroup = this->may_set_autogroup && read_proc_int(entry->pid, "autogroup", "%*s nice %i", &entry->autogroup_nice) &&
+	                       (entry->autogroup_nice >= 0 || may_lower_nice_to(this, getpid(), entry->autogroup_nice));
+	entry->has_oom_score_adj = read_proc_int(entry->pid, "oom_score_adj", "%i", &entry->oom_score_adj);
+
+	return true;
+}
+
+static void remove_entry (sl_process_priority* restrict this, size_t index) {
+	((sl_process_priority_mutable*)this)->entries[index] = this->entries[this->size - 1];
+	--((sl_process_priority_mutable*)this)->size;
+}
+
+void sl_process_priority_create (sl_process_priority* restrict this) {
+	u64 const capabilities = effective_capabilities();
+
+	*(sl_process_priority_mutable*)this = (sl_process_priority_mutable) {
+	.may_lower_nice = capabilities & (1ul << M_cap_sys_nice), .may_set_autogroup = capabilities & (1ul << M_cap_sys_admin)};
+}
+
+void sl_process_priority_delete (sl_process_priority* restrict this) {
+	for (size_t i = 0; i < this->size; ++i) {
+		if (this->entries[i].class == process_priority_neutral) continue;
+
+		((sl_process_priority_mutable*)this)->entries[i].class = process_priority_neutral;
+		apply_class(&this->entries[i]);
+	}
+
+	if (this->entries) free(((sl_process_priority_mutable*)this)->entries);
+
+	*(sl_process_priority_mutable*)this = (sl_process_priority_mutable) {};
+}
+
+void sl_process_priority_begin (sl_process_priority* restrict this) {
+	for (size_t i = 0; i < this->size; ++i)
+		((sl_process_priority_mutable*)this)->entries[i].visited = false;
+}
+
+void sl_process_priority_set (sl_process_priority* restrict this, pid_t pid, u8 class) {
+	if (pid <= 0 || pid == getpid()) return;
+
+	for (size_t i = 0; i < this->size; ++i) {
+		if (this->entries[i].pid != pid) continue;
+
+		sl_process_priority_entry* const entry = &((sl_process_priority_mutable*)this)->entries[i];
+
+		if (!entry->visited || class > entry->next_class) entry->next_class = class;
+		entry->visited = true;
+		return;
+	}
+
+	if (class == process_priority_neutral) return;
+
+	if (this->size == this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		sl_process_priority_entry* entries = realloc(((sl_process_priority_mutable*)this)->entries, sizeof(sl_process_priority_entry) * allocated_size);
+
+		if (!entries) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return;
+		}
+
+		((sl_process_priority_mutable*)this)->entries = entries;
+		((sl_process_priority_mutable*)this)->allocated_size = allocated_size;
+	}
+
+	sl_process_priority_entry* const entry = &((sl_process_priority_mutable*)this)->entries[this->size];
+	*entry = (sl_process_priority_entry) {.pid = pid, .class = process_priority_neutral, .next_class = class, .visited = true};
+
+	if (!capture_original_values(this, entry)) return;
+
+	++((sl_process_priority_mutable*)this)->size;
+}
+
+void sl_process_priority_end (sl_process_priority* restrict this) {
+	for (size_t i = 0; i < this->size;) {
+		sl_process_priority_entry* const entry = &((sl_process_priority_mutable*)this)->entries[i];
+
+		if (!entry->visited) entry->next_class = process_priority_neutral;
+
+		if (entry->next_class != entry->class) {
+			entry->class = entry->next_class;
+			apply_class(entry);
+		}
+
+		// neutral processes run with their original values, there is nothing left to remember about them
+		if (entry->class == process_priority_neutral) {
+			remove_entry(this, i);
+			continue;
+		}
+
+		++i;
+	}
+
+	((sl_process_priority_mutable*)this)->last_update = sl_monotonic_time();
+}
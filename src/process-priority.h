@@ -0,0 +1,67 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <sys/types.h>
+
+#include "types.h"
+
+// ordered by precedence, a process owning windows of several classes takes the highest one
+enum {
+	process_priority_background,
+	process_priority_neutral,
+	process_priority_focused
+};
+
+typedef struct sl_process_priority_entry {
+	pid_t pid;
+	u8 class;
+	u8 next_class;
+	bool visited;
+
+	// the values the process had before we first touched it
+	int nice;
+	int autogroup_nice;
+	int oom_score_adj;
+	bool has_autogroup;
+	bool has_oom_score_adj;
+	bool nice_restorable;
+} sl_process_priority_entry;
+
+typedef struct sl_process_priority {
+	struct sl_process_priority_entry const* entries;
+	size_t const size;
+	size_t const allocated_size;
+
+	u64 const last_update;
+	bool const may_lower_nice;    // CAP_SYS_NICE
+	bool const may_set_autogroup; // CAP_SYS_ADMIN
+} sl_process_priority;
+
+/*
+  an update is a begin, a set for every process owning a window and an end. the classes are only applied at the end so that a process which
+  owns windows of different classes does not bounce between them during the pass. processes not set during the pass get their original values back.
+*/
+
+void sl_process_priority_create (sl_process_priority* restrict);
+void sl_process_priority_delete (sl_process_priority* restrict);
+void sl_process_priority_begin (sl_process_priority* restrict);
+void sl_process_priority_set (sl_process_priority* restrict, pid_t, u8 class);
+void sl_process_priority_end (sl_process_priority* restrict);
@@ -0,0 +1,432 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "property.h"
+
+#include <string.h>
+
+#include <X11/Xatom.h>
+
+#ifdef D_xcb
+#	include <X11/Xlib-xcb.h>
+#	include <xcb/xcb.h>
+#	include <xcb/xcbext.h>
+#endif
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "request-queue.h"
+#include "window-stack.h"
+
+#ifdef D_property_log
+#	define property_log(M_message)         warn_log(M_message)
+#	define property_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define property_log(M_message)
+#	define property_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a > b) ? b : a)
+
+#define M_smallest_nonzero_size 4
+
+// in 32 bit units, every property we read fits in a single request of this length
+#define M_property_length 16384
+
+/*
+  in 32 bit units, text is read with a first request this long which is enough for most titles, whatever is left up to the limit is read with a
+  second one. converting to UTF-8 can make the text grow, the caller cuts it again afterwards.
+*/
+#define M_text_chunk_length 64
+#define M_text_length       ((D_title_size_limit + 3) / 4)
+
+struct sl_pending_properties {
+	Window x_window;
+#ifdef D_xcb
+	xcb_get_property_cookie_t cookies[prefetch_properties_size];
+#endif
+};
+
+typedef struct sl_property_statistics_mutable {
+	u64 maps;
+	u64 round_trips;
+} sl_property_statistics_mutable;
+
+typedef struct sl_property_prefetch_mutable {
+	struct sl_pending_properties* entries;
+	size_t size;
+	size_t allocated_size;
+
+	sl_property_statistics_mutable statistics;
+	u32 map_round_trips;
+} sl_property_prefetch_mutable;
+
+static Atom prefetch_atom (sl_display* restrict display, u8 index) {
+	switch (index) {
+	case prefetch_wm_name: return XA_WM_NAME;
+	case prefetch_wm_icon_name: return XA_WM_ICON_NAME;
+	case prefetch_wm_normal_hints: return XA_WM_NORMAL_HINTS;
+	case prefetch_wm_hints: return XA_WM_HINTS;
+	case prefetch_wm_protocols: return display->atoms[wm_protocols];
+	case prefetch_net_wm_pid: return display->atoms[net_wm_pid];
+	case prefetch_wm_class: return XA_WM_CLASS;
+	case prefetch_wm_transient_for: return XA_WM_TRANSIENT_FOR;
+	case prefetch_wm_client_machine: return XA_WM_CLIENT_MACHINE;
+	default: assert_not_reached();
+	}
+}
+
+static Atom prefetch_type (u8 index) {
+	switch (index) {
+	case prefetch_wm_normal_hints: return XA_WM_SIZE_HINTS;
+	case prefetch_wm_hints: return XA_WM_HINTS;
+	case prefetch_wm_protocols: return XA_ATOM;
+	case prefetch_net_wm_pid: return XA_CARDINAL;
+	case prefetch_wm_class: return XA_STRING;
+	case prefetch_wm_transient_for: return XA_WINDOW;
+	default: return AnyPropertyType; // text properties come in several encodings
+	}
+}
+
+static size_t item_size (u8 format) {
+	switch (format) {
+	case 8: return sizeof(char);
+	case 16: return sizeof(short);
+	case 32: return sizeof(long);
+	default: return 0;
+	}
+}
+
+void sl_property_clear (sl_property* restrict this) {
+	if (this->data) free(this->data);
+
+	*this = (sl_property) {};
+}
+
+sl_property sl_property_get (sl_display* restrict display, Window x_window, Atom property, Atom type) {
+	return sl_property_get_range(display, x_window, property, type, 0, M_property_length);
+}
+
+sl_property sl_property_get_range (sl_display* restrict display, Window x_window, Atom property, Atom type, long offset, long length) {
+	Atom actual_type;
+	int actual_format;
+	ulong items_size;
+	ulong bytes_after;
+	uchar* prop = NULL;
+
+	if (XGetWindowProperty(display->x_display, x_window, property, offset, length, false, type, &actual_type, &actual_format, &items_size, &bytes_after, &prop) != Success) {
+		property_log("XGetWindowProperty does not return Success");
+		return (sl_property) {};
+	}
+
+	// a missing property or a type mismatch, in both cases there is no data
+	if (actual_type == None || (type != AnyPropertyType && actual_type != type) || item_size(actual_format) == 0) {
+		if (prop) XFree(prop);
+		return (sl_property) {};
+	}
+
+	sl_property this = (sl_property) {.type = actual_type, .format = actual_format, .items_size = items_size};
+
+	size_t const size = items_size * item_size(actual_format);
+
+	if ((this.data = malloc(size + 1))) {
+		memcpy(this.data, prop, size);
+		((char*)this.data)[size] = '\0';
+	} else {
+		this = (sl_property) {};
+	}
+
+	XFree(prop);
+	return this;
+}
+
+sl_property sl_property_get_text (sl_display* restrict display, Window x_window, Atom property, Atom type) {
+	sl_property this = (sl_property) {};
+	long offset = 0;
+	long length = min(M_text_chunk_length, M_text_length);
+
+	while (offset < M_text_length) {
+		Atom actual_type;
+		int actual_format;
+		ulong items_size;
+		ulong bytes_after;
+		uchar* prop = NULL;
+
+		if (XGetWindowProperty(display->x_display, x_window, property, offset, length, false, type, &actual_type, &actual_format, &items_size, &bytes_after, &prop) != Success) {
+			property_log("XGetWindowProperty does not return Success");
+			break;
+		}
+
+		// the property could have been replaced by something else between two chunks, keep what was read before
+		if (actual_type == None || actual_format != 8 || (type != AnyPropertyType && actual_type != type) || (offset != 0 && actual_type != this.type)) {
+			if (prop) XFree(prop);
+			break;
+		}
+
+		char* const data = realloc(this.data, this.items_size + items_size + 1);
+		if (!data) {
+			XFree(prop);
+			break;
+		}
+
+		memcpy(data + this.items_size, prop, items_size);
+		data[this.items_size + items_size] = '\0';
+
+		this = (sl_property) {.type = actual_type, .format = 8, .data = data, .items_size = this.items_size + items_size};
+
+		XFree(prop);
+
+		if (bytes_after == 0) break;
+
+		offset += length;
+		length = M_text_length - offset;
+	}
+
+	return this;
+}
+
+static sl_window* find_window (sl_display* restrict display, Window x_window) {
+	for (size_t i = 0; i < display->window_stack.size; ++i) {
+		if (display->window_stack.data[i].flagged_for_deletion) continue;
+		if (display->window_stack.data[i].window.x_window == x_window) return (sl_window*)&display->window_stack.data[i].window;
+	}
+
+	return NULL;
+}
+
+#ifdef D_xcb
+
+static sl_property property_from_reply (xcb_get_property_reply_t* reply, Atom type) {
+	if (!reply || reply->type == XCB_ATOM_NONE || (type != AnyPropertyType && reply->type != type) || item_size(reply->format) == 0) return (sl_property) {};
+
+	sl_property this = (sl_property) {.type = reply->type, .format = reply->format, .items_size = xcb_get_property_value_length(reply) / (reply->format / 8)};
+
+	if (!(this.data = malloc(this.items_size * item_size(this.format) + 1))) return (sl_property) {};
+
+	void const* const value = xcb_get_property_value(reply);
+
+	// xcb hands out the wire format, widen it to what Xlib would have returned
+	switch (this.format) {
+	case 8: memcpy(this.data, value, this.items_size); break;
+	case 16:
+		for (size_t i = 0; i < this.items_size; ++i)
+			((short*)this.data)[i] = ((i16 const*)value)[i];
+		break;
+	case 32:
+		for (size_t i = 0; i < this.items_size; ++i)
+			((long*)this.data)[i] = ((u32 const*)value)[i];
+		break;
+	}
+
+	((char*)this.data)[this.items_size * item_size(this.format)] = '\0';
+
+	return this;
+}
+
+static xcb_get_property_cookie_t request_property (sl_display* restrict display, Window x_window, u8 index) {
+	// text is bounded the same way sl_property_get_text bounds it, in a single request since nothing waits on it yet
+	u32 const length = index == prefetch_wm_name || index == prefetch_wm_icon_name ? M_text_length : M_property_length;
+
+	return xcb_get_property(XGetXCBConnection(display->x_display), false, x_window, prefetch_atom(display, index), prefetch_type(index), 0, length);
+}
+
+static void resume_property (sl_display* restrict display, sl_request const* restrict request, void* reply) {
+	sl_property property = property_from_reply(reply, request->type);
+	sl_window* const window = find_window(display, request->x_window);
+
+	if (window) request->continuation.property(window, display, &property);
+
+	sl_property_clear(&property);
+}
+
+static struct sl_pending_properties* find_pending (sl_property_prefetch* restrict this, Window x_window) {
+	for (size_t i = 0; i < this->size; ++i)
+		if (this->entries[i].x_window == x_window) return &((sl_property_prefetch_mutable*)this)->entries[i];
+
+	return NULL;
+}
+
+static void remove_pending (sl_display* restrict display, struct sl_pending_properties* pending, bool discard) {
+	sl_property_prefetch_mutable* const this = (sl_property_prefetch_mutable*)&display->property_prefetch;
+
+	if (discard)
+		for (u8 i = 0; i < prefetch_properties_size; ++i)
+			xcb_discard_reply(XGetXCBConnection(display->x_display), pending->cookies[i].sequence);
+
+	*pending = this->entries[--this->size];
+}
+
+#endif
+
+void sl_property_request (sl_display* restrict display, Window x_window, Atom property, Atom type, bool text, sl_property_continuation continuation) {
+#ifdef D_xcb
+	// text is bounded by a single request here, sl_property_get_text would need a round trip to know whether to ask for more
+	xcb_get_property_cookie_t const cookie =
+	xcb_get_property(XGetXCBConnection(display->x_display), false, x_window, property, type, 0, text ? M_text_length : M_property_length);
+
+	sl_request_queue_push(
+	display, &(sl_request) {.sequence = cookie.sequence, .resume = &resume_property, .x_window = x_window, .atom = property, .type = type, .continuation.property = continuation}
+	);
+#else
+	sl_property this = text ? sl_property_get_text(display, x_window, property, type) : sl_property_get(display, x_window, property, type);
+	sl_window* const window = find_window(display, x_window);
+
+	if (window) continuation(window, display, &this);
+
+	sl_property_clear(&this);
+#endif
+}
+
+void sl_property_prefetch_create (sl_property_prefetch* restrict this) { *(sl_property_prefetch_mutable*)this = (sl_property_prefetch_mutable) {}; }
+
+void sl_property_prefetch_delete (sl_property_prefetch* restrict this, M_maybe_unused sl_display* restrict display) {
+#ifdef D_xcb
+	while (this->size) remove_pending(display, &((sl_property_prefetch_mutable*)this)->entries[0], true);
+#endif
+
+	if (this->entries) free(((sl_property_prefetch_mutable*)this)->entries);
+
+	*(sl_property_prefetch_mutable*)this = (sl_property_prefetch_mutable) {};
+}
+
+void sl_property_prefetch_start (M_maybe_unused sl_display* restrict display, M_maybe_unused Window x_window) {
+#ifdef D_xcb
+	/*
+	  the requests are sent now and their replies are picked up at the first MapRequest. the window has PropertyChangeMask selected before these
+	  requests go out so any later change reaches us as a PropertyNotify and the stale reply is asked for again.
+	*/
+	sl_property_prefetch* const prefetch = (sl_property_prefetch*)&display->property_prefetch;
+	sl_property_prefetch_mutable* const this = (sl_property_prefetch_mutable*)prefetch;
+
+	if (find_pending(prefetch, x_window)) return;
+
+	if (this->size == this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		struct sl_pending_properties* entries = realloc(this->entries, sizeof(struct sl_pending_properties) * allocated_size);
+
+		if (!entries) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return;
+		}
+
+		this->entries = entries;
+		this->allocated_size = allocated_size;
+	}
+
+	struct sl_pending_properties* const pending = &this->entries[this->size++];
+
+	pending->x_window = x_window;
+	for (u8 i = 0; i < prefetch_properties_size; ++i)
+		pending->cookies[i] = request_property(display, x_window, i);
+
+	xcb_flush(XGetXCBConnection(display->x_display));
+#endif
+}
+
+void sl_property_prefetch_invalidate (M_maybe_unused sl_display* restrict display, M_maybe_unused Window x_window, M_maybe_unused Atom atom) {
+#ifdef D_xcb
+	struct sl_pending_properties* const pending = find_pending((sl_property_prefetch*)&display->property_prefetch, x_window);
+	if (!pending) return;
+
+	for (u8 i = 0; i < prefetch_properties_size; ++i) {
+		if (prefetch_atom(display, i) != atom) continue;
+
+		property_log_va("[%lu] prefetched property changed, asking again", x_window);
+		xcb_discard_reply(XGetXCBConnection(display->x_display), pending->cookies[i].sequence);
+		pending->cookies[i] = request_property(display, x_window, i);
+	}
+#endif
+}
+
+void sl_property_prefetch_cancel (M_maybe_unused sl_display* restrict display, M_maybe_unused Window x_window) {
+#ifdef D_xcb
+	struct sl_pending_properties* const pending = find_pending((sl_property_prefetch*)&display->property_prefetch, x_window);
+	if (pending) remove_pending(display, pending, true);
+#endif
+}
+
+void sl_property_prefetch_finish (sl_display* restrict display, Window x_window, sl_property properties[prefetch_properties_size]) {
+#ifdef D_xcb
+	xcb_connection_t* const connection = XGetXCBConnection(display->x_display);
+	struct sl_pending_properties* pending = find_pending((sl_property_prefetch*)&display->property_prefetch, x_window);
+
+	if (!pending) {
+		// created before we started (or the allocation failed), send everything now and still wait only once
+		sl_property_prefetch_start(display, x_window);
+		pending = find_pending((sl_property_prefetch*)&display->property_prefetch, x_window);
+	}
+
+	if (pending) {
+		bool waited = false;
+
+		for (u8 i = 0; i < prefetch_properties_size; ++i) {
+			xcb_get_property_reply_t* reply = NULL;
+			xcb_generic_error_t* error = NULL;
+
+			if (!xcb_poll_for_reply(connection, pending->cookies[i].sequence, (void**)&reply, &error)) {
+				// the first blocking reply brings all the others with it
+				reply = xcb_get_property_reply(connection, pending->cookies[i], &error);
+				waited = true;
+			}
+
+			properties[i] = property_from_reply(reply, prefetch_type(i));
+
+			if (reply) free(reply);
+			if (error) free(error);
+		}
+
+		if (waited) sl_property_note_round_trip(display);
+
+		remove_pending(display, pending, false);
+		return;
+	}
+#endif
+
+	for (u8 i = 0; i < prefetch_properties_size; ++i) {
+		if (i == prefetch_wm_name || i == prefetch_wm_icon_name) properties[i] = sl_property_get_text(display, x_window, prefetch_atom(display, i), prefetch_type(i));
+		else properties[i] = sl_property_get(display, x_window, prefetch_atom(display, i), prefetch_type(i));
+		sl_property_note_round_trip(display);
+	}
+}
+
+void sl_property_note_round_trip (sl_display* restrict display) {
+	sl_property_prefetch* const prefetch = (sl_property_prefetch*)&display->property_prefetch;
+
+	++((sl_property_prefetch_mutable*)prefetch)->map_round_trips;
+}
+
+void sl_property_note_map (sl_display* restrict display, M_maybe_unused Window x_window) {
+	sl_property_prefetch* const prefetch = (sl_property_prefetch*)&display->property_prefetch;
+	sl_property_prefetch_mutable* const this = (sl_property_prefetch_mutable*)prefetch;
+
+	++this->statistics.maps;
+	this->statistics.round_trips += this->map_round_trips;
+
+	property_log_va("[%lu] first map took %u round trips", x_window, this->map_round_trips);
+
+	this->map_round_trips = 0;
+}
+
+void sl_property_log_statistics (sl_display* restrict display) {
+	M_maybe_unused sl_property_statistics const* const statistics = &display->property_prefetch.statistics;
+
+	log("mapped %lu windows with %lu round trips", statistics->maps, statistics->round_trips);
+}
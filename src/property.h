@@ -0,0 +1,92 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <X11/Xlib.h>
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+typedef struct sl_window sl_window;   // foward declaration
+
+// titles are cut to this many bytes of UTF-8, override it with -DD_title_size_limit=... in predefined.mk
+#ifndef D_title_size_limit
+#	define D_title_size_limit 1024
+#endif
+
+/*
+  the raw contents of a window property as the server sent them, before any decoding. format 32 items are stored as long the way Xlib returns
+  them and format 8 data is always followed by a null byte.
+*/
+typedef struct sl_property {
+	Atom type;
+	u8 format; // 0 when the property does not exist
+	ulong items_size;
+	void* data;
+} sl_property;
+
+// called with the window the property was asked for, not called when the window went away in the meantime
+typedef void (*sl_property_continuation)(sl_window* restrict, sl_display* restrict, sl_property const* restrict);
+
+// the properties read when a window is mapped for the first time
+enum {
+	prefetch_wm_name,
+	prefetch_wm_icon_name,
+	prefetch_wm_normal_hints,
+	prefetch_wm_hints,
+	prefetch_wm_protocols,
+	prefetch_net_wm_pid,
+	prefetch_wm_class,
+	prefetch_wm_transient_for,
+	prefetch_wm_client_machine,
+	prefetch_properties_size
+};
+
+typedef struct sl_property_statistics {
+	u64 const maps;
+	u64 const round_trips;
+} sl_property_statistics;
+
+typedef struct sl_property_prefetch {
+	struct sl_pending_properties const* entries; // one per created top-level window not yet mapped
+	size_t const size;
+	size_t const allocated_size;
+
+	sl_property_statistics const statistics;
+	u32 const map_round_trips; // round trips of the map being handled
+} sl_property_prefetch;
+
+extern void sl_property_clear (sl_property* restrict);
+extern sl_property sl_property_get (sl_display* restrict, Window, Atom property, Atom type);
+extern sl_property sl_property_get_range (sl_display* restrict, Window, Atom property, Atom type, long offset, long length); // both in 32 bit units
+extern sl_property sl_property_get_text (sl_display* restrict, Window, Atom property, Atom type);
+extern void sl_property_request (sl_display* restrict, Window, Atom property, Atom type, bool text, sl_property_continuation);
+
+extern void sl_property_prefetch_create (sl_property_prefetch* restrict);
+extern void sl_property_prefetch_delete (sl_property_prefetch* restrict, sl_display* restrict);
+
+extern void sl_property_prefetch_start (sl_display* restrict, Window);
+extern void sl_property_prefetch_invalidate (sl_display* restrict, Window, Atom);
+extern void sl_property_prefetch_cancel (sl_display* restrict, Window);
+extern void sl_property_prefetch_finish (sl_display* restrict, Window, sl_property properties[prefetch_properties_size]);
+
+extern void sl_property_note_round_trip (sl_display* restrict);
+extern void sl_property_note_map (sl_display* restrict, Window);
+extern void sl_property_log_statistics (sl_display* restrict);
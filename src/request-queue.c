@@ -0,0 +1,141 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "request-queue.h"
+
+#include <string.h>
+
+#ifdef D_xcb
+#	include <X11/Xlib-xcb.h>
+#	include <xcb/xcb.h>
+#	include <xcb/xcbext.h>
+#endif
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+
+#ifdef D_request_queue_log
+#	define request_queue_log(M_message)         warn_log(M_message)
+#	define request_queue_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define request_queue_log(M_message)
+#	define request_queue_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 16
+
+typedef struct sl_request_queue_mutable {
+	sl_request* data;
+	size_t begin;
+	size_t size;
+	size_t allocated_size;
+
+	u64 sent;
+	u64 resumed;
+} sl_request_queue_mutable;
+
+void sl_request_queue_create (sl_request_queue* restrict this) { *(sl_request_queue_mutable*)this = (sl_request_queue_mutable) {}; }
+
+void sl_request_queue_delete (sl_request_queue* restrict this, M_maybe_unused sl_display* restrict display) {
+#ifdef D_xcb
+	for (size_t i = 0; i < this->size; ++i)
+		xcb_discard_reply(XGetXCBConnection(display->x_display), this->data[(this->begin + i) % this->allocated_size].sequence);
+#endif
+
+	if (this->data) free(((sl_request_queue_mutable*)this)->data);
+
+	*(sl_request_queue_mutable*)this = (sl_request_queue_mutable) {};
+}
+
+void sl_request_queue_push (sl_display* restrict display, sl_request const* restrict request) {
+	sl_request_queue* const queue = (sl_request_queue*)&display->request_queue;
+	sl_request_queue_mutable* const this = (sl_request_queue_mutable*)queue;
+
+	if (this->size == this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		sl_request* data = malloc(sizeof(sl_request) * allocated_size);
+
+		if (!data) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return;
+		}
+
+		// unwrap the ring so the new one starts at 0
+		for (size_t i = 0; i < this->size; ++i)
+			data[i] = this->data[(this->begin + i) % this->allocated_size];
+
+		if (this->data) free(this->data);
+
+		this->data = data;
+		this->begin = 0;
+		this->allocated_size = allocated_size;
+	}
+
+	this->data[(this->begin + this->size) % this->allocated_size] = *request;
+	++this->size;
+	++this->sent;
+}
+
+bool sl_request_queue_elapse (M_maybe_unused sl_display* restrict display) {
+#ifdef D_xcb
+	sl_request_queue* const queue = (sl_request_queue*)&display->request_queue;
+	sl_request_queue_mutable* const this = (sl_request_queue_mutable*)queue;
+	xcb_connection_t* const connection = XGetXCBConnection(display->x_display);
+	bool resumed = false;
+
+	/*
+	  the server answers in the order the requests were sent, so once the oldest one has no reply yet neither does anything after it. the replies
+	  were already read off the socket by XPending, xcb_poll_for_reply never reads or waits.
+	*/
+	while (this->size) {
+		sl_request const request = this->data[this->begin];
+		void* reply = NULL;
+		xcb_generic_error_t* error = NULL;
+
+		if (!xcb_poll_for_reply(connection, request.sequence, &reply, &error)) break;
+
+		// popped before resuming, the continuation is free to send more requests
+		this->begin = (this->begin + 1) % this->allocated_size;
+		--this->size;
+		++this->resumed;
+
+		if (error) {
+			request_queue_log_va("[%lu] request %u failed with error %u", request.x_window, request.sequence, error->error_code);
+		}
+
+		request.resume(display, &request, reply);
+
+		if (reply) free(reply);
+		if (error) free(error);
+
+		resumed = true;
+	}
+
+	return resumed;
+#else
+	return false;
+#endif
+}
+
+void sl_request_queue_log_statistics (M_maybe_unused sl_request_queue const* restrict this) {
+	log("requests: %lu sent, %lu resumed, %lu in flight", this->sent, this->resumed, this->size);
+}
@@ -0,0 +1,67 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/X.h>
+
+#include "property.h"
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+typedef struct sl_request sl_request; // foward declaration
+
+// reply is the xcb reply of the request, NULL when the server answered with an error
+typedef void (*sl_request_resume)(sl_display* restrict, sl_request const* restrict, void* reply);
+
+/*
+  a request that was sent and whose reply is picked up from the event loop. resume turns the raw reply into what continuation expects, the
+  continuation is where the handler that sent the request goes on.
+*/
+struct sl_request {
+	u32 sequence;
+	sl_request_resume resume;
+
+	Window x_window;
+	Atom atom;
+	Atom type;
+
+	union {
+		sl_property_continuation property;
+	} continuation;
+};
+
+typedef struct sl_request_queue {
+	sl_request const* data; // ring buffer in the order the requests were sent
+	size_t const begin;
+	size_t const size;
+	size_t const allocated_size;
+
+	u64 const sent;
+	u64 const resumed;
+} sl_request_queue;
+
+extern void sl_request_queue_create (sl_request_queue* restrict);
+extern void sl_request_queue_delete (sl_request_queue* restrict, sl_display* restrict);
+
+extern void sl_request_queue_push (sl_display* restrict, sl_request const* restrict);
+extern bool sl_request_queue_elapse (sl_display* restrict);
+extern void sl_request_queue_log_statistics (sl_request_queue const* restrict);
@@ -0,0 +1,234 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "rules.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compiler-differences.h"
+#include "message.h"
+#include "string-table.h"
+
+#ifdef D_rules_log
+#	define rules_log(M_message)         warn_log(M_message)
+#	define rules_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define rules_log(M_message)
+#	define rules_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 16
+
+typedef struct sl_rule_mutable {
+	u32 instance;
+	u32 class;
+	u8 actions; // 0 for an empty slot
+	workspace_type workspace;
+} sl_rule_mutable;
+
+typedef struct sl_rules_mutable {
+	sl_rule_mutable* table;
+	size_t size;
+	size_t allocated_size;
+
+	u64 lookups;
+	u64 matches;
+} sl_rules_mutable;
+
+void sl_rules_create (sl_rules* restrict this) { *(sl_rules_mutable*)this = (sl_rules_mutable) {}; }
+
+void sl_rules_delete (sl_rules* restrict this) {
+	if (this->table) free(((sl_rules_mutable*)this)->table);
+}
+
+static size_t slot_of (u32 instance, u32 class, size_t allocated_size) {
+	u64 const key = (u64)instance << 32 | class;
+
+	return (key * 0x9e3779b97f4a7c15) >> 32 & (allocated_size - 1);
+}
+
+static sl_rule_mutable* find_slot (sl_rule_mutable* restrict table, size_t allocated_size, u32 instance, u32 class) {
+	size_t slot = slot_of(instance, class, allocated_size);
+
+	while (table[slot].actions && (table[slot].instance != instance || table[slot].class != class))
+		slot = (slot + 1) & (allocated_size - 1);
+
+	return &table[slot];
+}
+
+static u32 intern_pattern (char const* restrict pattern) { return strcmp(pattern, "*") == 0 ? 0 : sl_intern(pattern, strlen(pattern)); }
+
+// false when the line is not a rule, the rule is left with no actions for empty lines and comments
+static bool parse_rule (char* restrict line, sl_rule_mutable* restrict rule) {
+	char* save;
+	char const* const instance = strtok_r(line, " \t\n", &save);
+
+	*rule = (sl_rule_mutable) {};
+
+	if (!instance || instance[0] == '#') return true;
+
+	char const* const class = strtok_r(NULL, " \t\n", &save);
+	if (!class) return false;
+
+	for (char const* action; (action = strtok_r(NULL, " \t\n", &save));) {
+		if (strcmp(action, "floating") == 0) {
+			rule->actions |= rule_floating;
+		} else if (strcmp(action, "fullscreen") == 0) {
+			rule->actions |= rule_fullscreen;
+		} else if (strcmp(action, "workspace") == 0) {
+			char const* const number = strtok_r(NULL, " \t\n", &save);
+			char* end;
+
+			if (!number) return false;
+
+			ulong const workspace = strtoul(number, &end, 10);
+			if (*end != '\0' || workspace > (workspace_type)-1) return false;
+
+			rule->actions |= rule_workspace;
+			rule->workspace = workspace;
+		} else if (strcmp(action, "background") == 0) {
+			char const* const policy = strtok_r(NULL, " \t\n", &save);
+
+			if (!policy) return false;
+
+			if (strcmp(policy, "keep") == 0) rule->actions |= rule_keep_priority;
+			else if (strcmp(policy, "lower") == 0) rule->actions &= ~rule_keep_priority;
+			else return false;
+		} else {
+			return false;
+		}
+	}
+
+	rule->instance = intern_pattern(instance);
+	rule->class = intern_pattern(class);
+	return true;
+}
+
+static bool insert (sl_rules_mutable* restrict this, sl_rule_mutable const* restrict rule) {
+	if ((this->size + 1) * 2 > this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		sl_rule_mutable* const table = calloc(allocated_size, sizeof(sl_rule_mutable));
+
+		if (!table) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return false;
+		}
+
+		for (size_t i = 0; i < this->allocated_size; ++i)
+			if (this->table[i].actions) *find_slot(table, allocated_size, this->table[i].instance, this->table[i].class) = this->table[i];
+
+		if (this->table) free(this->table);
+		this->table = table;
+		this->allocated_size = allocated_size;
+	}
+
+	sl_rule_mutable* const slot = find_slot(this->table, this->allocated_size, rule->instance, rule->class);
+
+	// a later line for the same windows replaces the earlier one
+	if (!slot->actions) ++this->size;
+	*slot = *rule;
+	return true;
+}
+
+void sl_rules_load (sl_rules* restrict rules, char const* restrict path) {
+	sl_rules_mutable* const this = (sl_rules_mutable*)rules;
+
+	if (this->table) free(this->table);
+	*this = (sl_rules_mutable) {.lookups = this->lookups, .matches = this->matches};
+
+	if (!path) return;
+
+	FILE* const stream = fopen(path, "r");
+	if (!stream) {
+		rules_log_va("no rules at %s", path);
+		return;
+	}
+
+	char* line = NULL;
+	size_t line_size = 0;
+
+	for (size_t number = 1; getline(&line, &line_size, stream) != -1; ++number) {
+		sl_rule_mutable rule;
+
+		if (!parse_rule(line, &rule)) {
+			warn_log_va("%s:%lu: not a rule", path, number);
+			continue;
+		}
+
+		if (rule.actions && !insert(this, &rule)) break;
+	}
+
+	free(line);
+	fclose(stream);
+
+	rules_log_va("%lu rules from %s", this->size, path);
+}
+
+char* sl_rules_default_path () {
+	char const* const config_home = getenv("XDG_CONFIG_HOME");
+	char const* const home = getenv("HOME");
+
+	bool const has_config_home = config_home && config_home[0] != '\0';
+	if (!has_config_home && !home) return NULL;
+
+	char const* const format = has_config_home ? "%s/glass-shard/rules" : "%s/.config/glass-shard/rules";
+	char const* const directory = has_config_home ? config_home : home;
+
+	int const size = snprintf(NULL, 0, format, directory);
+	char* const path = malloc(size + 1);
+	if (!path) return NULL;
+
+	snprintf(path, size + 1, format, directory);
+	return path;
+}
+
+sl_rule const* sl_rules_match (sl_rules* restrict rules, u32 instance, u32 class) {
+	sl_rules_mutable* const this = (sl_rules_mutable*)rules;
+
+	++this->lookups;
+
+	if (this->size == 0) return NULL;
+
+	// always the same four probes, however many rules there are
+	u32 const keys[][2] = {
+	{instance, class},
+	{instance, 0    },
+	{0,        class},
+	{0,        0    },
+	};
+
+	for (u8 i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+		sl_rule_mutable const* const rule = find_slot(this->table, this->allocated_size, keys[i][0], keys[i][1]);
+
+		if (rule->actions) {
+			++this->matches;
+			return (sl_rule const*)rule;
+		}
+	}
+
+	return NULL;
+}
+
+void sl_rules_log_statistics (M_maybe_unused sl_rules const* restrict this) {
+	log("rules: %lu rules, %lu lookups, %lu matches", this->size, this->lookups, this->matches);
+}
@@ -0,0 +1,67 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include "types.h"
+#include "workspace-type.h"
+
+enum {
+	rule_workspace = 1 << 0,
+	rule_floating = 1 << 1,
+	rule_fullscreen = 1 << 2,
+	rule_keep_priority = 1 << 3 // not moved to the background process priority when its workspace is not shown
+};
+
+/*
+  one line of the rules file:
+
+    <instance> <class> <action>...
+
+  where instance and class are the two WM_CLASS strings or * for any, and the actions are any of workspace <number>, floating, fullscreen and
+  background keep. lines starting with # are comments.
+*/
+typedef struct sl_rule {
+	u32 const instance; // interned, 0 for any
+	u32 const class;    // interned, 0 for any
+	u8 const actions;
+	workspace_type const workspace;
+} sl_rule;
+
+typedef struct sl_rules {
+	sl_rule const* table; // open addressing on the instance and class ids, compiled when the file is loaded
+	size_t const size;
+	size_t const allocated_size; // a power of two
+
+	u64 const lookups;
+	u64 const matches;
+} sl_rules;
+
+extern void sl_rules_create (sl_rules* restrict);
+extern void sl_rules_delete (sl_rules* restrict);
+
+// replaces the rules with the ones in the file, a missing file means no rules
+extern void sl_rules_load (sl_rules* restrict, char const* restrict path);
+extern char* sl_rules_default_path (); // $XDG_CONFIG_HOME/glass-shard/rules, to be freed
+
+// a rule naming both strings wins over one naming the instance, which wins over one naming the class, which wins over * *. NULL when none match
+extern sl_rule const* sl_rules_match (sl_rules* restrict, u32 instance, u32 class);
+extern void sl_rules_log_statistics (sl_rules const* restrict);
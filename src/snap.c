@@ -0,0 +1,334 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "snap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window-stack.h"
+#include "window.h"
+
+#ifdef D_snap_log
+#	define snap_log(M_message)         warn_log(M_message)
+#	define snap_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define snap_log(M_message)
+#	define snap_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 8
+
+// how close an edge has to come to another before it is pulled onto it
+#define M_snap_distance 16
+
+typedef struct sl_edge_mutable {
+	i32 position;
+	Window x_window;
+} sl_edge_mutable;
+
+typedef struct sl_snap_window_mutable {
+	Window x_window;
+	sl_window_dimensions dimensions;
+} sl_snap_window_mutable;
+
+typedef struct sl_snap_mutable {
+	sl_edge_mutable* edges[edges_size];
+	size_t size;
+	sl_snap_window_mutable* windows;
+	size_t windows_size;
+	size_t allocated_size;
+
+	u32 generation;
+	sl_window_dimensions workarea;
+	bool built;
+
+	u64 queries;
+	u64 snaps;
+	u64 updates;
+	u64 rebuilds;
+} sl_snap_mutable;
+
+void sl_snap_create (sl_snap* restrict this) { *(sl_snap_mutable*)this = (sl_snap_mutable) {}; }
+
+void sl_snap_delete (sl_snap* restrict snap) {
+	sl_snap_mutable* const this = (sl_snap_mutable*)snap;
+
+	for (u8 edge = 0; edge < edges_size; ++edge)
+		if (this->edges[edge]) free(this->edges[edge]);
+
+	if (this->windows) free(this->windows);
+}
+
+static bool ensure_capacity (sl_snap_mutable* restrict this, size_t size) {
+	if (size <= this->allocated_size) return true;
+
+	size_t allocated_size = max(this->allocated_size, M_smallest_nonzero_size);
+	while (allocated_size < size)
+		allocated_size <<= 1;
+
+	for (u8 edge = 0; edge < edges_size; ++edge) {
+		sl_edge_mutable* edges = realloc(this->edges[edge], sizeof(sl_edge_mutable) * allocated_size);
+
+		if (!edges) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return false;
+		}
+
+		this->edges[edge] = edges;
+	}
+
+	sl_snap_window_mutable* windows = realloc(this->windows, sizeof(sl_snap_window_mutable) * allocated_size);
+
+	if (!windows) {
+		warn_log_va("size of %lu is invalid", allocated_size);
+		return false;
+	}
+
+	this->windows = windows;
+	this->allocated_size = allocated_size;
+	return true;
+}
+
+static void edge_positions (sl_window_dimensions dimensions, i32 positions[edges_size]) {
+	positions[edge_left] = dimensions.x;
+	positions[edge_right] = dimensions.x + dimensions.width;
+	positions[edge_top] = dimensions.y;
+	positions[edge_bottom] = dimensions.y + dimensions.height;
+}
+
+// the first edge not before position
+static size_t lower_bound (sl_edge_mutable const* edges, size_t size, i32 position) {
+	size_t low = 0, high = size;
+
+	while (low < high) {
+		size_t const middle = low + (high - low) / 2;
+
+		if (edges[middle].position < position) low = middle + 1;
+		else high = middle;
+	}
+
+	return low;
+}
+
+static void insert_edges (sl_snap_mutable* restrict this, Window x_window, sl_window_dimensions dimensions) {
+	i32 positions[edges_size];
+	edge_positions(dimensions, positions);
+
+	for (u8 edge = 0; edge < edges_size; ++edge) {
+		size_t const i = lower_bound(this->edges[edge], this->size, positions[edge]);
+
+		memmove(this->edges[edge] + i + 1, this->edges[edge] + i, sizeof(sl_edge_mutable) * (this->size - i));
+		this->edges[edge][i] = (sl_edge_mutable) {.position = positions[edge], .x_window = x_window};
+	}
+
+	++this->size;
+}
+
+static void remove_edges (sl_snap_mutable* restrict this, Window x_window, sl_window_dimensions dimensions) {
+	i32 positions[edges_size];
+	edge_positions(dimensions, positions);
+
+	for (u8 edge = 0; edge < edges_size; ++edge) {
+		size_t i = lower_bound(this->edges[edge], this->size, positions[edge]);
+
+		while (i < this->size && this->edges[edge][i].x_window != x_window)
+			++i;
+
+		if (i == this->size) continue;
+
+		memmove(this->edges[edge] + i, this->edges[edge] + i + 1, sizeof(sl_edge_mutable) * (this->size - i - 1));
+	}
+
+	--this->size;
+}
+
+static int compare_edges (void const* a, void const* b) {
+	i32 const left = ((sl_edge_mutable const*)a)->position;
+	i32 const right = ((sl_edge_mutable const*)b)->position;
+
+	return (left > right) - (left < right);
+}
+
+static int compare_windows (void const* a, void const* b) {
+	Window const left = ((sl_snap_window_mutable const*)a)->x_window;
+	Window const right = ((sl_snap_window_mutable const*)b)->x_window;
+
+	return (left > right) - (left < right);
+}
+
+// windows_size when the window is not in the index
+static size_t find_window (sl_snap_mutable const* restrict this, Window x_window) {
+	size_t low = 0, high = this->windows_size;
+
+	while (low < high) {
+		size_t const middle = low + (high - low) / 2;
+
+		if (this->windows[middle].x_window < x_window) low = middle + 1;
+		else high = middle;
+	}
+
+	return low < this->windows_size && this->windows[low].x_window == x_window ? low : this->windows_size;
+}
+
+static void rebuild (sl_display* restrict display) {
+	sl_snap_mutable* const this = (sl_snap_mutable*)&display->snap;
+
+	this->size = 0;
+	this->windows_size = 0;
+	this->built = false;
+
+	size_t const raised = sl_window_stack_get_raised_window_index((sl_window_stack*)&display->window_stack);
+
+	size_t windows_size = 0;
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			++windows_size;
+			if (i == raised) break;
+		}
+
+	if (!ensure_capacity(this, windows_size + 2)) return;
+
+	// appended unsorted and sorted once, the screen and the workarea count as windows without one
+	sl_window_dimensions const areas[] = {display->dimensions, display->workarea.area};
+	for (size_t i = 0; i < sizeof(areas) / sizeof(areas[0]); ++i, ++this->size) {
+		i32 positions[edges_size];
+		edge_positions(areas[i], positions);
+
+		for (u8 edge = 0; edge < edges_size; ++edge)
+			this->edges[edge][this->size] = (sl_edge_mutable) {.position = positions[edge], .x_window = None};
+	}
+
+	if (sl_window_stack_is_valid_index(raised))
+		for (size_t i = display->window_stack.data[raised].next;; i = display->window_stack.data[i].next) {
+			sl_window const* const window = &display->window_stack.data[i].window;
+
+			i32 positions[edges_size];
+			edge_positions(window->dimensions, positions);
+
+			for (u8 edge = 0; edge < edges_size; ++edge)
+				this->edges[edge][this->size] = (sl_edge_mutable) {.position = positions[edge], .x_window = window->x_window};
+			++this->size;
+
+			this->windows[this->windows_size++] = (sl_snap_window_mutable) {.x_window = window->x_window, .dimensions = window->dimensions};
+
+			if (i == raised) break;
+		}
+
+	for (u8 edge = 0; edge < edges_size; ++edge)
+		qsort(this->edges[edge], this->size, sizeof(sl_edge_mutable), &compare_edges);
+	qsort(this->windows, this->windows_size, sizeof(sl_snap_window_mutable), &compare_windows);
+
+	this->generation = display->window_stack.generation;
+	this->workarea = display->workarea.area;
+	this->built = true;
+	++this->rebuilds;
+
+	snap_log_va("snap index rebuilt with %lu windows", this->windows_size);
+}
+
+static bool same_dimensions (sl_window_dimensions a, sl_window_dimensions b) {
+	return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static void ensure_built (sl_display* restrict display) {
+	// the windows shown or the workarea changed since the index was built, the moves in between were followed one by one
+	if (display->snap.built && display->snap.generation == display->window_stack.generation && same_dimensions(display->snap.workarea, display->workarea.area))
+		return;
+
+	rebuild(display);
+}
+
+void sl_snap_update (sl_display* restrict display, Window x_window, sl_window_dimensions dimensions) {
+	sl_snap_mutable* const this = (sl_snap_mutable*)&display->snap;
+
+	if (!this->built) return;
+
+	// it only snaps against the others, its edges are brought up to date once when the drag finishes instead of on every frame of it
+	if (display->drag.mode != drag_none && display->drag.x_window == x_window) return;
+
+	size_t const i = find_window(this, x_window);
+
+	if (i == this->windows_size || same_dimensions(this->windows[i].dimensions, dimensions)) return;
+
+	remove_edges(this, x_window, this->windows[i].dimensions);
+	insert_edges(this, x_window, dimensions);
+	this->windows[i].dimensions = dimensions;
+
+	++this->updates;
+}
+
+// the smallest move that brings position onto one of the edges, kept in distance when it is smaller than the one found so far
+static void nearest (sl_edge_mutable const* edges, size_t size, i32 position, Window skip, i32* distance) {
+	size_t const i = lower_bound(edges, size, position);
+
+	for (size_t j = i; j < size && edges[j].position - position < abs(*distance); ++j)
+		if (edges[j].x_window != skip) {
+			*distance = edges[j].position - position;
+			break;
+		}
+
+	for (size_t j = i; j > 0 && position - edges[j - 1].position < abs(*distance); --j)
+		if (edges[j - 1].x_window != skip) {
+			*distance = edges[j - 1].position - position;
+			break;
+		}
+}
+
+static i32 snap_axis (sl_snap_mutable const* restrict this, u8 low_edge, u8 high_edge, i32 low, i32 high, Window skip) {
+	i32 distance = M_snap_distance + 1;
+
+	// either side of the window lines up with either side of the others, or sits against it
+	nearest(this->edges[low_edge], this->size, low, skip, &distance);
+	nearest(this->edges[high_edge], this->size, low, skip, &distance);
+	nearest(this->edges[low_edge], this->size, high, skip, &distance);
+	nearest(this->edges[high_edge], this->size, high, skip, &distance);
+
+	return abs(distance) <= M_snap_distance ? distance : 0;
+}
+
+sl_window_dimensions sl_snap_move (sl_display* restrict display, sl_window const* restrict window, i16 x, i16 y) {
+	sl_snap_mutable* const this = (sl_snap_mutable*)&display->snap;
+	sl_window_dimensions dimensions = (sl_window_dimensions) {.x = x, .y = y, .width = window->dimensions.width, .height = window->dimensions.height};
+
+	ensure_built(display);
+
+	if (!this->built) return dimensions;
+
+	++this->queries;
+
+	i32 const dx = snap_axis(this, edge_left, edge_right, x, x + dimensions.width, window->x_window);
+	i32 const dy = snap_axis(this, edge_top, edge_bottom, y, y + dimensions.height, window->x_window);
+
+	if (dx || dy) ++this->snaps;
+
+	dimensions.x += dx;
+	dimensions.y += dy;
+
+	return dimensions;
+}
+
+void sl_snap_log_statistics (M_maybe_unused sl_snap const* restrict this) {
+	log("snap: %lu queries, %lu snapped, %lu incremental updates, %lu rebuilds", this->queries, this->snaps, this->updates, this->rebuilds);
+}
@@ -0,0 +1,68 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/X.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+
+typedef struct sl_display sl_display; // foward declaration
+typedef struct sl_window sl_window;   // foward declaration
+
+enum { edge_left, edge_right, edge_top, edge_bottom, edges_size };
+
+typedef struct sl_edge {
+	i32 const position;
+	Window const x_window; // None for the edges of the screen and of the workarea
+} sl_edge;
+
+typedef struct sl_snap_window {
+	Window const x_window;
+	sl_window_dimensions const dimensions; // the ones its edges were taken from
+} sl_snap_window;
+
+// the edges of the windows shown on the current workspace, each kind sorted by position so that a move looks them up by binary search
+typedef struct sl_snap {
+	sl_edge const* edges[edges_size];
+	size_t const size; // of each of the edge arrays
+	sl_snap_window const* windows; // sorted by window, looked up by binary search
+	size_t const windows_size;
+	size_t const allocated_size; // of all of them
+
+	u32 const generation; // of the window stack the windows were taken from
+	sl_window_dimensions const workarea;
+	bool const built;
+
+	u64 const queries;
+	u64 const snaps;
+	u64 const updates;
+	u64 const rebuilds;
+} sl_snap;
+
+extern void sl_snap_create (sl_snap* restrict);
+extern void sl_snap_delete (sl_snap* restrict);
+
+extern void sl_snap_update (sl_display* restrict, Window, sl_window_dimensions); // nothing happens for a window that is not in the index or is being dragged
+extern sl_window_dimensions sl_snap_move (sl_display* restrict, sl_window const* restrict, i16 x, i16 y); // the window at x and y, snapped
+
+extern void sl_snap_log_statistics (sl_snap const* restrict);
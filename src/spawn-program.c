@@ -0,0 +1,233 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#define _GNU_SOURCE // POSIX_SPAWN_SETSID
+
+#include "spawn-program.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <spawn.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "message.h"
+#include "timer.h"
+
+#ifdef D_spawn_log
+#	define spawn_log(M_message)         warn_log(M_message)
+#	define spawn_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define spawn_log(M_message)
+#	define spawn_log_va(M_message, ...)
+#endif
+
+#define M_path_cache_size 32
+
+extern char** environ;
+
+/*
+  programs are started with posix_spawn, which on linux is a vfork-like clone and does not copy our page tables the way fork does. the lookup of
+  a program in PATH is cached, and the cache is dropped whenever one of the PATH directories changes as reported by inotify.
+*/
+
+struct path_cache_entry {
+	char* name;
+	char* path;
+};
+
+typedef struct sl_spawn_statistics_mutable {
+	u64 count;
+	u64 failures;
+	u64 path_cache_hits;
+	u64 total_latency;
+	u64 max_latency;
+} sl_spawn_statistics_mutable;
+
+// every display thread has its own cache and its own inotify descriptor to poll
+static _Thread_local struct spawn_state {
+	struct path_cache_entry path_cache[M_path_cache_size];
+	size_t path_cache_size;
+	char* uncached_path; // the last lookup that could not be cached, kept until the next one
+
+	int inotify_fd;
+	bool watching;
+
+	sl_spawn_statistics_mutable statistics;
+} state = {.inotify_fd = -1};
+
+static void clear_path_cache () {
+	for (size_t i = 0; i < state.path_cache_size; ++i) {
+		free(state.path_cache[i].name);
+		free(state.path_cache[i].path);
+	}
+
+	state.path_cache_size = 0;
+}
+
+static void watch_path () {
+	if (state.watching) return;
+	state.watching = true;
+
+	state.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (state.inotify_fd == -1) {
+		// without inotify we can not tell when the cache goes stale, so it stays empty and every spawn searches PATH
+		spawn_log_va("inotify_init1 failed: %s", strerror(errno));
+		return;
+	}
+
+	char const* const path = getenv("PATH");
+	if (!path) return;
+
+	for (char const* begin = path; *begin;) {
+		char const* end = strchr(begin, ':');
+		if (!end) end = begin + strlen(begin);
+
+		if (end != begin && end - begin < PATH_MAX) {
+			char directory[PATH_MAX];
+			memcpy(directory, begin, end - begin);
+			directory[end - begin] = '\0';
+
+			if (inotify_add_watch(state.inotify_fd, directory, IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF) == -1) {
+				spawn_log_va("could not watch %s: %s", directory, strerror(errno));
+			}
+		}
+
+		begin = *end ? end + 1 : end;
+	}
+}
+
+static char* search_path (char const* name) {
+	char const* const path = getenv("PATH");
+	if (!path) return NULL;
+
+	size_t const name_size = strlen(name);
+
+	for (char const* begin = path; *begin;) {
+		char const* end = strchr(begin, ':');
+		if (!end) end = begin + strlen(begin);
+		size_t const directory_size = end - begin;
+
+		if (directory_size != 0 && directory_size + name_size + 2 <= PATH_MAX) {
+			char candidate[PATH_MAX];
+			memcpy(candidate, begin, directory_size);
+			candidate[directory_size] = '/';
+			memcpy(candidate + directory_size + 1, name, name_size + 1);
+
+			if (access(candidate, X_OK) == 0) return strdup(candidate);
+		}
+
+		begin = *end ? end + 1 : end;
+	}
+
+	return NULL;
+}
+
+static char const* resolve_program (char const* name) {
+	if (strchr(name, '/')) return name;
+
+	for (size_t i = 0; i < state.path_cache_size; ++i) {
+		if (strcmp(state.path_cache[i].name, name) == 0) {
+			++state.statistics.path_cache_hits;
+			return state.path_cache[i].path;
+		}
+	}
+
+	char* const path = search_path(name);
+	if (!path) return NULL;
+
+	if (state.inotify_fd == -1 || state.path_cache_size == M_path_cache_size) {
+		// not cacheable, keep it around until the next spawn
+		free(state.uncached_path);
+		return state.uncached_path = path;
+	}
+
+	state.path_cache[state.path_cache_size++] = (struct path_cache_entry) {.name = strdup(name), .path = path};
+
+	return path;
+}
+
+pid_t spawn_program (char* const* args) {
+	watch_path();
+
+	u64 const start = sl_monotonic_time();
+
+	posix_spawnattr_t attributes;
+	posix_spawnattr_init(&attributes);
+	posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSID);
+
+	pid_t pid = 0;
+	int error = ENOENT;
+
+	char const* path = resolve_program(args[0]);
+	if (path) {
+		error = posix_spawn(&pid, path, NULL, &attributes, args, environ);
+
+		if (error == ENOENT && path != args[0]) {
+			// the program moved before inotify told us, search again
+			clear_path_cache();
+			path = resolve_program(args[0]);
+			if (path) error = posix_spawn(&pid, path, NULL, &attributes, args, environ);
+		}
+	}
+
+	posix_spawnattr_destroy(&attributes);
+
+	u64 const latency = sl_monotonic_time() - start;
+
+	++state.statistics.count;
+	state.statistics.total_latency += latency;
+	if (latency > state.statistics.max_latency) state.statistics.max_latency = latency;
+
+	if (error) {
+		++state.statistics.failures;
+		warn_log_va("could not spawn %s: %s", args[0], strerror(error));
+		return 0;
+	}
+
+	spawn_log_va("[%i] spawned %s in %luns", pid, args[0], latency);
+
+	return pid;
+}
+
+int sl_spawn_path_watch_fd () { return state.inotify_fd; }
+
+void sl_spawn_path_watch_elapse () {
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	bool changed = false;
+	while (read(state.inotify_fd, buffer, sizeof(buffer)) > 0)
+		changed = true;
+
+	if (changed) {
+		spawn_log("PATH changed, dropping the program cache");
+		clear_path_cache();
+	}
+}
+
+sl_spawn_statistics const* sl_spawn_get_statistics () { return (sl_spawn_statistics const*)&state.statistics; }
+
+void sl_spawn_log_statistics () {
+	log(
+	"spawned %lu programs (%lu failed, %lu path cache hits), average latency %luns, max latency %luns", state.statistics.count,
+	state.statistics.failures, state.statistics.path_cache_hits, state.statistics.count ? state.statistics.total_latency / state.statistics.count : 0,
+	state.statistics.max_latency
+	);
+}
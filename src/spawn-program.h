@@ -0,0 +1,40 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <sys/types.h>
+
+#include "types.h"
+
+typedef struct sl_spawn_statistics {
+	u64 const count;
+	u64 const failures;
+	u64 const path_cache_hits;
+	u64 const total_latency; // nanoseconds spent inside posix_spawn
+	u64 const max_latency;
+} sl_spawn_statistics;
+
+extern pid_t spawn_program (char* const* args);
+
+extern int sl_spawn_path_watch_fd ();
+extern void sl_spawn_path_watch_elapse ();
+
+extern sl_spawn_statistics const* sl_spawn_get_statistics ();
+extern void sl_spawn_log_statistics ();
@@ -0,0 +1,135 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "string-table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "compiler-differences.h"
+#include "message.h"
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 64
+
+typedef struct sl_interned {
+	char* data;
+	size_t size;
+	u64 hash;
+} sl_interned;
+
+// one per display thread, an id only means something on the thread that handed it out
+static _Thread_local struct {
+	sl_interned* strings; // indexed by id - 1
+	u32 size;
+	u32 allocated_size;
+
+	u32* slots; // open addressing over the ids, 0 is an empty slot
+	u32 slots_size;
+
+	u64 lookups;
+} table;
+
+static u64 hash_string (char const* restrict data, size_t size) {
+	u64 hash = 0xcbf29ce484222325;
+
+	for (size_t i = 0; i < size; ++i)
+		hash = (hash ^ (u8)data[i]) * 0x100000001b3;
+
+	return hash;
+}
+
+static bool grow_slots () {
+	u32 const slots_size = max(table.slots_size << 1, M_smallest_nonzero_size);
+	u32* const slots = calloc(slots_size, sizeof(u32));
+
+	if (!slots) {
+		warn_log_va("size of %u is invalid", slots_size);
+		return false;
+	}
+
+	for (u32 id = 1; id <= table.size; ++id) {
+		u32 slot = table.strings[id - 1].hash & (slots_size - 1);
+		while (slots[slot])
+			slot = (slot + 1) & (slots_size - 1);
+		slots[slot] = id;
+	}
+
+	free(table.slots);
+	table.slots = slots;
+	table.slots_size = slots_size;
+	return true;
+}
+
+u32 sl_intern (char const* restrict data, size_t size) {
+	u64 const hash = hash_string(data, size);
+
+	++table.lookups;
+
+	// kept at most half full
+	if ((table.size + 1) * 2 > table.slots_size && !grow_slots()) return 0;
+
+	u32 slot = hash & (table.slots_size - 1);
+	for (; table.slots[slot]; slot = (slot + 1) & (table.slots_size - 1)) {
+		sl_interned const* const interned = &table.strings[table.slots[slot] - 1];
+
+		if (interned->hash == hash && interned->size == size && memcmp(interned->data, data, size) == 0) return table.slots[slot];
+	}
+
+	if (table.size == table.allocated_size) {
+		u32 const allocated_size = max(table.allocated_size << 1, M_smallest_nonzero_size);
+		sl_interned* const strings = realloc(table.strings, sizeof(sl_interned) * allocated_size);
+
+		if (!strings) {
+			warn_log_va("size of %u is invalid", allocated_size);
+			return 0;
+		}
+
+		table.strings = strings;
+		table.allocated_size = allocated_size;
+	}
+
+	char* const copy = malloc(size + 1);
+	if (!copy) return 0;
+
+	memcpy(copy, data, size);
+	copy[size] = '\0';
+
+	table.strings[table.size] = (sl_interned) {.data = copy, .size = size, .hash = hash};
+	table.slots[slot] = ++table.size;
+
+	return table.size;
+}
+
+char const* sl_interned_string (u32 id) { return id == 0 || id > table.size ? "" : table.strings[id - 1].data; }
+
+void sl_string_table_delete () {
+	for (u32 i = 0; i < table.size; ++i)
+		free(table.strings[i].data);
+
+	free(table.strings);
+	free(table.slots);
+
+	table.strings = NULL;
+	table.slots = NULL;
+	table.size = table.allocated_size = table.slots_size = 0;
+}
+
+void sl_string_table_log_statistics () { log("string table: %u strings, %lu lookups", table.size, table.lookups); }
@@ -0,0 +1,35 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include "types.h"
+
+/*
+  strings that are compared a lot, like the WM_CLASS of every window and the names in the rules file, are interned once and compared by id
+  afterwards. 0 is never handed out, it stands for no string.
+*/
+
+extern u32 sl_intern (char const* restrict, size_t size);
+extern char const* sl_interned_string (u32 id);
+
+extern void sl_string_table_delete ();
+extern void sl_string_table_log_statistics ();
@@ -0,0 +1,274 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "sync-resize.h"
+
+#include <stdlib.h>
+
+#include <X11/extensions/sync.h>
+
+#include "compiler-differences.h"
+#include "display.h"
+#include "message.h"
+#include "window.h"
+
+// link with -lXext
+
+#ifdef D_sync_resize_log
+#	define sync_resize_log(M_message)         warn_log(M_message)
+#	define sync_resize_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define sync_resize_log(M_message)
+#	define sync_resize_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+
+#define M_smallest_nonzero_size 4
+
+// a client that does not answer in this long gets its next size anyway
+#define M_sync_resize_timeout (100 * M_nanoseconds_per_millisecond)
+
+typedef struct sl_sync_client_mutable {
+	Window x_window;
+	XID counter;
+	XID alarm;
+	u64 value;
+	u64 deadline;
+	bool pending;
+} sl_sync_client_mutable;
+
+typedef struct sl_sync_resize_mutable {
+	bool available;
+	int event_base;
+
+	sl_sync_client_mutable* clients;
+	size_t size;
+	size_t allocated_size;
+
+	u64 requests;
+	u64 held;
+	u64 timeouts;
+} sl_sync_resize_mutable;
+
+static u64 from_sync_value (XSyncValue value) { return (u64)(u32)XSyncValueHigh32(value) << 32 | (u32)XSyncValueLow32(value); }
+
+static XSyncValue to_sync_value (u64 value) {
+	XSyncValue sync_value;
+	XSyncIntsToValue(&sync_value, (uint)(value & 0xffffffff), (int)(value >> 32));
+	return sync_value;
+}
+
+void sl_sync_resize_create (sl_sync_resize* restrict sync_resize, Display* x_display) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)sync_resize;
+
+	*this = (sl_sync_resize_mutable) {};
+
+	int error_base, major, minor;
+	this->available = XSyncQueryExtension(x_display, &this->event_base, &error_base) && XSyncInitialize(x_display, &major, &minor);
+
+	if (!this->available) warn_log("the server has no sync extension, resizes will not wait for the clients");
+}
+
+void sl_sync_resize_delete (sl_sync_resize* restrict sync_resize, Display* x_display) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)sync_resize;
+
+	for (size_t i = 0; i < this->size; ++i)
+		XSyncDestroyAlarm(x_display, this->clients[i].alarm);
+
+	if (this->clients) free(this->clients);
+}
+
+static size_t find_client (sl_sync_resize const* restrict this, Window x_window) {
+	size_t i = 0;
+	for (; i < this->size; ++i)
+		if (this->clients[i].x_window == x_window) break;
+
+	return i;
+}
+
+static sl_window* find_window (sl_display* restrict display, Window x_window) {
+	for (size_t i = 0; i < display->window_stack.size; ++i)
+		if (!display->window_stack.data[i].flagged_for_deletion && display->window_stack.data[i].window.x_window == x_window)
+			return (sl_window*)&display->window_stack.data[i].window;
+
+	return NULL;
+}
+
+void sl_sync_resize_set_counter (sl_display* restrict display, Window x_window, XID counter) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)&display->sync_resize;
+
+	if (!this->available) return;
+
+	size_t const i = find_client(&display->sync_resize, x_window);
+
+	if (i != this->size && this->clients[i].counter == counter) return;
+	if (i != this->size) sl_sync_resize_forget(display, x_window);
+	if (counter == None) return;
+
+	// the first value asked for has to be past the one the client set the counter to
+	XSyncValue current;
+	if (!XSyncQueryCounter(display->x_display, counter, &current)) return;
+
+	if (this->size == this->allocated_size) {
+		size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+		sl_sync_client_mutable* clients = realloc(this->clients, sizeof(sl_sync_client_mutable) * allocated_size);
+
+		if (!clients) {
+			warn_log_va("size of %lu is invalid", allocated_size);
+			return;
+		}
+
+		this->clients = clients;
+		this->allocated_size = allocated_size;
+	}
+
+	// fires once the counter is at least the wait value, with no delta it then stays inactive until the next request moves it
+	XSyncAlarmAttributes attributes = {
+	.trigger = {.counter = counter, .value_type = XSyncAbsolute, .wait_value = current, .test_type = XSyncPositiveComparison},
+	.events = true};
+	XSyncIntToValue(&attributes.delta, 0);
+
+	XSyncAlarm const alarm =
+	XSyncCreateAlarm(display->x_display, XSyncCACounter | XSyncCAValueType | XSyncCAValue | XSyncCATestType | XSyncCADelta | XSyncCAEvents, &attributes);
+
+	this->clients[this->size++] = (sl_sync_client_mutable) {.x_window = x_window, .counter = counter, .alarm = alarm, .value = from_sync_value(current)};
+
+	sync_resize_log_va("[%lu] sync counter %lu at %lu", x_window, counter, from_sync_value(current));
+}
+
+void sl_sync_resize_forget (sl_display* restrict display, Window x_window) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)&display->sync_resize;
+	size_t const i = find_client(&display->sync_resize, x_window);
+
+	if (i == this->size) return;
+
+	XSyncDestroyAlarm(display->x_display, this->clients[i].alarm);
+
+	this->clients[i] = this->clients[--this->size];
+}
+
+static void rearm_timer (sl_display* restrict display) {
+	u64 deadline = 0;
+
+	for (size_t i = 0; i < display->sync_resize.size; ++i)
+		if (display->sync_resize.clients[i].deadline && (!deadline || display->sync_resize.clients[i].deadline < deadline))
+			deadline = display->sync_resize.clients[i].deadline;
+
+	if (deadline) sl_timer_arm(&display->timers[timer_sync_resize], deadline);
+	else sl_timer_disarm(&display->timers[timer_sync_resize]);
+}
+
+bool sl_sync_resize_hold (sl_display* restrict display, sl_window* restrict window) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)&display->sync_resize;
+	size_t const i = find_client(&display->sync_resize, window->x_window);
+
+	if (i == this->size) return false;
+
+	sl_sync_client_mutable* const client = &this->clients[i];
+
+	// only the newest size is kept, it is read off the window when the client is done
+	if (client->deadline) {
+		if (!client->pending) ++this->held;
+		client->pending = true;
+		return true;
+	}
+
+	++client->value;
+
+	XClientMessageEvent event = (XClientMessageEvent) {
+	.type = ClientMessage,
+	.send_event = true,
+	.display = display->x_display,
+	.window = window->x_window,
+	.message_type = display->atoms[wm_protocols],
+	.format = 32,
+	.data.l[0] = display->atoms[net_wm_sync_request],
+	.data.l[1] = CurrentTime,
+	.data.l[2] = client->value & 0xffffffff,
+	.data.l[3] = client->value >> 32};
+
+	XSendEvent(display->x_display, window->x_window, false, 0, (XEvent*)&event);
+
+	XSyncAlarmAttributes attributes = {.trigger = {.wait_value = to_sync_value(client->value)}};
+	XSyncChangeAlarm(display->x_display, client->alarm, XSyncCAValue, &attributes);
+
+	client->deadline = sl_monotonic_time() + M_sync_resize_timeout;
+	++this->requests;
+
+	if (!sl_timer_is_armed(&display->timers[timer_sync_resize]) || client->deadline < display->timers[timer_sync_resize].deadline)
+		sl_timer_arm(&display->timers[timer_sync_resize], client->deadline);
+
+	return false;
+}
+
+static void release (sl_display* restrict display, size_t index) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)&display->sync_resize;
+	sl_sync_client_mutable* const client = &this->clients[index];
+
+	client->deadline = 0;
+
+	if (!client->pending) return;
+
+	client->pending = false;
+
+	sl_window* const window = find_window(display, client->x_window);
+	if (window) sl_commit_window_size(display, window);
+}
+
+bool sl_sync_resize_is_alarm_notify (sl_sync_resize const* restrict this, XEvent const* event) {
+	return this->available && event->type == this->event_base + XSyncAlarmNotify;
+}
+
+void sl_sync_resize_alarm_notify (sl_display* restrict display, XEvent* event) {
+	XSyncAlarmNotifyEvent const* const alarm_event = (XSyncAlarmNotifyEvent*)event;
+
+	for (size_t i = 0; i < display->sync_resize.size; ++i) {
+		if (display->sync_resize.clients[i].alarm != alarm_event->alarm) continue;
+
+		sync_resize_log_va("[%lu] drawn up to %lu", display->sync_resize.clients[i].x_window, from_sync_value(alarm_event->counter_value));
+
+		if (display->sync_resize.clients[i].deadline && from_sync_value(alarm_event->counter_value) >= display->sync_resize.clients[i].value) {
+			release(display, i);
+			rearm_timer(display);
+		}
+
+		return;
+	}
+}
+
+void sl_sync_resize_timeout (sl_display* restrict display) {
+	sl_sync_resize_mutable* const this = (sl_sync_resize_mutable*)&display->sync_resize;
+	u64 const now = sl_monotonic_time();
+
+	for (size_t i = 0; i < display->sync_resize.size; ++i) {
+		if (!display->sync_resize.clients[i].deadline || display->sync_resize.clients[i].deadline > now) continue;
+
+		sync_resize_log_va("[%lu] sync request timed out", display->sync_resize.clients[i].x_window);
+
+		++this->timeouts;
+		release(display, i);
+	}
+
+	rearm_timer(display);
+}
+
+void sl_sync_resize_log_statistics (M_maybe_unused sl_sync_resize const* restrict this) {
+	log("sync resize: %lu sync requests, %lu resizes held back, %lu timeouts, %lu clients", this->requests, this->held, this->timeouts, this->size);
+}
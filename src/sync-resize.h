@@ -0,0 +1,67 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/Xlib.h>
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+typedef struct sl_window sl_window;   // foward declaration
+
+// _NET_WM_SYNC_REQUEST: a window that takes part gets a resize only once it is done drawing the one before
+typedef struct sl_sync_client {
+	Window const x_window;
+	XID const counter; // the client's _NET_WM_SYNC_REQUEST_COUNTER
+	XID const alarm;   // fires when the counter reaches value
+	u64 const value;   // the last one sent with a sync request
+	u64 const deadline; // CLOCK_MONOTONIC nanoseconds, 0 when the client is not drawing a size
+	bool const pending; // a size was held back while the client was drawing
+} sl_sync_client;
+
+typedef struct sl_sync_resize {
+	bool const available; // the server has the sync extension
+	int const event_base;
+
+	sl_sync_client const* clients;
+	size_t const size;
+	size_t const allocated_size;
+
+	u64 const requests;
+	u64 const held;
+	u64 const timeouts;
+} sl_sync_resize;
+
+extern void sl_sync_resize_create (sl_sync_resize* restrict, Display*);
+extern void sl_sync_resize_delete (sl_sync_resize* restrict, Display*);
+
+extern void sl_sync_resize_set_counter (sl_display* restrict, Window, XID counter); // None when the window stopped taking part
+extern void sl_sync_resize_forget (sl_display* restrict, Window);
+
+// sends the sync request for the size the window has now, true when the client is still drawing and the size has to wait
+extern bool sl_sync_resize_hold (sl_display* restrict, sl_window* restrict);
+
+extern bool sl_sync_resize_is_alarm_notify (sl_sync_resize const* restrict, XEvent const*);
+extern void sl_sync_resize_alarm_notify (sl_display* restrict, XEvent*);
+extern void sl_sync_resize_timeout (sl_display* restrict); // the timer callback
+
+extern void sl_sync_resize_log_statistics (sl_sync_resize const* restrict);
@@ -0,0 +1,78 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "timer.h"
+
+#include <time.h>
+
+#include "message.h"
+
+u64 sl_monotonic_time () {
+	struct timespec timespec = {};
+#ifdef D_gcc
+	if (clock_gettime(CLOCK_MONOTONIC, &timespec) == -1) {
+		perror("clock_gettime");
+		assert_not_reached();
+	}
+#endif
+	return (u64)timespec.tv_sec * 1000000000 + (u64)timespec.tv_nsec;
+}
+
+void sl_timer_arm (sl_timer* restrict this, u64 deadline) {
+	// a deadline of 0 would read as disarmed
+	this->deadline = deadline ? deadline : 1;
+}
+
+void sl_timer_disarm (sl_timer* restrict this) { this->deadline = 0; }
+
+bool sl_timer_is_armed (sl_timer const* restrict this) { return this->deadline != 0; }
+
+u64 sl_timers_next_deadline (sl_timer const* restrict timers, size_t size) {
+	u64 deadline = 0;
+
+	for (size_t i = 0; i < size; ++i)
+		if (timers[i].deadline && !timers[i].paused && (!deadline || timers[i].deadline < deadline)) deadline = timers[i].deadline;
+
+	return deadline;
+}
+
+int sl_timers_poll_timeout (sl_timer const* restrict timers, size_t size) {
+	u64 const deadline = sl_timers_next_deadline(timers, size);
+
+	if (!deadline) return -1;
+
+	u64 const now = sl_monotonic_time();
+
+	if (deadline <= now) return 0;
+
+	// round up so that we never wake up before the deadline
+	return (deadline - now + M_nanoseconds_per_millisecond - 1) / M_nanoseconds_per_millisecond;
+}
+
+void sl_timers_run_expired (sl_timer* restrict timers, size_t size, sl_display* restrict display) {
+	u64 const now = sl_monotonic_time();
+
+	for (size_t i = 0; i < size; ++i) {
+		if (!timers[i].deadline || timers[i].paused || timers[i].deadline > now) continue;
+
+		// disarm first so the callback is free to re-arm itself
+		timers[i].deadline = 0;
+		if (timers[i].callback) timers[i].callback(display);
+	}
+}
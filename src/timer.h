@@ -0,0 +1,53 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+enum {
+	timer_process_priority,
+	timer_volume,
+	timer_brightness,
+	timer_drag,
+	timer_sync_resize,
+	timers_size
+};
+
+typedef void (*sl_timer_callback) (sl_display* restrict);
+
+typedef struct sl_timer {
+	u64 deadline; // CLOCK_MONOTONIC nanoseconds, 0 means disarmed
+	sl_timer_callback callback;
+	bool paused; // keeps its deadline but neither runs nor wakes the loop up
+} sl_timer;
+
+#define M_nanoseconds_per_millisecond 1000000
+
+extern u64 sl_monotonic_time ();
+
+extern void sl_timer_arm (sl_timer* restrict, u64 deadline);
+extern void sl_timer_disarm (sl_timer* restrict);
+extern bool sl_timer_is_armed (sl_timer const* restrict);
+
+extern u64 sl_timers_next_deadline (sl_timer const* restrict timers, size_t size);
+extern int sl_timers_poll_timeout (sl_timer const* restrict timers, size_t size);
+extern void sl_timers_run_expired (sl_timer* restrict timers, size_t size, sl_display* restrict);
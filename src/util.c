@@ -18,6 +18,7 @@
 
 #include "util.h"
 
+#include <errno.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -26,19 +27,32 @@
 
 #include "compiler-differences.h"
 #include "message.h"
+#include "spawn-program.h"
 
 void signal_handler (int signal_number) {
+	if (signal_number == SIGUSR1) return sl_log_set_level(sl_log_level + 1);
+	if (signal_number == SIGUSR2) return sl_log_set_level(sl_log_level - 1);
+
 	if (signal_number == SIGCHLD) {
-		int status = 0;
-		pid_t ret = waitpid(-1, &status, WNOHANG);
-		if (ret < 0) {
-			perror("waitpid");
-			assert_not_reached();
-		}
-		if (WIFEXITED(status)) {
-			int ret = WEXITSTATUS(status);
-			if (ret != 0) warn_log_va("child process returned nonzero status %i\n", ret);
+		int const saved_errno = errno;
+
+		// signals do not queue, one SIGCHLD may stand for any number of exited children
+		for (;;) {
+			int status = 0;
+			pid_t ret = waitpid(-1, &status, WNOHANG);
+			if (ret == 0) break;
+			if (ret < 0) {
+				if (errno == ECHILD) break;
+				perror("waitpid");
+				assert_not_reached();
+			}
+			if (WIFEXITED(status)) {
+				int ret = WEXITSTATUS(status);
+				if (ret != 0) warn_log_va("child process returned nonzero status %i\n", ret);
+			}
 		}
+
+		errno = saved_errno;
 	}
 }
 
@@ -57,21 +71,4 @@ int xerror_handler (Display* display, XErrorEvent* error_event) {
 
 int xio_error_handler (M_maybe_unused Display* display) { return 0; }
 
-void exec_program (M_maybe_unused Display* display, char* const* args) {
-	pid_t pid = fork();
-	if (pid < 0) {
-		perror("fork");
-		assert_not_reached();
-	}
-	if (pid == 0) {
-		if (setsid() == -1) {
-			perror("setsid");
-			assert_not_reached();
-		}
-		if (execvp(args[0], args)) {
-			perror("execvp");
-			assert_not_reached();
-		}
-		exit(0);
-	}
-}
+void exec_program (M_maybe_unused Display* display, char* const* args) { spawn_program(args); }
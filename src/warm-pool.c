@@ -0,0 +1,183 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "warm-pool.h"
+
+#include <errno.h>
+#include <signal.h>
+
+#include "display.h"
+#include "message.h"
+#include "spawn-program.h"
+#include "util.h"
+#include "window-stack.h"
+
+#ifdef D_warm_pool_log
+#	define warm_pool_log(M_message)         warn_log(M_message)
+#	define warm_pool_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define warm_pool_log(M_message)
+#	define warm_pool_log_va(M_message, ...)
+#endif
+
+/*
+  bitmask of the launchers that keep a warm instance around, override it with -DD_warm_launchers=... in predefined.mk. launchers without
+  warm_launcher_args are never kept warm whatever the mask says.
+*/
+#ifndef D_warm_launchers
+#	define D_warm_launchers (1 << launcher_terminal)
+#endif
+
+typedef struct sl_warm_instance_mutable {
+	pid_t pid;
+	Window x_window;
+	bool map_on_arrival;
+} sl_warm_instance_mutable;
+
+typedef struct sl_warm_pool_mutable {
+	sl_warm_instance_mutable instances[launchers_size];
+} sl_warm_pool_mutable;
+
+static char* const* const launcher_args[launchers_size] = {
+[launcher_terminal] = (char* const[]) {"lxterminal", 0},
+[launcher_chat] = (char* const[]) {"discord", 0},
+[launcher_file_manager] = (char* const[]) {"thunar", 0},
+[launcher_browser] = (char* const[]) {"firefox-bin", 0},
+[launcher_image_editor] = (char* const[]) {"gimp", 0}};
+
+/*
+  a warm instance has to be a process of its own, most of these programs hand a second invocation over to the one already running and exit
+  instead. discord and thunar (through its dbus daemon) always do, firefox only runs another instance with another profile.
+*/
+static char* const* const warm_launcher_args[launchers_size] = {
+[launcher_terminal] = (char* const[]) {"lxterminal", "--no-remote", 0},
+[launcher_image_editor] = (char* const[]) {"gimp", "--new-instance", 0}};
+
+static bool is_warm (u8 launcher) { return (D_warm_launchers & (1 << launcher)) != 0 && warm_launcher_args[launcher]; }
+
+static void warm_instance (sl_warm_pool* restrict this, u8 launcher) {
+	sl_warm_instance_mutable* const instance = &((sl_warm_pool_mutable*)this)->instances[launcher];
+
+	*instance = (sl_warm_instance_mutable) {.pid = spawn_program(warm_launcher_args[launcher]), .x_window = None, .map_on_arrival = false};
+
+	warm_pool_log_va("[%i] warming %s", instance->pid, warm_launcher_args[launcher][0]);
+}
+
+static bool instance_is_alive (sl_warm_instance const* restrict instance) {
+	// children are reaped by the SIGCHLD handler, so a dead instance does not linger as a zombie
+	return instance->pid != 0 && !(kill(instance->pid, 0) == -1 && errno == ESRCH);
+}
+
+void sl_warm_pool_create (sl_warm_pool* restrict this) { *(sl_warm_pool_mutable*)this = (sl_warm_pool_mutable) {}; }
+
+void sl_warm_pool_delete (sl_warm_pool* restrict this) {
+	for (u8 i = 0; i < launchers_size; ++i)
+		if (this->instances[i].pid != 0) kill(this->instances[i].pid, SIGTERM);
+
+	*(sl_warm_pool_mutable*)this = (sl_warm_pool_mutable) {};
+}
+
+void sl_warm_pool_fill (sl_display* restrict display) {
+	for (u8 i = 0; i < launchers_size; ++i)
+		if (is_warm(i) && !instance_is_alive(&display->warm_pool.instances[i])) warm_instance((sl_warm_pool*)&display->warm_pool, i);
+}
+
+bool sl_warm_pool_claim_window (sl_display* restrict display, size_t index) {
+	sl_window* const window = (sl_window*)&display->window_stack.data[index].window;
+
+	if (window->pid == 0) return false;
+
+	sl_warm_pool* const pool = (sl_warm_pool*)&display->warm_pool;
+
+	for (u8 i = 0; i < launchers_size; ++i) {
+		sl_warm_instance_mutable* const instance = &((sl_warm_pool_mutable*)pool)->instances[i];
+
+		if (instance->pid != window->pid || instance->x_window != None) continue;
+
+		if (instance->map_on_arrival) {
+			// the launcher was used before the instance was ready, let it map like any other window and warm the next one
+			warm_pool_log_va("[%lu] warm instance arrived late", window->x_window);
+			warm_instance(pool, i);
+			return false;
+		}
+
+		warm_pool_log_va("[%lu] holding warm instance", window->x_window);
+		instance->x_window = window->x_window;
+		return true;
+	}
+
+	return false;
+}
+
+bool sl_warm_pool_holds_x_window (sl_warm_pool const* restrict this, Window x_window) {
+	for (u8 i = 0; i < launchers_size; ++i)
+		if (this->instances[i].x_window == x_window && x_window != None) return true;
+
+	return false;
+}
+
+void sl_warm_pool_forget_x_window (sl_display* restrict display, Window x_window) {
+	sl_warm_pool* const pool = (sl_warm_pool*)&display->warm_pool;
+
+	for (u8 i = 0; i < launchers_size; ++i) {
+		sl_warm_instance_mutable* const instance = &((sl_warm_pool_mutable*)pool)->instances[i];
+
+		if (instance->x_window != x_window || x_window == None) continue;
+
+		// the instance went away on its own, the next one is started when the launcher is used
+		warm_pool_log_va("[%lu] warm instance destroyed", x_window);
+		*instance = (sl_warm_instance_mutable) {};
+	}
+}
+
+static void map_held_window (sl_display* restrict display, Window x_window, Time time) {
+	for (size_t i = 0; i < display->window_stack.size; ++i) {
+		if (display->window_stack.data[i].flagged_for_deletion) continue;
+		if (display->window_stack.data[i].window.x_window != x_window) continue;
+
+		XMapWindow(display->x_display, x_window);
+		sl_window_stack_add_window_to_current_workspace((sl_window_stack*)&display->window_stack, i);
+		sl_focus_raised_window(display, time);
+		return;
+	}
+
+	warn_log_va("[%lu] held warm instance is not in the window stack", x_window);
+}
+
+void sl_launch (sl_display* restrict display, u8 launcher, Time time) {
+	if (!is_warm(launcher)) return exec_program(display->x_display, launcher_args[launcher]);
+
+	sl_warm_pool* const pool = (sl_warm_pool*)&display->warm_pool;
+	sl_warm_instance_mutable* const instance = &((sl_warm_pool_mutable*)pool)->instances[launcher];
+
+	if (instance->x_window != None) {
+		Window const x_window = instance->x_window;
+
+		warm_instance(pool, launcher);
+		return map_held_window(display, x_window, time);
+	}
+
+	// pressed again while waiting, the instance may never show up (e.g. it forked and the window carries another pid) so do not keep the user waiting
+	if (instance->map_on_arrival) return exec_program(display->x_display, launcher_args[launcher]);
+
+	if (!instance_is_alive((sl_warm_instance*)instance)) warm_instance(pool, launcher);
+
+	// still starting up, map it as soon as it asks for it
+	instance->map_on_arrival = true;
+}
@@ -0,0 +1,63 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <X11/X.h>
+
+#include "types.h"
+
+typedef struct sl_display sl_display; // foward declaration
+
+enum {
+	launcher_terminal,
+	launcher_chat,
+	launcher_file_manager,
+	launcher_browser,
+	launcher_image_editor,
+	launchers_size
+};
+
+/*
+  a warm instance is a program started ahead of time whose first window is kept withdrawn until its launcher is used. the window is recognized by
+  comparing its _NET_WM_PID with the pid we spawned, so only programs known to run as a separate process when started with the right flag are
+  kept warm: lxterminal with --no-remote and gimp with --new-instance. single instance programs (discord, thunar, firefox) hand the request to
+  the process already running, and programs that fork before creating their windows give them another pid, neither can be kept warm.
+*/
+typedef struct sl_warm_instance {
+	pid_t const pid;       // 0 when there is no instance
+	Window const x_window; // None until the instance asks to be mapped
+	bool const map_on_arrival;
+} sl_warm_instance;
+
+typedef struct sl_warm_pool {
+	sl_warm_instance const instances[launchers_size];
+} sl_warm_pool;
+
+extern void sl_warm_pool_create (sl_warm_pool* restrict);
+extern void sl_warm_pool_delete (sl_warm_pool* restrict);
+extern void sl_warm_pool_fill (sl_display* restrict);
+
+extern bool sl_warm_pool_claim_window (sl_display* restrict, size_t index);
+extern bool sl_warm_pool_holds_x_window (sl_warm_pool const* restrict, Window);
+extern void sl_warm_pool_forget_x_window (sl_display* restrict, Window);
+
+extern void sl_launch (sl_display* restrict, u8 launcher, Time);
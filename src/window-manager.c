@@ -18,6 +18,9 @@
 
 #include "window-manager.h"
 
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
 #include <signal.h>
 #include <time.h>
 #include <unistd.h>
@@ -26,18 +29,32 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 
+#include "compiler-differences.h"
 #include "display.h"
 #include "event-responses.h"
+#include "ewmh-publisher.h"
 #include "message.h"
+#include "property.h"
+#include "request-queue.h"
+#include "spawn-program.h"
+#include "string-table.h"
 #include "util.h"
 #include "window.h"
 
+// the one of the display the calling thread runs
 sl_window_manager* window_manager () {
-	static sl_window_manager manager;
+	static _Thread_local sl_window_manager manager;
 	return &manager;
 }
 
 static void elapse_event (sl_display* display, XEvent* event) {
+	if (event->type < LASTEvent) ++window_manager()->events[event->type];
+	else ++window_manager()->extension_events;
+
+	// extension events have their type decided by the server
+	if (sl_sync_resize_is_alarm_notify(&display->sync_resize, event)) return sl_sync_resize_alarm_notify(display, event);
+	if (sl_outputs_is_screen_change(&display->outputs, event)) return sl_outputs_screen_change(display, event);
+
 	switch (event->type) {
 	// ButtonPressMask
 	case ButtonPress: return sl_button_press(display, &event->xbutton);
@@ -98,41 +115,225 @@ static void elapse_event (sl_display* display, XEvent* event) {
 	}
 }
 
-int main () {
+static void log_event_statistics () {
+	M_maybe_unused static char const* const names[LASTEvent] = {
+	[KeyPress] = "KeyPress",
+	[KeyRelease] = "KeyRelease",
+	[ButtonPress] = "ButtonPress",
+	[ButtonRelease] = "ButtonRelease",
+	[MotionNotify] = "MotionNotify",
+	[EnterNotify] = "EnterNotify",
+	[LeaveNotify] = "LeaveNotify",
+	[FocusIn] = "FocusIn",
+	[FocusOut] = "FocusOut",
+	[KeymapNotify] = "KeymapNotify",
+	[Expose] = "Expose",
+	[GraphicsExpose] = "GraphicsExpose",
+	[NoExpose] = "NoExpose",
+	[VisibilityNotify] = "VisibilityNotify",
+	[CreateNotify] = "CreateNotify",
+	[DestroyNotify] = "DestroyNotify",
+	[UnmapNotify] = "UnmapNotify",
+	[MapNotify] = "MapNotify",
+	[MapRequest] = "MapRequest",
+	[ReparentNotify] = "ReparentNotify",
+	[ConfigureNotify] = "ConfigureNotify",
+	[ConfigureRequest] = "ConfigureRequest",
+	[GravityNotify] = "GravityNotify",
+	[ResizeRequest] = "ResizeRequest",
+	[CirculateNotify] = "CirculateNotify",
+	[CirculateRequest] = "CirculateRequest",
+	[PropertyNotify] = "PropertyNotify",
+	[SelectionClear] = "SelectionClear",
+	[SelectionRequest] = "SelectionRequest",
+	[SelectionNotify] = "SelectionNotify",
+	[ColormapNotify] = "ColormapNotify",
+	[ClientMessage] = "ClientMessage",
+	[MappingNotify] = "MappingNotify",
+	[GenericEvent] = "GenericEvent"};
+
+	u64 total = window_manager()->extension_events;
+	for (int type = 0; type < LASTEvent; ++type) {
+		total += window_manager()->events[type];
+		if (window_manager()->events[type]) log("events: %lu %s", window_manager()->events[type], names[type] ? names[type] : "unknown");
+	}
+
+	log("events: %lu from extensions, %lu in total", window_manager()->extension_events, total);
+}
+
+static bool logout_is_done (sl_display* display) {
+	if (!window_manager()->logout) return false;
+
+	for (size_t i = 0; i < display->window_stack.size; ++i) {
+		if (!(display->window_stack.data[i].flagged_for_deletion | !sl_window_stack_is_valid_index(display->window_stack.data[i].next))) return false;
+	}
+
+	sl_log_suspended = false; // the statistics are written even when a fullscreen window was focused last
+	log("screen %i successfuly waited for all window to delete themselves\nexiting...\n", display->screen);
+	log_event_statistics();
+	sl_spawn_log_statistics();
+	sl_property_log_statistics(display);
+	sl_attribute_cache_log_statistics(&display->attribute_cache);
+	sl_request_queue_log_statistics(&display->request_queue);
+	sl_ewmh_publisher_log_statistics(&display->ewmh_publisher);
+	sl_workarea_log_statistics(&display->workarea);
+	sl_outputs_log_statistics(&display->outputs);
+	sl_icon_cache_log_statistics(&display->icon_cache);
+	sl_rules_log_statistics(&display->rules);
+	sl_drag_log_statistics(&display->drag);
+	sl_sync_resize_log_statistics(&display->sync_resize);
+	sl_snap_log_statistics(&display->snap);
+	sl_placement_log_statistics(&display->placement);
+	sl_layout_log_statistics(&display->layout);
+	sl_low_latency_log_statistics(&display->low_latency);
+	sl_string_table_log_statistics();
+
+	Display* const x_display = display->x_display;
+	sl_display_delete(display);
+	sl_string_table_delete();
+	XCloseDisplay(x_display);
+	return true;
+}
+
+typedef struct sl_display_thread {
+	char const* name; // NULL for $DISPLAY
+	int screen;
+	pthread_t thread;
+	bool started;
+} sl_display_thread;
+
+// one per screen, with a connection and an event loop of its own so that a client stalling one screen does not hold up the input of another
+static sigset_t handled_signals () {
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGCHLD);
+	sigaddset(&signals, SIGUSR1);
+	sigaddset(&signals, SIGUSR2);
+	return signals;
+}
+
+static void* run_display (void* argument) {
+	sl_display_thread const* const thread = argument;
 	sl_display* display;
 
+	sl_log_register_thread();
+
+	{
+		sigset_t const signals = handled_signals();
+		pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+	}
+
+	{
+		Display* const x_display = XOpenDisplay(thread->name);
+		if (!x_display) {
+			warn_log_va("could not open display %s", thread->name ? thread->name : "$DISPLAY");
+			return NULL;
+		}
+
+		display = sl_display_create(x_display, thread->screen);
+		if (!display) {
+			XCloseDisplay(x_display);
+			return NULL;
+		}
+	}
+
+	struct pollfd poll_fds[] = {
+	{.fd = ConnectionNumber(display->x_display), .events = POLLIN},
+	{.fd = sl_spawn_path_watch_fd(), .events = POLLIN}, // negative until the first spawn, poll skips it
+	};
+
+	for (;;) {
+		// XPending also reads whatever is waiting on the connection, so events are never left behind in the socket after this loop
+		while (XPending(display->x_display)) {
+			XEvent event;
+			XNextEvent(display->x_display, &event);
+			elapse_event(display, &event);
+
+			if (logout_is_done(display)) return NULL;
+		}
+
+		sl_request_queue_elapse(display);
+		sl_low_latency_update(display);
+		sl_timers_run_expired(display->timers, timers_size, display);
+		sl_layout_flush(display);
+		sl_ewmh_publisher_flush(display);
+		XFlush(display->x_display);
+
+		// replies read off the socket by XPending would not wake poll up, they are resumed before going to sleep
+		if (XPending(display->x_display) || sl_request_queue_elapse(display)) continue;
+
+		poll_fds[1].fd = sl_spawn_path_watch_fd();
+
+		if (poll(poll_fds, sizeof(poll_fds) / sizeof(poll_fds[0]), sl_timers_poll_timeout(display->timers, timers_size)) == -1) {
+			if (errno == EINTR) continue;
+			perror("poll");
+			assert_not_reached();
+		}
+
+		if (poll_fds[1].revents & POLLIN) sl_spawn_path_watch_elapse();
+	}
+}
+
+// every screen of every display named on the command line is managed, or of $DISPLAY when there is none
+int main (int argc, char** argv) {
+	assert(XInitThreads());
+
 	XSetErrorHandler(xerror_handler);
 
 	XSetIOErrorHandler(xio_error_handler);
 
+	/*
+	  the handlers log, so the signals are only taken by the display threads once they have a log ring to write to. blocked before the handlers
+	  are installed and before any thread is started, every thread starts with them blocked.
+	*/
+	{
+		sigset_t const signals = handled_signals();
+		pthread_sigmask(SIG_BLOCK, &signals, NULL);
+	}
+
 #ifdef D_gcc
 	{
 		struct sigaction signal_action = (struct sigaction) {.sa_flags = SA_RESTART, .sa_handler = &signal_handler};
-		if (sigaction(SIGCHLD, &signal_action, NULL) == -1) {
+		if (sigaction(SIGCHLD, &signal_action, NULL) == -1 || sigaction(SIGUSR1, &signal_action, NULL) == -1 ||
+		    sigaction(SIGUSR2, &signal_action, NULL) == -1) {
 			perror("sigaction");
 			assert_not_reached();
 		}
 	}
 #endif
 
-	{
-		Display* x_display;
-		assert(x_display = XOpenDisplay(NULL));
-		display = sl_display_create(x_display);
+	sl_log_start();
+
+	char* const default_names[] = {NULL};
+	char* const* const names = argc > 1 ? argv + 1 : default_names;
+	size_t const names_size = argc > 1 ? (size_t)argc - 1 : 1;
+
+	int screens[names_size];
+	size_t threads_size = 0;
+
+	for (size_t i = 0; i < names_size; ++i) {
+		Display* const x_display = XOpenDisplay(names[i]);
+		screens[i] = x_display ? ScreenCount(x_display) : 0;
+		threads_size += screens[i];
+
+		if (x_display) XCloseDisplay(x_display);
+		else warn_log_va("could not open display %s", names[i] ? names[i] : "$DISPLAY");
 	}
 
-	warn_log("todo: this should be where we create threads for every display and handle each individually");
-	for (XEvent event; !XNextEvent(display->x_display, &event);) {
-		elapse_event(display, &event);
-
-		if (window_manager()->logout) {
-			for (size_t i = 0; i < display->window_stack.size; ++i) {
-				if (!(display->window_stack.data[i].flagged_for_deletion | !sl_window_stack_is_valid_index(display->window_stack.data[i].next))) goto out;
-			}
-			log_message("successfuly waited for all window to delete themselves\nexiting...\n");
-			sl_display_delete(display);
-			return 0;
+	sl_display_thread threads[threads_size + 1];
+
+	for (size_t i = 0, k = 0; i < names_size; ++i)
+		for (int screen = 0; screen < screens[i]; ++screen, ++k) {
+			threads[k] = (sl_display_thread) {.name = names[i], .screen = screen};
+			threads[k].started = pthread_create(&threads[k].thread, NULL, &run_display, &threads[k]) == 0;
+
+			if (!threads[k].started) warn_log_va("could not start the thread of screen %i of %s", screen, names[i] ? names[i] : "$DISPLAY");
 		}
-	out:;
-	}
+
+	for (size_t k = 0; k < threads_size; ++k)
+		if (threads[k].started) pthread_join(threads[k].thread, NULL);
+
+	sl_log_stop();
+
+	return 0;
 }
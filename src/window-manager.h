@@ -24,6 +24,9 @@
 
 typedef struct sl_window_manager {
 	bool logout;
+
+	u64 events[LASTEvent]; // received, by type
+	u64 extension_events;
 } sl_window_manager;
 
 extern sl_window_manager* window_manager ();
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <X11/X.h>
 
 #include "types.h"
@@ -27,6 +29,7 @@
 struct sl_sized_string_mutable {
 	char* data;
 	size_t size;
+	u64 hash;
 };
 
 typedef struct sl_window_mutable {
@@ -37,6 +40,10 @@ typedef struct sl_window_mutable {
 
 	struct sl_sized_string_mutable name;
 	struct sl_sized_string_mutable icon_name;
+	u32 instance;
+	u32 class;
+	Window transient_for;
+	Window group;
 
 	struct window_normal_hints {
 		u16 min_width;
@@ -60,4 +67,10 @@ typedef struct sl_window_mutable {
 	struct sl_sized_string_mutable net_wm_visible_name;
 	struct sl_sized_string_mutable net_wm_icon_name;
 	struct sl_sized_string_mutable net_wm_visible_icon_name;
+
+	pid_t net_wm_pid;
+	pid_t pid;
+	u64 published_net_wm_state;
+	u32 published_desktop;
+	u64 icon_hash;
 } sl_window_mutable;
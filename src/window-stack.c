@@ -32,8 +32,8 @@
 		window_stack_log_va("window stack: size %lu, allocated size %lu", this->size, this->allocated_size); \
 		for (size_t i = 0; i < this->size; ++i) \
 			window_stack_log_va( \
-			"[%lu]: window %lu, next %lu, previous %lu, flagged for deletion %u", i, this->data[i].window.x_window, this->data[i].next, \
-			this->data[i].previous, this->data[i].flagged_for_deletion \
+			"[%lu]: window %lu, next %lu, previous %lu, leader %lu, flagged for deletion %u", i, this->data[i].window.x_window, this->data[i].next, \
+			this->data[i].previous, this->data[i].leader, this->data[i].flagged_for_deletion \
 			); \
 		window_stack_log_va("workspace vector: size %lu, allocated_size %lu", this->workspace_vector.size, this->workspace_vector.allocated_size); \
 		for (size_t i = 0; i < this->workspace_vector.size; ++i) \
@@ -62,6 +62,9 @@ typedef struct sl_window_node_mutable {
 	sl_window_mutable window;
 	size_t previous;
 	size_t next;
+	size_t leader;
+	size_t first_follower;
+	size_t next_follower;
 	bool flagged_for_deletion;
 } sl_window_node_mutable;
 
@@ -75,6 +78,9 @@ typedef struct sl_window_stack_mutable {
 	workspace_type current_workspace;
 
 	size_t focused_window_index;
+
+	u8 changes;
+	u32 generation;
 } sl_window_stack_mutable;
 
 static void workspace_vector_initialize (size_t* restrict indexes, size_t size) {
@@ -135,7 +141,7 @@ static void workspace_vector_ensure_capacity (sl_workspace_vector* restrict this
 }
 
 static void workspace_vector_push (sl_workspace_vector* restrict this) {
-	workspace_vector_ensure_capacity(this, this->size);
+	workspace_vector_ensure_capacity(this, this->size + 1);
 
 	((sl_workspace_vector_mutable*)this)->indexes[this->size] = M_invalid_index;
 	++((sl_workspace_vector_mutable*)this)->size;
@@ -165,7 +171,8 @@ void sl_window_stack_create (sl_window_stack* restrict this, size_t size) {
 	}
 
 	*(sl_window_stack_mutable*)this = (sl_window_stack_mutable
-	) {.data = (sl_window_node_mutable*)data, .size = size, .allocated_size = allocated_size, .focused_window_index = M_invalid_index};
+	) {.data = (sl_window_node_mutable*)data, .size = size, .allocated_size = allocated_size, .focused_window_index = M_invalid_index,
+	.changes = window_stack_changed_all};
 
 	workspace_vector_create((sl_workspace_vector*)&this->workspace_vector, 4);
 
@@ -188,6 +195,16 @@ struct index_pair {
 	size_t next;
 };
 
+static size_t remap_index (size_t const* remap, size_t index) { return index == M_invalid_index ? M_invalid_index : remap[index]; }
+
+static void remap_groups (sl_window_node_mutable* data, size_t size, size_t const* remap) {
+	for (size_t i = 0; i < size; ++i) {
+		data[i].leader = remap_index(remap, data[i].leader);
+		data[i].first_follower = remap_index(remap, data[i].first_follower);
+		data[i].next_follower = remap_index(remap, data[i].next_follower);
+	}
+}
+
 static void window_stack_ensure_capacity_plus_one (sl_window_stack* restrict this) {
 	if (this->allocated_size >= this->size + 1) return;
 
@@ -227,6 +244,11 @@ static void window_stack_ensure_capacity_plus_one (sl_window_stack* restrict thi
 		return;
 	}
 
+	// the group links are rewritten through this, nodes flagged for deletion were already taken out of their groups
+	size_t remap[this->size];
+	for (size_t i = 0, j = 0; i < this->size; ++i)
+		remap[i] = this->data[i].flagged_for_deletion ? M_invalid_index : j++;
+
 	if (index_pair_array_size == 0) {
 		for (size_t i = 0, j = 0; i < this->size; ++i) {
 			if (this->data[i].flagged_for_deletion) continue;
@@ -245,6 +267,8 @@ static void window_stack_ensure_capacity_plus_one (sl_window_stack* restrict thi
 			++j;
 		}
 
+		remap_groups(new_data, new_size, remap);
+
 		free((void*)this->data);
 
 		((sl_window_stack_mutable*)this)->data = new_data;
@@ -308,6 +332,8 @@ static void window_stack_ensure_capacity_plus_one (sl_window_stack* restrict thi
 		++j;
 	}
 
+	remap_groups(new_data, new_size, remap);
+
 	free((void*)this->data);
 
 	((sl_window_stack_mutable*)this)->data = new_data;
@@ -317,51 +343,102 @@ static void window_stack_ensure_capacity_plus_one (sl_window_stack* restrict thi
 	window_stack_print();
 }
 
+static void unlink_from_leader (sl_window_stack* restrict this, size_t index) {
+	size_t const leader = this->data[index].leader;
+
+	if (leader == M_invalid_index) return;
+
+	if (this->data[leader].first_follower == index) {
+		((sl_window_stack_mutable*)this)->data[leader].first_follower = this->data[index].next_follower;
+	} else {
+		size_t i = this->data[leader].first_follower;
+		while (this->data[i].next_follower != index)
+			i = this->data[i].next_follower;
+		((sl_window_stack_mutable*)this)->data[i].next_follower = this->data[index].next_follower;
+	}
+
+	((sl_window_stack_mutable*)this)->data[index].leader = M_invalid_index;
+	((sl_window_stack_mutable*)this)->data[index].next_follower = M_invalid_index;
+}
+
 sl_window* sl_window_stack_add_window (sl_window_stack* restrict this, sl_window* window) {
 	window_stack_ensure_capacity_plus_one(this);
 
-	((sl_window_stack_mutable*)this)->data[this->size] =
-	(sl_window_node_mutable) {*(sl_window_mutable*)window, .next = M_invalid_index, .previous = M_invalid_index};
+	((sl_window_stack_mutable*)this)->data[this->size] = (sl_window_node_mutable) {
+	*(sl_window_mutable*)window,
+	.next = M_invalid_index,
+	.previous = M_invalid_index,
+	.leader = M_invalid_index,
+	.first_follower = M_invalid_index,
+	.next_follower = M_invalid_index};
 
 	++((sl_window_stack_mutable*)this)->size;
 
+	// windows that named this one before it existed
+	for (size_t i = 0; i < this->size - 1; ++i) {
+		if (this->data[i].flagged_for_deletion || this->data[i].leader != M_invalid_index) continue;
+		if (this->data[i].window.transient_for == window->x_window || this->data[i].window.group == window->x_window) sl_window_stack_update_leader(this, i);
+	}
+
 	window_stack_print();
 
 	return (sl_window*)&this->data[this->size - 1].window;
 }
 
 void sl_window_stack_remove_window (sl_window_stack* restrict this, size_t index) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_clients | window_stack_changed_stacking;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	((sl_window_stack_mutable*)this)->data[index].flagged_for_deletion = true;
 
+	unlink_from_leader(this, index);
+
+	for (size_t i = this->data[index].first_follower, next; i != M_invalid_index; i = next) {
+		next = this->data[i].next_follower;
+		((sl_window_stack_mutable*)this)->data[i].leader = M_invalid_index;
+		((sl_window_stack_mutable*)this)->data[i].next_follower = M_invalid_index;
+	}
+	((sl_window_stack_mutable*)this)->data[index].first_follower = M_invalid_index;
+
 	if (this->data[index].next != M_invalid_index) sl_window_stack_remove_window_from_its_workspace(this, index);
 
 	window_stack_print();
 }
 
-void sl_window_stack_add_window_to_current_workspace (sl_window_stack* restrict this, size_t index) {
-	if (this->workspace_vector.indexes[this->current_workspace] == M_invalid_index) {
+void sl_window_stack_add_window_to_workspace (sl_window_stack* restrict this, size_t index, workspace_type workspace) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_clients | window_stack_changed_stacking | window_stack_changed_workspaces;
+	++((sl_window_stack_mutable*)this)->generation;
+
+	if (this->workspace_vector.indexes[workspace] == M_invalid_index) {
 		((sl_window_stack_mutable*)this)->data[index].next = index;
 		((sl_window_stack_mutable*)this)->data[index].previous = index;
 
-		((sl_window_stack_mutable*)this)->workspace_vector.indexes[this->current_workspace] = index;
+		((sl_window_stack_mutable*)this)->workspace_vector.indexes[workspace] = index;
 
 		window_stack_print();
 
 		return;
 	}
 
-	((sl_window_stack_mutable*)this)->data[index].next = this->data[this->workspace_vector.indexes[this->current_workspace]].next;
-	((sl_window_stack_mutable*)this)->data[this->data[this->workspace_vector.indexes[this->current_workspace]].next].previous = index;
+	((sl_window_stack_mutable*)this)->data[index].next = this->data[this->workspace_vector.indexes[workspace]].next;
+	((sl_window_stack_mutable*)this)->data[this->data[this->workspace_vector.indexes[workspace]].next].previous = index;
 
-	((sl_window_stack_mutable*)this)->data[this->workspace_vector.indexes[this->current_workspace]].next = index;
-	((sl_window_stack_mutable*)this)->data[index].previous = this->workspace_vector.indexes[this->current_workspace];
+	((sl_window_stack_mutable*)this)->data[this->workspace_vector.indexes[workspace]].next = index;
+	((sl_window_stack_mutable*)this)->data[index].previous = this->workspace_vector.indexes[workspace];
 
-	((sl_window_stack_mutable*)this)->workspace_vector.indexes[this->current_workspace] = index;
+	((sl_window_stack_mutable*)this)->workspace_vector.indexes[workspace] = index;
 
 	window_stack_print();
 }
 
+void sl_window_stack_add_window_to_current_workspace (sl_window_stack* restrict this, size_t index) {
+	return sl_window_stack_add_window_to_workspace(this, index, this->current_workspace);
+}
+
 void sl_window_stack_remove_window_from_its_workspace (sl_window_stack* restrict this, size_t index) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_clients | window_stack_changed_stacking | window_stack_changed_workspaces;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	if (this->data[index].previous == index) {
 		for (size_t i = 0; i < this->workspace_vector.size; ++i)
 			if (this->workspace_vector.indexes[i] == index) ((sl_window_stack_mutable*)this)->workspace_vector.indexes[i] = M_invalid_index;
@@ -387,6 +464,9 @@ void sl_window_stack_remove_window_from_its_workspace (sl_window_stack* restrict
 }
 
 void sl_window_stack_add_workspace (sl_window_stack* restrict this) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_workspaces;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	workspace_vector_push((sl_workspace_vector*)&this->workspace_vector);
 
 	window_stack_print();
@@ -395,6 +475,9 @@ void sl_window_stack_add_workspace (sl_window_stack* restrict this) {
 void sl_window_stack_remove_workspace (sl_window_stack* restrict this) {
 	if (this->workspace_vector.size <= 1) return;
 
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_workspaces | window_stack_changed_stacking | window_stack_changed_current_workspace;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	if (this->current_workspace == this->workspace_vector.size - 1) {
 		--((sl_window_stack_mutable*)this)->current_workspace;
 	}
@@ -433,6 +516,8 @@ void sl_window_stack_remove_workspace (sl_window_stack* restrict this) {
 }
 
 void sl_window_stack_cycle_up (sl_window_stack* restrict this) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_stacking;
+
 	if (this->workspace_vector.indexes[this->current_workspace] == M_invalid_index) return;
 
 	((sl_window_stack_mutable*)this)->workspace_vector.indexes[this->current_workspace] =
@@ -442,6 +527,8 @@ void sl_window_stack_cycle_up (sl_window_stack* restrict this) {
 }
 
 void sl_window_stack_cycle_down (sl_window_stack* restrict this) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_stacking;
+
 	if (this->workspace_vector.indexes[this->current_workspace] == M_invalid_index) return;
 
 	((sl_window_stack_mutable*)this)->workspace_vector.indexes[this->current_workspace] =
@@ -451,6 +538,9 @@ void sl_window_stack_cycle_down (sl_window_stack* restrict this) {
 }
 
 void sl_window_stack_cycle_workspace_up (sl_window_stack* restrict this) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_current_workspace;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	++((sl_window_stack_mutable*)this)->current_workspace;
 	((sl_window_stack_mutable*)this)->current_workspace %= this->workspace_vector.size;
 
@@ -458,6 +548,9 @@ void sl_window_stack_cycle_workspace_up (sl_window_stack* restrict this) {
 }
 
 void sl_window_stack_cycle_workspace_down (sl_window_stack* restrict this) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_current_workspace;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	if (this->current_workspace == 0)
 		((sl_window_stack_mutable*)this)->current_workspace = this->workspace_vector.size - 1;
 	else
@@ -467,6 +560,8 @@ void sl_window_stack_cycle_workspace_down (sl_window_stack* restrict this) {
 }
 
 void sl_window_stack_set_raised_window (sl_window_stack* restrict this, size_t index) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_stacking;
+
 	((sl_window_stack_mutable*)this)->data[this->data[index].previous].next = this->data[index].next;
 	((sl_window_stack_mutable*)this)->data[this->data[index].next].previous = this->data[index].previous;
 
@@ -482,23 +577,81 @@ void sl_window_stack_set_raised_window (sl_window_stack* restrict this, size_t i
 }
 
 void sl_window_stack_set_focused_window (sl_window_stack* restrict this, size_t index) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_focus;
+
 	((sl_window_stack_mutable*)this)->focused_window_index = index;
 
 	window_stack_print();
 }
 
 void sl_window_stack_set_focused_window_as_invalid (sl_window_stack* restrict this) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_focus;
+
 	((sl_window_stack_mutable*)this)->focused_window_index = M_invalid_index;
 
 	window_stack_print();
 }
 
 void sl_window_stack_set_current_workspace (sl_window_stack* restrict this, workspace_type workspace) {
+	((sl_window_stack_mutable*)this)->changes |= window_stack_changed_current_workspace;
+	++((sl_window_stack_mutable*)this)->generation;
+
 	((sl_window_stack_mutable*)this)->current_workspace = workspace;
 
 	window_stack_print();
 }
 
+void sl_window_stack_clear_changes (sl_window_stack* restrict this) { ((sl_window_stack_mutable*)this)->changes = 0; }
+
+static size_t find_x_window (sl_window_stack* restrict this, Window x_window) {
+	if (x_window == None) return M_invalid_index;
+
+	for (size_t i = 0; i < this->size; ++i)
+		if (!this->data[i].flagged_for_deletion && this->data[i].window.x_window == x_window) return i;
+
+	return M_invalid_index;
+}
+
+void sl_window_stack_update_leader (sl_window_stack* restrict this, size_t index) {
+	// a transient belongs to the window it is for, otherwise it follows the leader of its group
+	size_t leader = find_x_window(this, this->data[index].window.transient_for);
+	if (leader == M_invalid_index) leader = find_x_window(this, this->data[index].window.group);
+
+	if (leader == this->data[index].leader) return;
+
+	unlink_from_leader(this, index);
+
+	// clients can name each other, the link that would close a loop is left out
+	for (size_t i = leader; i != M_invalid_index; i = this->data[i].leader)
+		if (i == index) {
+			window_stack_print();
+
+			return;
+		}
+
+	if (leader != M_invalid_index) {
+		((sl_window_stack_mutable*)this)->data[index].leader = leader;
+		((sl_window_stack_mutable*)this)->data[index].next_follower = this->data[leader].first_follower;
+		((sl_window_stack_mutable*)this)->data[leader].first_follower = index;
+	}
+
+	window_stack_print();
+}
+
+size_t sl_window_stack_raise_group (sl_window_stack* restrict this, size_t index) {
+	size_t size = 0;
+
+	// every window goes on top of the one before, the leader ends up under its followers and each follower under its own
+	for (size_t i = index; i != M_invalid_index; i = sl_window_stack_get_next_in_group(this, index, i)) {
+		if (!sl_window_stack_is_in_workspace(this, i, this->current_workspace)) continue;
+
+		sl_window_stack_set_raised_window(this, i);
+		++size;
+	}
+
+	return size;
+}
+
 sl_window* sl_window_stack_get_raised_window (sl_window_stack* restrict this) {
 	if (this->workspace_vector.indexes[this->current_workspace] == M_invalid_index) return NULL;
 
@@ -522,3 +675,33 @@ size_t sl_window_stack_get_raised_window_index (sl_window_stack* restrict this)
 }
 
 bool sl_window_stack_is_valid_index (size_t index) { return !(index == M_invalid_index); }
+
+size_t sl_window_stack_get_window_index (sl_window_stack* restrict this, sl_window const* window) {
+	return (size_t)((sl_window_node const*)window - this->data);
+}
+
+size_t sl_window_stack_get_group_root (sl_window_stack* restrict this, size_t index) {
+	while (this->data[index].leader != M_invalid_index)
+		index = this->data[index].leader;
+
+	return index;
+}
+
+size_t sl_window_stack_get_next_in_group (sl_window_stack* restrict this, size_t root, size_t index) {
+	// preorder walk of the followers of root
+	if (this->data[index].first_follower != M_invalid_index) return this->data[index].first_follower;
+
+	for (; index != root; index = this->data[index].leader)
+		if (this->data[index].next_follower != M_invalid_index) return this->data[index].next_follower;
+
+	return M_invalid_index;
+}
+
+bool sl_window_stack_is_in_workspace (sl_window_stack* restrict this, size_t index, workspace_type workspace) {
+	if (this->data[index].next == M_invalid_index || this->workspace_vector.indexes[workspace] == M_invalid_index) return false;
+
+	for (size_t i = this->data[this->workspace_vector.indexes[workspace]].next;; i = this->data[i].next) {
+		if (i == index) return true;
+		if (i == this->workspace_vector.indexes[workspace]) return false;
+	}
+}
@@ -31,9 +31,25 @@ typedef struct sl_window_node {
 	sl_window window;
 	size_t previous;
 	size_t next;
+
+	// the transient and window group tree, the followers of a window are linked through their next_follower
+	size_t leader;
+	size_t first_follower;
+	size_t next_follower;
+
 	bool flagged_for_deletion;
 } sl_window_node;
 
+// what changed since the last sl_window_stack_clear_changes, for the ewmh publisher to know what it has to look at
+enum {
+	window_stack_changed_clients = 1 << 0,    // a window started or stopped being in a workspace
+	window_stack_changed_stacking = 1 << 1,   // the order of the windows in a workspace changed
+	window_stack_changed_workspaces = 1 << 2, // workspaces were added or removed, or a window moved between them
+	window_stack_changed_current_workspace = 1 << 3,
+	window_stack_changed_focus = 1 << 4,
+	window_stack_changed_all = (1 << 5) - 1
+};
+
 typedef struct sl_window_stack {
 	struct sl_window_node const* data;
 	size_t const size;
@@ -44,12 +60,16 @@ typedef struct sl_window_stack {
 	workspace_type const current_workspace;
 
 	size_t const focused_window_index;
+
+	u8 const changes;
+	u32 const generation; // moves on whenever the windows shown on the current workspace may have changed
 } sl_window_stack;
 
 void sl_window_stack_create (sl_window_stack* restrict, size_t size);
 void sl_window_stack_delete (sl_window_stack* restrict);
 sl_window* sl_window_stack_add_window (sl_window_stack* restrict, sl_window* window);
 void sl_window_stack_remove_window (sl_window_stack* restrict, size_t index);
+void sl_window_stack_add_window_to_workspace (sl_window_stack* restrict, size_t index, workspace_type workspace);
 void sl_window_stack_add_window_to_current_workspace (sl_window_stack* restrict, size_t index);
 void sl_window_stack_remove_window_from_its_workspace (sl_window_stack* restrict, size_t index);
 void sl_window_stack_add_workspace (sl_window_stack* restrict);
@@ -62,8 +82,15 @@ void sl_window_stack_set_raised_window (sl_window_stack* restrict, size_t index)
 void sl_window_stack_set_focused_window (sl_window_stack* restrict, size_t index);
 void sl_window_stack_set_focused_window_as_invalid (sl_window_stack* restrict);
 void sl_window_stack_set_current_workspace (sl_window_stack* restrict, workspace_type workspace);
+void sl_window_stack_clear_changes (sl_window_stack* restrict);
+void sl_window_stack_update_leader (sl_window_stack* restrict, size_t index);
+size_t sl_window_stack_raise_group (sl_window_stack* restrict, size_t index);
 
 sl_window* sl_window_stack_get_raised_window (sl_window_stack* restrict);
 sl_window* sl_window_stack_get_focused_window (sl_window_stack* restrict);
 size_t sl_window_stack_get_raised_window_index (sl_window_stack* restrict);
+size_t sl_window_stack_get_window_index (sl_window_stack* restrict, sl_window const*);
+size_t sl_window_stack_get_group_root (sl_window_stack* restrict, size_t index);
+size_t sl_window_stack_get_next_in_group (sl_window_stack* restrict, size_t root, size_t index);
+bool sl_window_stack_is_in_workspace (sl_window_stack* restrict, size_t index, workspace_type workspace);
 bool sl_window_stack_is_valid_index(size_t);
@@ -18,13 +18,17 @@
 
 #include "window.h"
 
+#include <limits.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
 
 #include "compiler-differences.h"
 #include "display.h"
+#include "property.h"
+#include "string-table.h"
 #include "window-mutable.h"
 
 #ifdef D_window_log
@@ -88,22 +92,103 @@ void sl_window_destroy (sl_window* window) {
   They are summarized in the table in Summary of Window Manager Property Types
 */
 
-static void window_set_text_property (sl_window* window, sl_display* display, Atom atom, struct sl_sized_string_mutable* sized_string) {
-	XTextProperty text_property;
+// fnv-1a over the type and the raw bytes, a title set again to the same text is neither copied nor converted
+static u64 text_hash (sl_property const* property) {
+	u64 hash = 0xcbf29ce484222325;
 
-	XGetTextProperty(display->x_display, window->x_window, &text_property, atom);
+	hash = (hash ^ property->type) * 0x100000001b3;
+	for (size_t i = 0; i < property->items_size; ++i)
+		hash = (hash ^ ((uchar const*)property->data)[i]) * 0x100000001b3;
 
-	if (sized_string->data) free(sized_string->data);
+	return hash;
+}
+
+static char* text_to_utf8 (sl_display* display, sl_property const* property, size_t* size) {
+	char* utf8;
+
+	if (property->type == display->atoms[type_utf8_string]) {
+		if ((utf8 = malloc(property->items_size + 1))) memcpy(utf8, property->data, property->items_size);
+		*size = property->items_size;
+	} else if (property->type == XA_STRING) {
+		// latin-1 maps one to one onto the first 256 code points
+		if ((utf8 = malloc(property->items_size * 2 + 1))) {
+			*size = 0;
+			for (size_t i = 0; i < property->items_size; ++i) {
+				uchar const c = ((uchar const*)property->data)[i];
+
+				if (c < 0x80) {
+					utf8[(*size)++] = c;
+				} else {
+					utf8[(*size)++] = 0xc0 | (c >> 6);
+					utf8[(*size)++] = 0x80 | (c & 0x3f);
+				}
+			}
+		}
+	} else {
+		// COMPOUND_TEXT and whatever else the locale knows about
+		XTextProperty const text_property = (XTextProperty) {.value = property->data, .encoding = property->type, .format = 8, .nitems = property->items_size};
+		char** list = NULL;
+		int list_size = 0;
+
+		if (Xutf8TextPropertyToTextList(display->x_display, &text_property, &list, &list_size) < Success || list_size == 0) {
+			if (list) XFreeStringList(list);
+			return NULL;
+		}
+
+		*size = strlen(list[0]);
+		if ((utf8 = malloc(*size + 1))) memcpy(utf8, list[0], *size);
+
+		XFreeStringList(list);
+	}
+
+	if (utf8) utf8[*size] = '\0';
+
+	return utf8;
+}
+
+// the longest prefix within D_title_size_limit that does not split a character
+static size_t utf8_cut (char const* utf8, size_t size) {
+	if (size <= D_title_size_limit) return size;
+
+	size = D_title_size_limit;
+	while (size > 0 && ((uchar)utf8[size] & 0xc0) == 0x80) --size;
 
-	sized_string->size = text_property.nitems;
-	if (sized_string->size == 0) {
-		sized_string->data = NULL;
+	return size;
+}
+
+static void window_set_text_property (sl_display* display, sl_property const* property, struct sl_sized_string_mutable* sized_string) {
+	u64 const hash = property->format == 8 && property->items_size != 0 ? text_hash(property) : 0;
+
+	if (hash == sized_string->hash) {
+		window_log("text unchanged");
 		return;
 	}
 
-	window_log("ignoring encoding and format");
-	sized_string->data = malloc(sizeof(uchar) * sized_string->size);
-	memcpy(sized_string->data, text_property.value, sized_string->size);
+	if (sized_string->data) free(sized_string->data);
+
+	*sized_string = (struct sl_sized_string_mutable) {};
+	if (hash == 0) return;
+
+	size_t size = 0;
+	char* const utf8 = text_to_utf8(display, property, &size);
+	if (!utf8) return;
+
+	size = utf8_cut(utf8, size);
+	utf8[size] = '\0';
+
+	*sized_string = (struct sl_sized_string_mutable) {.data = utf8, .size = size, .hash = hash};
+}
+
+static void window_name_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	window_set_text_property(display, property, (struct sl_sized_string_mutable*)&window->name);
+
+	window_log_va("[%lu] name: \"%.*s\"", window->x_window, (int)window->name.size, window->name.data);
+}
+
+static void window_icon_name_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	window_set_text_property(display, property, (struct sl_sized_string_mutable*)&window->icon_name);
+
+	window_log_va("[%lu] icon_name: \"%.*s\"", window->x_window, (int)window->icon_name.size, window->icon_name.data);
 }
 
 void sl_set_window_name (sl_window* window, sl_display* display) {
@@ -134,9 +219,7 @@ void sl_set_window_name (sl_window* window, sl_display* display) {
 	*/
 	window_log_va("[%lu] set window name", window->x_window);
 
-	window_set_text_property(window, display, XA_WM_NAME, (struct sl_sized_string_mutable*)&window->name);
-
-	window_log_va("[%lu] name: \"%.*s\"", window->x_window, (int)window->name.size, window->name.data);
+	sl_property_request(display, window->x_window, XA_WM_NAME, AnyPropertyType, true, &window_name_from_property);
 }
 
 void sl_set_window_icon_name (sl_window* window, sl_display* display) {
@@ -152,9 +235,98 @@ void sl_set_window_icon_name (sl_window* window, sl_display* display) {
 	*/
 	window_log_va("[%lu] set window icon name", window->x_window);
 
-	window_set_text_property(window, display, XA_WM_ICON_NAME, (struct sl_sized_string_mutable*)&window->icon_name);
+	sl_property_request(display, window->x_window, XA_WM_ICON_NAME, AnyPropertyType, true, &window_icon_name_from_property);
+}
 
-	window_log_va("[%lu] icon_name: \"%.*s\"", window->x_window, (int)window->icon_name.size, window->icon_name.data);
+static void window_normal_hints_from_property (sl_window* window, M_maybe_unused sl_display* display, sl_property const* property) {
+	XSizeHints size_hints = {};
+
+	// pre-ICCCM clients write only the first 15 fields, without base size and gravity
+	if (property->format == 32 && property->items_size >= 15) {
+		long const* const data = property->data;
+
+		size_hints = (XSizeHints) {
+		.flags = data[0],
+		.min_width = data[5],
+		.min_height = data[6],
+		.max_width = data[7],
+		.max_height = data[8],
+		.width_inc = data[9],
+		.height_inc = data[10],
+		.min_aspect = {data[11], data[12]},
+		.max_aspect = {data[13], data[14]}};
+
+		if (property->items_size >= 18) {
+			size_hints.base_width = data[15];
+			size_hints.base_height = data[16];
+			size_hints.win_gravity = data[17];
+		} else {
+			size_hints.flags &= ~(PBaseSize | PWinGravity);
+		}
+	}
+
+	window_log("ignoring user supplied");
+
+	((sl_window_mutable*)window)->normal_hints = (struct window_normal_hints) {
+	0, 0, 0, 0, 0, 0, {0, 0},
+        {0, 0},
+        0, 0, 0
+  };
+	// ^^^^^^^ epic clang-format ^^^^^^^
+
+	if (size_hints.flags & PMinSize && size_hints.flags & PBaseSize) {
+		((sl_window_mutable*)window)->normal_hints.min_width = size_hints.min_width;
+		((sl_window_mutable*)window)->normal_hints.min_height = size_hints.min_height;
+
+		((sl_window_mutable*)window)->normal_hints.base_width = size_hints.base_width;
+		((sl_window_mutable*)window)->normal_hints.base_height = size_hints.base_height;
+	} else if (size_hints.flags & PMinSize) {
+		((sl_window_mutable*)window)->normal_hints.min_width = size_hints.min_width;
+		((sl_window_mutable*)window)->normal_hints.min_height = size_hints.min_height;
+
+		((sl_window_mutable*)window)->normal_hints.base_width = size_hints.min_width;
+		((sl_window_mutable*)window)->normal_hints.base_height = size_hints.min_height;
+	} else if (size_hints.flags & PBaseSize) {
+		((sl_window_mutable*)window)->normal_hints.min_width = size_hints.base_width;
+		((sl_window_mutable*)window)->normal_hints.min_height = size_hints.base_height;
+
+		((sl_window_mutable*)window)->normal_hints.base_width = size_hints.base_width;
+		((sl_window_mutable*)window)->normal_hints.base_height = size_hints.base_height;
+	}
+
+	if (size_hints.flags & PMaxSize) {
+		((sl_window_mutable*)window)->normal_hints.max_width = size_hints.max_width;
+		((sl_window_mutable*)window)->normal_hints.max_height = size_hints.max_height;
+	}
+
+	if (size_hints.flags & PResizeInc) {
+		((sl_window_mutable*)window)->normal_hints.width_inc = size_hints.width_inc;
+		((sl_window_mutable*)window)->normal_hints.height_inc = size_hints.height_inc;
+	}
+
+	if (size_hints.flags & PAspect) {
+		((sl_window_mutable*)window)->normal_hints.min_aspect =
+		(struct window_normal_hints_aspect) {.numerator = size_hints.min_aspect.x, .denominator = size_hints.min_aspect.y};
+		((sl_window_mutable*)window)->normal_hints.max_aspect =
+		(struct window_normal_hints_aspect) {.numerator = size_hints.max_aspect.x, .denominator = size_hints.max_aspect.y};
+	}
+
+	if (size_hints.flags & PWinGravity) {
+		((sl_window_mutable*)window)->normal_hints.gravity = size_hints.win_gravity;
+	}
+
+	// a position the program chose for itself is no better than none, only the one the user asked for keeps the window from being placed
+	if (size_hints.flags & USPosition) window->flags |= window_user_position_bit;
+	else window->flags &= ~window_user_position_bit;
+
+	window_log_va(
+	"[%lu] window normal hints: min_width %u, min_height %u, max_width %u, max_height %u, width_inc %u, height_inc %u, min_aspect %u/%u, max_aspect "
+	"%u/%u, base_width %u, base_height %u, gravity %u",
+	window->x_window, window->normal_hints.min_width, window->normal_hints.min_height, window->normal_hints.max_width, window->normal_hints.max_height,
+	window->normal_hints.width_inc, window->normal_hints.height_inc, window->normal_hints.min_aspect.numerator,
+	window->normal_hints.min_aspect.denominator, window->normal_hints.max_aspect.numerator, window->normal_hints.max_aspect.denominator,
+	window->normal_hints.base_width, window->normal_hints.base_height, window->normal_hints.gravity
+	);
 }
 
 void sl_set_window_normal_hints (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -244,68 +416,43 @@ void sl_set_window_normal_hints (M_maybe_unused sl_window* window, M_maybe_unuse
 	*/
 	window_log_va("[%lu] set window normal hints", window->x_window);
 
-	XSizeHints size_hints;
-	long user_supplied;
-
-	XGetWMNormalHints(display->x_display, window->x_window, &size_hints, &user_supplied);
-
-	window_log("ignoring user supplied");
-
-	((sl_window_mutable*)window)->normal_hints = (struct window_normal_hints) {
-	0, 0, 0, 0, 0, 0, {0, 0},
-        {0, 0},
-        0, 0, 0
-  };
-	// ^^^^^^^ epic clang-format ^^^^^^^
-
-	if (size_hints.flags & PMinSize && size_hints.flags & PBaseSize) {
-		((sl_window_mutable*)window)->normal_hints.min_width = size_hints.min_width;
-		((sl_window_mutable*)window)->normal_hints.min_height = size_hints.min_height;
+	sl_property_request(display, window->x_window, XA_WM_NORMAL_HINTS, XA_WM_SIZE_HINTS, false, &window_normal_hints_from_property);
+}
 
-		((sl_window_mutable*)window)->normal_hints.base_width = size_hints.base_width;
-		((sl_window_mutable*)window)->normal_hints.base_height = size_hints.base_height;
-	} else if (size_hints.flags & PMinSize) {
-		((sl_window_mutable*)window)->normal_hints.min_width = size_hints.min_width;
-		((sl_window_mutable*)window)->normal_hints.min_height = size_hints.min_height;
+static void window_hints_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->flags |= window_hints_input_bit | window_state_normal_bit;
+	((sl_window_mutable*)window)->flags &= window_all_flags - (window_hints_urgent_bit | window_state_iconified_bit);
 
-		((sl_window_mutable*)window)->normal_hints.base_width = size_hints.min_width;
-		((sl_window_mutable*)window)->normal_hints.base_height = size_hints.min_height;
-	} else if (size_hints.flags & PBaseSize) {
-		((sl_window_mutable*)window)->normal_hints.min_width = size_hints.base_width;
-		((sl_window_mutable*)window)->normal_hints.min_height = size_hints.base_height;
+	// pre-ICCCM clients write only the first 8 fields, without the window group
+	if (property->format != 32 || property->items_size < 8) return;
 
-		((sl_window_mutable*)window)->normal_hints.base_width = size_hints.base_width;
-		((sl_window_mutable*)window)->normal_hints.base_height = size_hints.base_height;
-	}
+	long const* const data = property->data;
+	XWMHints const hints_data = (XWMHints) {.flags = data[0], .input = data[1], .initial_state = data[2]};
+	XWMHints const* const hints = &hints_data;
 
-	if (size_hints.flags & PMaxSize) {
-		((sl_window_mutable*)window)->normal_hints.max_width = size_hints.max_width;
-		((sl_window_mutable*)window)->normal_hints.max_height = size_hints.max_height;
-	}
+	window_log("ignoring some of the window's hints");
 
-	if (size_hints.flags & PResizeInc) {
-		((sl_window_mutable*)window)->normal_hints.width_inc = size_hints.width_inc;
-		((sl_window_mutable*)window)->normal_hints.height_inc = size_hints.height_inc;
-	}
+	if (!(hints->flags & InputHint)) ((sl_window_mutable*)window)->flags &= window_all_flags - window_hints_input_bit;
 
-	if (size_hints.flags & PAspect) {
-		((sl_window_mutable*)window)->normal_hints.min_aspect =
-		(struct window_normal_hints_aspect) {.numerator = size_hints.min_aspect.x, .denominator = size_hints.y};
-		((sl_window_mutable*)window)->normal_hints.max_aspect =
-		(struct window_normal_hints_aspect) {.numerator = size_hints.max_aspect.x, .denominator = size_hints.y};
+	if (hints->flags & StateHint) {
+		if (hints->initial_state == IconicState) {
+			((sl_window_mutable*)window)->flags &= window_all_flags - window_state_normal_bit;
+			((sl_window_mutable*)window)->flags |= window_state_iconified_bit;
+		}
 	}
+	if (hints->flags & 256) ((sl_window_mutable*)window)->flags |= window_hints_urgent_bit;
 
-	if (size_hints.flags & PWinGravity) {
-		((sl_window_mutable*)window)->normal_hints.gravity = size_hints.win_gravity;
+	Window const group = property->items_size > 8 && (hints->flags & WindowGroupHint) && (Window)data[8] != window->x_window ? (Window)data[8] : None;
+	if (group != window->group) {
+		((sl_window_mutable*)window)->group = group;
+		sl_window_stack_update_leader(
+		(sl_window_stack*)&display->window_stack, sl_window_stack_get_window_index((sl_window_stack*)&display->window_stack, window)
+		);
 	}
 
 	window_log_va(
-	"[%lu] window normal hints: min_width %u, min_height %u, max_width %u, max_height %u, width_inc %u, height_inc %u, min_aspect %u/%u, max_aspect "
-	"%u/%u, base_width %u, base_height %u, gravity %u",
-	window->x_window, window->normal_hints.min_width, window->normal_hints.min_height, window->normal_hints.max_width, window->normal_hints.max_height,
-	window->normal_hints.width_inc, window->normal_hints.height_inc, window->normal_hints.min_aspect.numerator,
-	window->normal_hints.min_aspect.denominator, window->normal_hints.max_aspect.numerator, window->normal_hints.max_aspect.denominator,
-	window->normal_hints.base_width, window->normal_hints.base_height, window->normal_hints.gravity
+	"[%lu] window hints: input %s, state %s, urgent %s", window->x_window, window->flags & window_hints_input_bit ? "true" : "false",
+	window->flags & window_state_normal_bit ? "normal" : "iconic", window->flags & window_hints_urgent_bit ? "true" : "false"
 	);
 }
 
@@ -450,31 +597,29 @@ void sl_set_window_hints (sl_window* window, sl_display* display) {
 	*/
 	window_log_va("[%lu] set window hints", window->x_window);
 
-	((sl_window_mutable*)window)->flags |= window_hints_input_bit | window_state_normal_bit;
-	((sl_window_mutable*)window)->flags &= window_all_flags - (window_hints_urgent_bit | window_state_iconified_bit);
+	sl_property_request(display, window->x_window, XA_WM_HINTS, XA_WM_HINTS, false, &window_hints_from_property);
+}
 
-	XWMHints* hints = XGetWMHints(display->x_display, window->x_window);
+static void window_class_from_property (sl_window* window, M_maybe_unused sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->instance = 0;
+	((sl_window_mutable*)window)->class = 0;
 
-	if (!hints) return;
+	if (property->format != 8 || property->items_size == 0) return;
 
-	window_log("ignoring some of the window's hints");
+	// the data always ends with a null byte, a class missing its own still stops there
+	char const* const instance = property->data;
+	size_t const instance_size = strlen(instance);
 
-	if (!(hints->flags & InputHint)) ((sl_window_mutable*)window)->flags &= window_all_flags - window_hints_input_bit;
+	((sl_window_mutable*)window)->instance = instance_size ? sl_intern(instance, instance_size) : 0;
 
-	if (hints->flags & StateHint) {
-		if (hints->initial_state == IconicState) {
-			((sl_window_mutable*)window)->flags &= window_all_flags - window_state_normal_bit;
-			((sl_window_mutable*)window)->flags |= window_state_iconified_bit;
-		}
-	}
-	if (hints->flags & 256) ((sl_window_mutable*)window)->flags |= window_hints_urgent_bit;
+	if (instance_size + 1 < property->items_size) {
+		char const* const class = instance + instance_size + 1;
+		size_t const class_size = strlen(class);
 
-	XFree(hints);
+		((sl_window_mutable*)window)->class = class_size ? sl_intern(class, class_size) : 0;
+	}
 
-	window_log_va(
-	"[%lu] window hints: input %s, state %s, urgent %s", window->x_window, window->flags & window_hints_input_bit ? "true" : "false",
-	window->flags & window_state_normal_bit ? "normal" : "iconic", window->flags & window_hints_urgent_bit ? "true" : "false"
-	);
+	window_log_va("[%lu] class: %s %s", window->x_window, sl_interned_string(window->instance), sl_interned_string(window->class));
 }
 
 void sl_set_window_class (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -517,10 +662,24 @@ void sl_set_window_class (M_maybe_unused sl_window* window, M_maybe_unused sl_di
 	*/
 	window_log_va("[%lu] set window class", window->x_window);
 
-	window_log("todo: wm_window_class");
+	sl_property_request(display, window->x_window, XA_WM_CLASS, XA_STRING, false, &window_class_from_property);
+}
+
+static void window_transient_for_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	Window const transient_for =
+	property->format == 32 && property->items_size >= 1 && *(Window const*)property->data != window->x_window ? *(Window const*)property->data : None;
+
+	window_log_va("[%lu] transient for %lu", window->x_window, transient_for);
+
+	if (transient_for == window->transient_for) return;
+
+	((sl_window_mutable*)window)->transient_for = transient_for;
+	sl_window_stack_update_leader(
+	(sl_window_stack*)&display->window_stack, sl_window_stack_get_window_index((sl_window_stack*)&display->window_stack, window)
+	);
 }
 
-void sl_set_window_transient_for (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
+void sl_set_window_transient_for (sl_window* window, sl_display* display) {
 	/*
 	  The WM_TRANSIENT_FOR property (of type WINDOW) contains the ID of another
 	  top-level window. The implication is that this window is a pop-up on behalf of
@@ -540,7 +699,55 @@ void sl_set_window_transient_for (M_maybe_unused sl_window* window, M_maybe_unus
 	*/
 	window_log_va("[%lu] set window transient for", window->x_window);
 
-	window_log("todo: wm_transient_for");
+	sl_property_request(display, window->x_window, XA_WM_TRANSIENT_FOR, XA_WINDOW, false, &window_transient_for_from_property);
+}
+
+static void window_sync_request_counter_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	// a client that lists the protocol without the counter is resized without waiting
+	XID const counter = property->format == 32 && property->items_size >= 1 ? *(long const*)property->data : None;
+
+	sl_sync_resize_set_counter(display, window->x_window, counter);
+}
+
+static void window_protocols_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->flags &= window_all_flags - (window_protocols_take_focus_bit | window_protocols_delete_window_bit | window_protocols_sync_request_bit);
+
+	Atom const* const protocols = property->data;
+
+	for (size_t i = 0; property->format == 32 && i < property->items_size; ++i) {
+		if (protocols[i] == display->atoms[wm_take_focus]) {
+			((sl_window_mutable*)window)->flags |= window_protocols_take_focus_bit;
+			continue;
+		}
+
+		if (protocols[i] == display->atoms[wm_delete_window]) {
+			((sl_window_mutable*)window)->flags |= window_protocols_delete_window_bit;
+			continue;
+		}
+
+		if (protocols[i] == display->atoms[net_wm_sync_request]) {
+			((sl_window_mutable*)window)->flags |= window_protocols_sync_request_bit;
+			continue;
+		}
+
+		if (protocols[i] == display->atoms[net_wm_ping]) warn_log("net wm ping");
+		if (protocols[i] == display->atoms[net_wm_fullscreen_monitors]) warn_log("net wm fullscreen monitors");
+	}
+
+	window_log_va(
+	"[%lu] window protocols: %s", window->x_window,
+	window->flags & window_protocols_take_focus_bit ?
+	(window->flags & window_protocols_delete_window_bit ? "take focus and delete window" : "take focus") :
+	window->flags & window_protocols_delete_window_bit ? "delete window" :
+	                                                     "none"
+	);
+
+	if (window->flags & window_protocols_sync_request_bit)
+		sl_property_request(
+		display, window->x_window, display->atoms[net_wm_sync_request_counter], XA_CARDINAL, false, &window_sync_request_counter_from_property
+		);
+	else
+		sl_sync_resize_set_counter(display, window->x_window, None);
 }
 
 void sl_set_window_protocols (sl_window* window, sl_display* display) {
@@ -570,38 +777,7 @@ void sl_set_window_protocols (sl_window* window, sl_display* display) {
 	*/
 	window_log_va("[%lu] set window protocols", window->x_window);
 
-	Atom* protocols = NULL;
-	int n = 0;
-
-	((sl_window_mutable*)window)->flags &= window_all_flags - (window_protocols_take_focus_bit | window_protocols_delete_window_bit);
-
-	if (!XGetWMProtocols(display->x_display, window->x_window, &protocols, &n)) return;
-
-	for (size_t i = 0; i <= (size_t)n; ++i) {
-		if (protocols[i] == display->atoms[wm_take_focus]) {
-			((sl_window_mutable*)window)->flags |= window_protocols_take_focus_bit;
-			continue;
-		}
-
-		if (protocols[i] == display->atoms[wm_delete_window]) {
-			((sl_window_mutable*)window)->flags |= window_protocols_delete_window_bit;
-			continue;
-		}
-
-		if (protocols[i] == display->atoms[net_wm_ping]) warn_log("net wm ping");
-		if (protocols[i] == display->atoms[net_wm_sync_request]) warn_log("net wm sync request");
-		if (protocols[i] == display->atoms[net_wm_fullscreen_monitors]) warn_log("net wm fullscreen monitors");
-	}
-
-	XFree(protocols);
-
-	window_log_va(
-	"[%lu] window protocols: %s", window->x_window,
-	window->flags & window_protocols_take_focus_bit ?
-	(window->flags & window_protocols_delete_window_bit ? "take focus and delete window" : "take focus") :
-	window->flags & window_protocols_delete_window_bit ? "delete window" :
-	                                                     "none"
-	);
+	sl_property_request(display, window->x_window, display->atoms[wm_protocols], XA_ATOM, false, &window_protocols_from_property);
 }
 
 void sl_set_window_colormap_windows (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -618,6 +794,33 @@ void sl_set_window_colormap_windows (M_maybe_unused sl_window* window, M_maybe_u
 	window_log("todo: wm_window_colormap_windows");
 }
 
+static void window_update_pid (sl_window* window) {
+	// a pid is only meaningful on the machine it comes from, the one of a remote or forwarded client names some unrelated local process
+	((sl_window_mutable*)window)->pid = window->flags & window_client_machine_local_bit ? window->net_wm_pid : 0;
+}
+
+static void window_client_machine_from_property (sl_window* window, M_maybe_unused sl_display* display, sl_property const* property) {
+	char hostname[HOST_NAME_MAX + 1];
+	bool local = false;
+
+	if (property->format == 8 && property->items_size > 0 && gethostname(hostname, sizeof(hostname)) == 0) {
+		hostname[HOST_NAME_MAX] = '\0';
+		size_t const size = strlen(hostname);
+
+		// EWMH asks for the fully-qualified name, gethostname usually gives the short one
+		local = size > 0 && property->items_size >= size && memcmp(property->data, hostname, size) == 0 &&
+		        (property->items_size == size || ((char const*)property->data)[size] == '.');
+	}
+
+	((sl_window_mutable*)window)->flags &= window_all_flags - window_client_machine_local_bit;
+	if (local) ((sl_window_mutable*)window)->flags |= window_client_machine_local_bit;
+
+	window_update_pid(window);
+
+	window_log_va("[%lu] client machine \"%.*s\" is %s", window->x_window, property->format == 8 ? (int)property->items_size : 0,
+	              property->format == 8 ? (char const*)property->data : "", local ? "local" : "remote");
+}
+
 void sl_set_window_client_machine (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
 	/*
 	  The client should set the WM_CLIENT_MACHINE property (of one of the TEXT
@@ -626,96 +829,35 @@ void sl_set_window_client_machine (M_maybe_unused sl_window* window, M_maybe_unu
 	*/
 	window_log_va("[%lu] set window client machine", window->x_window);
 
-	window_log("todo: wm_client_machine");
+	sl_property_request(display, window->x_window, XA_WM_CLIENT_MACHINE, AnyPropertyType, true, &window_client_machine_from_property);
 }
 
 /*
   Extended Window Manager Hints: Application Window Properties
 */
 
-static void
-window_set_net_utf8_string_property (sl_window* window, sl_display* display, size_t atom_index, struct sl_sized_string_mutable* sized_string) {
-	Atom actual_type;
-	int actual_format;
-	ulong items_size;
-	ulong bytes_after;
-	uchar* prop = NULL;
-
-	if (XGetWindowProperty(display->x_display, window->x_window, display->atoms[atom_index], 0, 1, false, display->atoms[type_utf8_string], &actual_type, &actual_format, &items_size, &bytes_after, &prop) != Success) {
-		window_log("XGetWindowProperty does not return Success");
-		return;
-	}
-
-	/*
-	  The XGetWindowProperty function returns the actual type of the property; the actual
-	  format of the property; the number of 8-bit, 16-bit, or 32-bit items transferred; the
-	  number of bytes remaining to be read in the property; and a pointer to the data
-	  actually returned. XGetWindowProperty sets the return arguments as follows:
-	*/
-
-	/*
-	  If the specified property does not exist for the specified window,
-	  XGetWindowProperty returns None to actual_type_return and the value zero
-	  to actual_format_return and bytes_after_return. The nitems_return argument is
-	  empty. In this case, the delete argument is ignored.
-	*/
-
-	if (actual_type == None) {
-		window_log("empty property");
-		XFree(prop);
-		return;
-	}
+static void window_net_wm_name_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	window_set_text_property(display, property, (struct sl_sized_string_mutable*)&window->net_wm_name);
 
-	/*
-	  If the specified property exists but its type does not match the specified type,
-	  XGetWindowProperty returns the actual property type to actual_type_return, the
-	  actual property format (never zero) to actual_format_return, and the property
-	  length in bytes (even if the actual_format_return is 16 or 32) to bytes_after_return.
-	  It also ignores the delete argument. The nitems_return argument is empty.
-	*/
-
-	if (actual_type != display->atoms[type_utf8_string]) {
-		window_log("atom type mismatch");
-		XFree(prop);
-		return;
-	}
-
-	/*
-	  If the specified property exists and either you assign AnyPropertyType to the
-	  req_type argument or the specified type matches the actual property type,
-	  XGetWindowProperty returns the actual property type to actual_type_return and
-	  the actual property format (never zero) to actual_format_return. It also returns a
-	  value to bytes_after_return and nitems_return, by defining the following values:
-
-	  • N = actual length of the stored property in bytes (even if the format is 16 or 32)
-	  I = 4 * long_offset T = N - I L = MINIMUM(T, 4 * long_length) A = N - (I + L)
-
-	  • The returned value starts at byte index I in the property (indexing from zero),
-	  and its length in bytes is L. If the value for long_offset causes L to be negative,
-	  a BadValue error results. The value of bytes_after_return is A, giving the number
-	  of trailing unread bytes in the stored property.
-	*/
+	window_log_va("[%lu] net_wm_name \"%.*s\"", window->x_window, (int)window->net_wm_name.size, window->net_wm_name.data);
+}
 
-	XFree(prop);
+static void window_net_wm_visible_name_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	window_set_text_property(display, property, (struct sl_sized_string_mutable*)&window->net_wm_visible_name);
 
-	XGetWindowProperty(
-	display->x_display, window->x_window, display->atoms[atom_index], 0, 2 + (bytes_after >> 2), false, display->atoms[type_utf8_string], &actual_type,
-	&actual_format, &items_size, &bytes_after, &prop
-	);
+	window_log_va("[%lu] net_wm_visible_name \"%.*s\"", window->x_window, (int)window->net_wm_visible_name.size, window->net_wm_visible_name.data);
+}
 
-	if (sized_string->data) free(sized_string->data);
+static void window_net_wm_icon_name_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	window_set_text_property(display, property, (struct sl_sized_string_mutable*)&window->net_wm_icon_name);
 
-	sized_string->size = items_size;
-	if (sized_string->size == 0) {
-		sized_string->data = NULL;
-		XFree(prop);
-		return;
-	}
+	window_log_va("[%lu] net_wm_icon_name \"%.*s\"", window->x_window, (int)window->net_wm_icon_name.size, window->net_wm_icon_name.data);
+}
 
-	sized_string->data = malloc(sizeof(uchar) * sized_string->size);
-	memcpy(sized_string->data, prop, sized_string->size);
+static void window_net_wm_visible_icon_name_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	window_set_text_property(display, property, (struct sl_sized_string_mutable*)&window->net_wm_visible_icon_name);
 
-	XFree(prop);
+	window_log_va("[%lu] net_wm_visible_icon_name \"%.*s\"", window->x_window, (int)window->net_wm_visible_icon_name.size, window->net_wm_visible_icon_name.data);
 }
 
 void sl_window_set_net_wm_name (sl_window* window, sl_display* display) {
@@ -726,9 +868,7 @@ void sl_window_set_net_wm_name (sl_window* window, sl_display* display) {
 	*/
 	window_log_va("[%lu] set window net wm name", window->x_window);
 
-	window_set_net_utf8_string_property(window, display, net_wm_name, (struct sl_sized_string_mutable*)&window->net_wm_name);
-
-	window_log_va("[%lu] net_wm_name \"%.*s\"", window->x_window, (int)window->net_wm_name.size, window->net_wm_name.data);
+	sl_property_request(display, window->x_window, display->atoms[net_wm_name], display->atoms[type_utf8_string], true, &window_net_wm_name_from_property);
 }
 
 void sl_window_set_net_wm_visible_name (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -743,9 +883,7 @@ void sl_window_set_net_wm_visible_name (M_maybe_unused sl_window* window, M_mayb
 	*/
 	window_log_va("[%lu] set window net wm visible name", window->x_window);
 
-	window_set_net_utf8_string_property(window, display, net_wm_visible_name, (struct sl_sized_string_mutable*)&window->net_wm_visible_name);
-
-	window_log_va("[%lu] net_wm_visible_name \"%.*s\"", window->x_window, (int)window->net_wm_visible_name.size, window->net_wm_visible_name.data);
+	sl_property_request(display, window->x_window, display->atoms[net_wm_visible_name], display->atoms[type_utf8_string], true, &window_net_wm_visible_name_from_property);
 }
 
 void sl_window_set_net_wm_icon_name (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -757,9 +895,7 @@ void sl_window_set_net_wm_icon_name (M_maybe_unused sl_window* window, M_maybe_u
 	*/
 	window_log_va("[%lu] set window net wm icon name", window->x_window);
 
-	window_set_net_utf8_string_property(window, display, net_wm_icon_name, (struct sl_sized_string_mutable*)&window->net_wm_icon_name);
-
-	window_log_va("[%lu] net_wm_icon_name \"%.*s\"", window->x_window, (int)window->net_wm_icon_name.size, window->net_wm_icon_name.data);
+	sl_property_request(display, window->x_window, display->atoms[net_wm_icon_name], display->atoms[type_utf8_string], true, &window_net_wm_icon_name_from_property);
 }
 
 void sl_window_set_net_wm_visible_icon_name (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -771,11 +907,7 @@ void sl_window_set_net_wm_visible_icon_name (M_maybe_unused sl_window* window, M
 	*/
 	window_log_va("[%lu] set window net wm visible icon name", window->x_window);
 
-	window_set_net_utf8_string_property(window, display, net_wm_visible_icon_name, (struct sl_sized_string_mutable*)&window->net_wm_visible_icon_name);
-
-	window_log_va(
-	"[%lu] net_wm_visible_icon_name \"%.*s\"", window->x_window, (int)window->net_wm_visible_icon_name.size, window->net_wm_visible_icon_name.data
-	);
+	sl_property_request(display, window->x_window, display->atoms[net_wm_visible_icon_name], display->atoms[type_utf8_string], true, &window_net_wm_visible_icon_name_from_property);
 }
 
 void sl_window_set_net_wm_desktop (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -811,71 +943,28 @@ void sl_window_set_net_wm_desktop (M_maybe_unused sl_window* window, M_maybe_unu
 	window_log("todo: _net_wm_desktop");
 }
 
-static int get_net_atom_list (sl_window* window, sl_display* display, size_t atom_index, uchar** prop, ulong* items_size) {
-	Atom actual_type;
-	int actual_format;
-	ulong bytes_after;
-
-	if (XGetWindowProperty(display->x_display, window->x_window, display->atoms[atom_index], 0, 1, false, XA_ATOM, &actual_type, &actual_format, items_size, &bytes_after, prop) != Success) {
-		window_log("XGetWindowProperty does not return Success");
-		return -1;
-	}
-
-	/*
-	  The XGetWindowProperty function returns the actual type of the property; the actual
-	  format of the property; the number of 8-bit, 16-bit, or 32-bit items transferred; the
-	  number of bytes remaining to be read in the property; and a pointer to the data
-	  actually returned. XGetWindowProperty sets the return arguments as follows:
-	*/
-
-	/*
-	  If the specified property does not exist for the specified window,
-	  XGetWindowProperty returns None to actual_type_return and the value zero
-	  to actual_format_return and bytes_after_return. The nitems_return argument is
-	  empty. In this case, the delete argument is ignored.
-	*/
-
-	if (actual_type == None) {
-		window_log("empty property");
-		XFree(*prop);
-		return -1;
-	}
-
-	/*
-	  If the specified property exists but its type does not match the specified type,
-	  XGetWindowProperty returns the actual property type to actual_type_return, the
-	  actual property format (never zero) to actual_format_return, and the property
-	  length in bytes (even if the actual_format_return is 16 or 32) to bytes_after_return.
-	  It also ignores the delete argument. The nitems_return argument is empty.
-	*/
+static void window_net_wm_window_type_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->flags &= window_all_flags - window_all_types;
+	((sl_window_mutable*)window)->flags |= sl_atom_list_to_flags(display, property->data, property->format == 32 ? property->items_size : 0, window_all_types);
 
-	if (actual_type != XA_ATOM) {
-		window_log("atom type mismatch");
-		XFree(*prop);
-		return -1;
-	}
+	char buffer[256] = "";
 
-	/*
-	  If the specified property exists and either you assign AnyPropertyType to the
-	  req_type argument or the specified type matches the actual property type,
-	  XGetWindowProperty returns the actual property type to actual_type_return and
-	  the actual property format (never zero) to actual_format_return. It also returns a
-	  value to bytes_after_return and nitems_return, by defining the following values:
-
-	  • N = actual length of the stored property in bytes (even if the format is 16 or 32)
-	  I = 4 * long_offset T = N - I L = MINIMUM(T, 4 * long_length) A = N - (I + L)
-
-	  • The returned value starts at byte index I in the property (indexing from zero),
-	  and its length in bytes is L. If the value for long_offset causes L to be negative,
-	  a BadValue error results. The value of bytes_after_return is A, giving the number
-	  of trailing unread bytes in the stored property.
-	*/
+	if (window->flags & window_type_desktop_bit) strcat(buffer, "desktop ");
+	if (window->flags & window_type_dock_bit) strcat(buffer, "dock ");
+	if (window->flags & window_type_toolbar_bit) strcat(buffer, "toolbar ");
+	if (window->flags & window_type_menu_bit) strcat(buffer, "menu ");
+	if (window->flags & window_type_utility_bit) strcat(buffer, "utility ");
+	if (window->flags & window_type_splash_bit) strcat(buffer, "splash ");
+	if (window->flags & window_type_dialog_bit) strcat(buffer, "dialog ");
+	if (window->flags & window_type_dropdown_menu_bit) strcat(buffer, "dropdown_menu ");
+	if (window->flags & window_type_popup_menu_bit) strcat(buffer, "popup_menu ");
+	if (window->flags & window_type_tooltip_bit) strcat(buffer, "tooltip ");
+	if (window->flags & window_type_notification_bit) strcat(buffer, "notification ");
+	if (window->flags & window_type_combo_bit) strcat(buffer, "combo ");
+	if (window->flags & window_type_dnd_bit) strcat(buffer, "dnd ");
+	if (window->flags & window_type_normal_bit) strcat(buffer, "normal ");
 
-	XGetWindowProperty(
-	display->x_display, window->x_window, display->atoms[atom_index], 0, 2 + (bytes_after >> 2), false, XA_ATOM, &actual_type, &actual_format,
-	items_size, &bytes_after, prop
-	);
-	return 0;
+	window_log_va("[%lu] window type: %s", window->x_window, buffer);
 }
 
 void sl_window_set_net_wm_window_type (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -956,50 +1045,31 @@ void sl_window_set_net_wm_window_type (M_maybe_unused sl_window* window, M_maybe
 	*/
 	window_log_va("[%lu] set window net wm window type", window->x_window);
 
-	Atom* prop = NULL;
-	ulong items_size;
-
-	((sl_window_mutable*)window)->flags &= window_all_flags - window_all_types;
-
-	if (get_net_atom_list(window, display, net_wm_window_type, (uchar**)&prop, &items_size) != 0) return;
-
-	for (size_t i = 0; i < items_size; ++i) {
-		if (prop[i] == display->atoms[net_wm_window_type_desktop]) ((sl_window_mutable*)window)->flags |= window_type_desktop_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_dock]) ((sl_window_mutable*)window)->flags |= window_type_dock_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_toolbar]) ((sl_window_mutable*)window)->flags |= window_type_toolbar_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_menu]) ((sl_window_mutable*)window)->flags |= window_type_menu_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_utility]) ((sl_window_mutable*)window)->flags |= window_type_utility_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_splash]) ((sl_window_mutable*)window)->flags |= window_type_splash_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_dialog]) ((sl_window_mutable*)window)->flags |= window_type_dialog_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_dropdown_menu]) ((sl_window_mutable*)window)->flags |= window_type_dropdown_menu_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_popup_menu]) ((sl_window_mutable*)window)->flags |= window_type_popup_menu_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_tooltip]) ((sl_window_mutable*)window)->flags |= window_type_tooltip_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_notification]) ((sl_window_mutable*)window)->flags |= window_type_notification_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_combo]) ((sl_window_mutable*)window)->flags |= window_type_combo_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_dnd]) ((sl_window_mutable*)window)->flags |= window_type_dnd_bit;
-		if (prop[i] == display->atoms[net_wm_window_type_normal]) ((sl_window_mutable*)window)->flags |= window_type_normal_bit;
-	}
+	sl_property_request(display, window->x_window, display->atoms[net_wm_window_type], XA_ATOM, false, &window_net_wm_window_type_from_property);
+}
 
-	XFree(prop);
+static void window_net_wm_state_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->flags &= window_all_flags - window_all_net_states;
+	((sl_window_mutable*)window)->flags |= sl_atom_list_to_flags(display, property->data, property->format == 32 ? property->items_size : 0, window_all_net_states);
+	((sl_window_mutable*)window)->published_net_wm_state = window->flags & window_all_net_states; // the list on the server, as far as our flags can tell
 
 	char buffer[256] = "";
 
-	if (window->flags & window_type_desktop_bit) strcat(buffer, "desktop ");
-	if (window->flags & window_type_dock_bit) strcat(buffer, "dock ");
-	if (window->flags & window_type_toolbar_bit) strcat(buffer, "toolbar ");
-	if (window->flags & window_type_menu_bit) strcat(buffer, "menu ");
-	if (window->flags & window_type_utility_bit) strcat(buffer, "utility ");
-	if (window->flags & window_type_splash_bit) strcat(buffer, "splash ");
-	if (window->flags & window_type_dialog_bit) strcat(buffer, "dialog ");
-	if (window->flags & window_type_dropdown_menu_bit) strcat(buffer, "dropdown_menu ");
-	if (window->flags & window_type_popup_menu_bit) strcat(buffer, "popup_menu ");
-	if (window->flags & window_type_tooltip_bit) strcat(buffer, "tooltip ");
-	if (window->flags & window_type_notification_bit) strcat(buffer, "notification ");
-	if (window->flags & window_type_combo_bit) strcat(buffer, "combo ");
-	if (window->flags & window_type_dnd_bit) strcat(buffer, "dnd ");
-	if (window->flags & window_type_normal_bit) strcat(buffer, "normal ");
+	if (window->flags & window_state_modal_bit) strcat(buffer, "modal ");
+	if (window->flags & window_state_sticky_bit) strcat(buffer, "sticky ");
+	if (window->flags & window_state_maximized_vert_bit) strcat(buffer, "maximized_vert ");
+	if (window->flags & window_state_maximized_horz_bit) strcat(buffer, "maximized_horz ");
+	if (window->flags & window_state_shaded_bit) strcat(buffer, "shaded ");
+	if (window->flags & window_state_skip_taskbar_bit) strcat(buffer, "skip_taskbar ");
+	if (window->flags & window_state_skip_pager_bit) strcat(buffer, "skip_pager ");
+	if (window->flags & window_state_hidden_bit) strcat(buffer, "hidden ");
+	if (window->flags & window_state_fullscreen_bit) strcat(buffer, "fullscreen ");
+	if (window->flags & window_state_above_bit) strcat(buffer, "above ");
+	if (window->flags & window_state_below_bit) strcat(buffer, "below ");
+	if (window->flags & window_state_demands_attention_bit) strcat(buffer, "demands_attention ");
+	if (window->flags & window_state_focused_bit) strcat(buffer, "focused ");
 
-	window_log_va("[%lu] window type: %s", window->x_window, buffer);
+	window_log_va("[%lu] window state: %s", window->x_window, buffer);
 }
 
 void sl_window_set_net_wm_state (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1108,48 +1178,29 @@ void sl_window_set_net_wm_state (M_maybe_unused sl_window* window, M_maybe_unuse
 	*/
 	window_log_va("[%lu] set window net wm state", window->x_window);
 
-	Atom* prop = NULL;
-	ulong items_size;
-
-	((sl_window_mutable*)window)->flags &= window_all_flags - window_all_states;
-
-	if (get_net_atom_list(window, display, net_wm_state, (uchar**)&prop, &items_size) != 0) return;
-
-	for (size_t i = 0; i < items_size; ++i) {
-		if (prop[i] == display->atoms[net_wm_state_modal]) ((sl_window_mutable*)window)->flags |= window_state_modal_bit;
-		if (prop[i] == display->atoms[net_wm_state_sticky]) ((sl_window_mutable*)window)->flags |= window_state_sticky_bit;
-		if (prop[i] == display->atoms[net_wm_state_maximized_vert]) ((sl_window_mutable*)window)->flags |= window_state_maximized_vert_bit;
-		if (prop[i] == display->atoms[net_wm_state_maximized_horz]) ((sl_window_mutable*)window)->flags |= window_state_maximized_horz_bit;
-		if (prop[i] == display->atoms[net_wm_state_shaded]) ((sl_window_mutable*)window)->flags |= window_state_shaded_bit;
-		if (prop[i] == display->atoms[net_wm_state_skip_taskbar]) ((sl_window_mutable*)window)->flags |= window_state_skip_taskbar_bit;
-		if (prop[i] == display->atoms[net_wm_state_skip_pager]) ((sl_window_mutable*)window)->flags |= window_state_skip_pager_bit;
-		if (prop[i] == display->atoms[net_wm_state_hidden]) ((sl_window_mutable*)window)->flags |= window_state_hidden_bit;
-		if (prop[i] == display->atoms[net_wm_state_fullscreen]) ((sl_window_mutable*)window)->flags |= window_state_fullscreen_bit;
-		if (prop[i] == display->atoms[net_wm_state_above]) ((sl_window_mutable*)window)->flags |= window_state_above_bit;
-		if (prop[i] == display->atoms[net_wm_state_below]) ((sl_window_mutable*)window)->flags |= window_state_below_bit;
-		if (prop[i] == display->atoms[net_wm_state_demands_attention]) ((sl_window_mutable*)window)->flags |= window_state_demands_attention_bit;
-		if (prop[i] == display->atoms[net_wm_state_focused]) ((sl_window_mutable*)window)->flags |= window_state_focused_bit;
-	}
+	sl_property_request(display, window->x_window, display->atoms[net_wm_state], XA_ATOM, false, &window_net_wm_state_from_property);
+}
 
-	XFree(prop);
+static void window_net_wm_allowed_actions_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->flags &= window_all_flags - window_all_allowed_actions;
+	((sl_window_mutable*)window)->flags |= sl_atom_list_to_flags(display, property->data, property->format == 32 ? property->items_size : 0, window_all_allowed_actions);
 
 	char buffer[256] = "";
 
-	if (window->flags & window_state_modal_bit) strcat(buffer, "modal ");
-	if (window->flags & window_state_sticky_bit) strcat(buffer, "sticky ");
-	if (window->flags & window_state_maximized_vert_bit) strcat(buffer, "maximized_vert ");
-	if (window->flags & window_state_maximized_horz_bit) strcat(buffer, "maximized_horz ");
-	if (window->flags & window_state_shaded_bit) strcat(buffer, "shaded ");
-	if (window->flags & window_state_skip_taskbar_bit) strcat(buffer, "skip_taskbar ");
-	if (window->flags & window_state_skip_pager_bit) strcat(buffer, "skip_pager ");
-	if (window->flags & window_state_hidden_bit) strcat(buffer, "hidden ");
-	if (window->flags & window_state_fullscreen_bit) strcat(buffer, "fullscreen ");
-	if (window->flags & window_state_above_bit) strcat(buffer, "above ");
-	if (window->flags & window_state_below_bit) strcat(buffer, "below ");
-	if (window->flags & window_state_demands_attention_bit) strcat(buffer, "demands_attention ");
-	if (window->flags & window_state_focused_bit) strcat(buffer, "focused ");
+	if (window->flags & window_allowed_action_move_bit) strcat(buffer, "move ");
+	if (window->flags & window_allowed_action_resize_bit) strcat(buffer, "resize ");
+	if (window->flags & window_allowed_action_minimize_bit) strcat(buffer, "minimize ");
+	if (window->flags & window_allowed_action_shade_bit) strcat(buffer, "shade ");
+	if (window->flags & window_allowed_action_stick_bit) strcat(buffer, "stick ");
+	if (window->flags & window_allowed_action_maximize_horz_bit) strcat(buffer, "maximize_horz ");
+	if (window->flags & window_allowed_action_maximize_vert_bit) strcat(buffer, "maximize_vert ");
+	if (window->flags & window_allowed_action_fullscreen_bit) strcat(buffer, "fullscreen ");
+	if (window->flags & window_allowed_action_change_desktop_bit) strcat(buffer, "change_desktop ");
+	if (window->flags & window_allowed_action_close_bit) strcat(buffer, "close ");
+	if (window->flags & window_allowed_action_above_bit) strcat(buffer, "above ");
+	if (window->flags & window_allowed_action_below_bit) strcat(buffer, "below ");
 
-	window_log_va("[%lu] window state: %s", window->x_window, buffer);
+	window_log_va("[%lu] allowed actions: %s", window->x_window, buffer);
 }
 
 void sl_window_set_net_wm_allowed_actions (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1216,46 +1267,26 @@ void sl_window_set_net_wm_allowed_actions (M_maybe_unused sl_window* window, M_m
 	*/
 	window_log_va("[%lu] set window net wm allowed actions", window->x_window);
 
-	Atom* prop = NULL;
-	ulong items_size;
+	sl_property_request(display, window->x_window, display->atoms[net_wm_allowed_actions], XA_ATOM, false, &window_net_wm_allowed_actions_from_property);
+}
 
-	((sl_window_mutable*)window)->flags &= window_all_flags - window_all_allowed_actions;
+static void window_net_wm_strut_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	if (sl_workarea_has_partial_strut(&display->workarea, window->x_window)) return;
 
-	if (get_net_atom_list(window, display, net_wm_allowed_actions, (uchar**)&prop, &items_size) != 0) return;
-
-	for (size_t i = 0; i < items_size; ++i) {
-		if (prop[i] == display->atoms[net_wm_action_move]) ((sl_window_mutable*)window)->flags |= window_allowed_action_move_bit;
-		if (prop[i] == display->atoms[net_wm_action_resize]) ((sl_window_mutable*)window)->flags |= window_allowed_action_resize_bit;
-		if (prop[i] == display->atoms[net_wm_action_minimize]) ((sl_window_mutable*)window)->flags |= window_allowed_action_minimize_bit;
-		if (prop[i] == display->atoms[net_wm_action_shade]) ((sl_window_mutable*)window)->flags |= window_allowed_action_shade_bit;
-		if (prop[i] == display->atoms[net_wm_action_stick]) ((sl_window_mutable*)window)->flags |= window_allowed_action_stick_bit;
-		if (prop[i] == display->atoms[net_wm_action_maximize_horz]) ((sl_window_mutable*)window)->flags |= window_allowed_action_maximize_horz_bit;
-		if (prop[i] == display->atoms[net_wm_action_maximize_vert]) ((sl_window_mutable*)window)->flags |= window_allowed_action_maximize_vert_bit;
-		if (prop[i] == display->atoms[net_wm_action_fullscreen]) ((sl_window_mutable*)window)->flags |= window_allowed_action_fullscreen_bit;
-		if (prop[i] == display->atoms[net_wm_action_change_desktop]) ((sl_window_mutable*)window)->flags |= window_allowed_action_change_desktop_bit;
-		if (prop[i] == display->atoms[net_wm_action_close]) ((sl_window_mutable*)window)->flags |= window_allowed_action_close_bit;
-		if (prop[i] == display->atoms[net_wm_action_above]) ((sl_window_mutable*)window)->flags |= window_allowed_action_above_bit;
-		if (prop[i] == display->atoms[net_wm_action_below]) ((sl_window_mutable*)window)->flags |= window_allowed_action_below_bit;
-	}
+	u32 values[M_strut_values_size] = {};
 
-	XFree(prop);
+	if (property->format == 32 && property->items_size >= struts_size) {
+		for (u8 i = 0; i < struts_size; ++i)
+			values[i] = ((long*)property->data)[i];
 
-	char buffer[256] = "";
+		// the whole length of every edge
+		values[strut_left * 2 + 5] = values[strut_right * 2 + 5] = display->dimensions.height - 1;
+		values[strut_top * 2 + 5] = values[strut_bottom * 2 + 5] = display->dimensions.width - 1;
+	}
 
-	if (window->flags & window_allowed_action_move_bit) strcat(buffer, "move ");
-	if (window->flags & window_allowed_action_resize_bit) strcat(buffer, "resize ");
-	if (window->flags & window_allowed_action_minimize_bit) strcat(buffer, "minimize ");
-	if (window->flags & window_allowed_action_shade_bit) strcat(buffer, "shade ");
-	if (window->flags & window_allowed_action_stick_bit) strcat(buffer, "stick ");
-	if (window->flags & window_allowed_action_maximize_horz_bit) strcat(buffer, "maximize_horz ");
-	if (window->flags & window_allowed_action_maximize_vert_bit) strcat(buffer, "maximize_vert ");
-	if (window->flags & window_allowed_action_fullscreen_bit) strcat(buffer, "fullscreen ");
-	if (window->flags & window_allowed_action_change_desktop_bit) strcat(buffer, "change_desktop ");
-	if (window->flags & window_allowed_action_close_bit) strcat(buffer, "close ");
-	if (window->flags & window_allowed_action_above_bit) strcat(buffer, "above ");
-	if (window->flags & window_allowed_action_below_bit) strcat(buffer, "below ");
+	window_log_va("[%lu] strut: %u %u %u %u", window->x_window, values[strut_left], values[strut_right], values[strut_top], values[strut_bottom]);
 
-	window_log_va("[%lu] allowed actions: %s", window->x_window, buffer);
+	if (sl_workarea_set_strut((sl_workarea*)&display->workarea, window->x_window, values, false)) sl_workarea_change_response(display);
 }
 
 void sl_window_set_net_wm_strut (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1268,7 +1299,26 @@ void sl_window_set_net_wm_strut (M_maybe_unused sl_window* window, M_maybe_unuse
 	*/
 	window_log_va("[%lu] set window net wm strut", window->x_window);
 
-	window_log("todo: _net_wm_strut");
+	sl_property_request(display, window->x_window, display->atoms[net_wm_strut], XA_CARDINAL, false, &window_net_wm_strut_from_property);
+}
+
+static void window_net_wm_strut_partial_from_property (sl_window* window, sl_display* display, sl_property const* property) {
+	if (property->format != 32 || property->items_size < M_strut_values_size) {
+		// the partial strut went away, a plain one left on the window counts again
+		if (sl_workarea_has_partial_strut(&display->workarea, window->x_window) &&
+		    sl_workarea_remove_strut((sl_workarea*)&display->workarea, window->x_window))
+			sl_workarea_change_response(display);
+
+		return sl_window_set_net_wm_strut(window, display);
+	}
+
+	u32 values[M_strut_values_size];
+	for (u8 i = 0; i < M_strut_values_size; ++i)
+		values[i] = ((long*)property->data)[i];
+
+	window_log_va("[%lu] strut partial: %u %u %u %u", window->x_window, values[strut_left], values[strut_right], values[strut_top], values[strut_bottom]);
+
+	if (sl_workarea_set_strut((sl_workarea*)&display->workarea, window->x_window, values, true)) sl_workarea_change_response(display);
 }
 
 void sl_window_set_net_wm_strut_partial (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1308,7 +1358,7 @@ void sl_window_set_net_wm_strut_partial (M_maybe_unused sl_window* window, M_may
 	*/
 	window_log_va("[%lu] set window net wm strut partial", window->x_window);
 
-	window_log("todo: _net_wm_strut_partial");
+	sl_property_request(display, window->x_window, display->atoms[net_wm_strut_partial], XA_CARDINAL, false, &window_net_wm_strut_partial_from_property);
 }
 
 void sl_window_set_net_wm_icon_geometry (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1337,7 +1387,16 @@ void sl_window_set_net_wm_icon (M_maybe_unused sl_window* window, M_maybe_unused
 	*/
 	window_log_va("[%lu] set window net wm icon", window->x_window);
 
-	window_log("todo: _net_wm_icon");
+	// icons can be megabytes, nothing is read until the icon cache is asked for it
+	((sl_window_mutable*)window)->icon_hash = 0;
+}
+
+static void window_net_wm_pid_from_property (sl_window* window, M_maybe_unused sl_display* display, sl_property const* property) {
+	((sl_window_mutable*)window)->net_wm_pid = property->format == 32 && property->items_size >= 1 ? (pid_t)*(long const*)property->data : 0;
+
+	window_update_pid(window);
+
+	window_log_va("[%lu] net wm pid %i, pid %i", window->x_window, window->net_wm_pid, window->pid);
 }
 
 void sl_window_set_net_wm_pid (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1355,7 +1414,7 @@ void sl_window_set_net_wm_pid (M_maybe_unused sl_window* window, M_maybe_unused
 	*/
 	window_log_va("[%lu] set window net wm pid", window->x_window);
 
-	window_log("todo: _net_wm_pid");
+	sl_property_request(display, window->x_window, display->atoms[net_wm_pid], XA_CARDINAL, false, &window_net_wm_pid_from_property);
 }
 
 void sl_window_set_net_wm_handled_icons (M_maybe_unused sl_window* window, M_maybe_unused sl_display* display) {
@@ -1493,80 +1552,34 @@ void sl_window_set_all_properties (sl_window* window, sl_display* display) {
 	sl_window_set_net_wm_bypass_compositor(window, display);
 }
 
+void sl_window_set_initial_properties (sl_window* window, sl_display* display, sl_property const properties[prefetch_properties_size]) {
+	window_log_va("[%lu] window set initial properties", window->x_window);
+
+	window_name_from_property(window, display, &properties[prefetch_wm_name]);
+	window_icon_name_from_property(window, display, &properties[prefetch_wm_icon_name]);
+	window_normal_hints_from_property(window, display, &properties[prefetch_wm_normal_hints]);
+	window_hints_from_property(window, display, &properties[prefetch_wm_hints]);
+	window_class_from_property(window, display, &properties[prefetch_wm_class]);
+	window_transient_for_from_property(window, display, &properties[prefetch_wm_transient_for]);
+	window_protocols_from_property(window, display, &properties[prefetch_wm_protocols]);
+	sl_set_window_colormap_windows(window, display);
+	window_client_machine_from_property(window, display, &properties[prefetch_wm_client_machine]);
+	window_net_wm_pid_from_property(window, display, &properties[prefetch_net_wm_pid]);
+	sl_window_set_net_wm_strut_partial(window, display);
+}
+
 static void window_state_change (sl_window* window, sl_display* display) {
-	size_t i = 0;
-
-	if (window->flags & window_state_modal_bit) ++i;
-	if (window->flags & window_state_sticky_bit) ++i;
-	if (window->flags & window_state_maximized_vert_bit) ++i;
-	if (window->flags & window_state_maximized_horz_bit) ++i;
-	if (window->flags & window_state_shaded_bit) ++i;
-	if (window->flags & window_state_skip_taskbar_bit) ++i;
-	if (window->flags & window_state_skip_pager_bit) ++i;
-	if (window->flags & window_state_hidden_bit) ++i;
-	if (window->flags & window_state_fullscreen_bit) ++i;
-	if (window->flags & window_state_above_bit) ++i;
-	if (window->flags & window_state_below_bit) ++i;
-	if (window->flags & window_state_demands_attention_bit) ++i;
-	if (window->flags & window_state_focused_bit) ++i;
-
-	Atom data[i];
-	i = 0;
-
-	if (window->flags & window_state_modal_bit) {
-		data[i] = display->atoms[net_wm_state_modal];
-		++i;
-	}
-	if (window->flags & window_state_sticky_bit) {
-		data[i] = display->atoms[net_wm_state_sticky];
-		++i;
-	}
-	if (window->flags & window_state_maximized_vert_bit) {
-		data[i] = display->atoms[net_wm_state_maximized_vert];
-		++i;
-	}
-	if (window->flags & window_state_maximized_horz_bit) {
-		data[i] = display->atoms[net_wm_state_maximized_horz];
-		++i;
-	}
-	if (window->flags & window_state_shaded_bit) {
-		data[i] = display->atoms[net_wm_state_shaded];
-		++i;
-	}
-	if (window->flags & window_state_skip_taskbar_bit) {
-		data[i] = display->atoms[net_wm_state_skip_taskbar];
-		++i;
-	}
-	if (window->flags & window_state_skip_pager_bit) {
-		data[i] = display->atoms[net_wm_state_skip_pager];
-		++i;
-	}
-	if (window->flags & window_state_hidden_bit) {
-		data[i] = display->atoms[net_wm_state_hidden];
-		++i;
-	}
-	if (window->flags & window_state_fullscreen_bit) {
-		data[i] = display->atoms[net_wm_state_fullscreen];
-		++i;
-	}
-	if (window->flags & window_state_above_bit) {
-		data[i] = display->atoms[net_wm_state_above];
-		++i;
-	}
-	if (window->flags & window_state_below_bit) {
-		data[i] = display->atoms[net_wm_state_below];
-		++i;
-	}
-	if (window->flags & window_state_demands_attention_bit) {
-		data[i] = display->atoms[net_wm_state_demands_attention];
-		++i;
-	}
-	if (window->flags & window_state_focused_bit) {
-		data[i] = display->atoms[net_wm_state_focused];
-		++i;
-	}
+	u64 const state = window->flags & window_all_net_states;
+
+	// every PropertyNotify we cause wakes up the pagers and taskbars, so nothing is written when the list would come out the same
+	if (state == window->published_net_wm_state) return;
+
+	// a window without any state still gets the empty list written, but an array of length 0 is undefined
+	Atom data[state ? __builtin_popcountll(state) : 1];
+	size_t const size = sl_flags_to_atom_list(display, state, data);
 
-	XChangeProperty(display->x_display, window->x_window, display->atoms[net_wm_state], XA_ATOM, 32, PropModeReplace, (uchar*)data, i);
+	XChangeProperty(display->x_display, window->x_window, display->atoms[net_wm_state], XA_ATOM, 32, PropModeReplace, (uchar*)data, size);
+	((sl_window_mutable*)window)->published_net_wm_state = state;
 }
 
 void sl_window_set_withdrawn (sl_window* restrict window) {
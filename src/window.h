@@ -18,8 +18,11 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <X11/X.h>
 
+#include "property.h"
 #include "window-dimensions.h"
 #include "workspace-type.h"
 
@@ -59,6 +62,7 @@
 #define window_state_demands_attention_bit       0x0000000100000000
 #define window_state_focused_bit                 0x0000000200000000
 #define window_all_states                        0x00000003fff80000
+#define window_all_net_states                    0x00000003ffe00000
 #define window_allowed_action_move_bit           0x0000000400000000
 #define window_allowed_action_resize_bit         0x0000000800000000
 #define window_allowed_action_minimize_bit       0x0000001000000000
@@ -71,12 +75,18 @@
 #define window_allowed_action_close_bit          0x0000080000000000
 #define window_allowed_action_above_bit          0x0000100000000000
 #define window_allowed_action_below_bit          0x0000200000000000
-#define window_all_allowed_actions               0x00003ffb00000000
-#define window_all_flags                         0x00003fffffffffff
+#define window_all_allowed_actions               0x00003ffc00000000
+#define window_floating_bit                      0x0000400000000000
+#define window_keep_priority_bit                 0x0000800000000000
+#define window_protocols_sync_request_bit        0x0001000000000000
+#define window_user_position_bit                 0x0002000000000000
+#define window_client_machine_local_bit          0x0004000000000000
+#define window_all_flags                         0x0007ffffffffffff
 
 struct sl_sized_string {
 	char const* data;
 	size_t const size;
+	u64 const hash; // of the property the text was decoded from, 0 when there is none
 };
 
 typedef struct sl_window {
@@ -87,6 +97,10 @@ typedef struct sl_window {
 
 	struct sl_sized_string const name;
 	struct sl_sized_string const icon_name;
+	u32 const instance; // the two WM_CLASS strings, interned
+	u32 const class;
+	Window const transient_for; // None when the property is missing or names the window itself
+	Window const group;         // the window group leader of the WM_HINTS, None when there is none
 
 	struct {
 		u16 min_width;
@@ -110,6 +124,12 @@ typedef struct sl_window {
 	struct sl_sized_string const net_wm_visible_name;
 	struct sl_sized_string const net_wm_icon_name;
 	struct sl_sized_string const net_wm_visible_icon_name;
+
+	pid_t const net_wm_pid;
+	pid_t const pid; // net_wm_pid when WM_CLIENT_MACHINE names this host, 0 otherwise
+	u64 const published_net_wm_state; // the window_all_net_states flags last written to _NET_WM_STATE
+	u32 const published_desktop;      // one more than the last _NET_WM_DESKTOP written, 0 when there is none on the window
+	u64 const icon_hash;              // of the _NET_WM_ICON last read, 0 when it has to be read again
 } sl_window;
 
 extern void sl_window_destroy (sl_window* window);
@@ -147,6 +167,7 @@ extern void sl_window_set_net_wm_opaque_region (sl_window* restrict, sl_display*
 extern void sl_window_set_net_wm_bypass_compositor (sl_window* restrict, sl_display* restrict);
 
 extern void sl_window_set_all_properties (sl_window* restrict, sl_display* restrict);
+extern void sl_window_set_initial_properties (sl_window* restrict, sl_display* restrict, sl_property const[prefetch_properties_size]);
 
 extern void sl_window_set_withdrawn (sl_window* restrict);
 extern void sl_window_set_normal (sl_window* restrict);
@@ -0,0 +1,234 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "workarea.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "compiler-differences.h"
+#include "message.h"
+
+#ifdef D_workarea_log
+#	define workarea_log(M_message)         warn_log(M_message)
+#	define workarea_log_va(M_message, ...) warn_log_va(M_message, __VA_ARGS__)
+#else
+#	define workarea_log(M_message)
+#	define workarea_log_va(M_message, ...)
+#endif
+
+#define max(a, b) ((a > b) ? a : b)
+#define min(a, b) ((a > b) ? b : a)
+
+#define M_smallest_nonzero_size 4
+
+typedef struct sl_strut_mutable {
+	Window x_window;
+	u32 values[M_strut_values_size];
+	bool partial;
+} sl_strut_mutable;
+
+typedef struct sl_strut_edge_mutable {
+	u32 size;
+	size_t holders;
+} sl_strut_edge_mutable;
+
+typedef struct sl_workarea_mutable {
+	sl_strut_mutable* struts;
+	size_t size;
+	size_t allocated_size;
+
+	sl_strut_edge_mutable edges[struts_size];
+	sl_window_dimensions screen;
+	sl_window_dimensions area;
+
+	u64 updates;
+	u64 rescans;
+} sl_workarea_mutable;
+
+void sl_workarea_create (sl_workarea* restrict this, sl_window_dimensions screen) {
+	*(sl_workarea_mutable*)this = (sl_workarea_mutable) {.screen = screen, .area = screen};
+}
+
+void sl_workarea_delete (sl_workarea* restrict this) {
+	if (this->struts) free(((sl_workarea_mutable*)this)->struts);
+}
+
+static size_t find_strut (sl_workarea const* restrict this, Window x_window) {
+	size_t i = 0;
+	for (; i < this->size; ++i)
+		if (this->struts[i].x_window == x_window) break;
+
+	return i;
+}
+
+static void rescan_edge (sl_workarea_mutable* restrict this, u8 edge) {
+	sl_strut_edge_mutable* const strut_edge = &this->edges[edge];
+
+	*strut_edge = (sl_strut_edge_mutable) {};
+
+	for (size_t i = 0; i < this->size; ++i) {
+		u32 const size = this->struts[i].values[edge];
+
+		if (size > strut_edge->size) *strut_edge = (sl_strut_edge_mutable) {.size = size, .holders = 1};
+		else if (size != 0 && size == strut_edge->size) ++strut_edge->holders;
+	}
+
+	++this->rescans;
+}
+
+// a window's strut on this edge went from old_size to new_size, the list already holds new_size so that a rescan sees it
+static void update_edge (sl_workarea_mutable* restrict this, u8 edge, u32 old_size, u32 new_size) {
+	sl_strut_edge_mutable* const strut_edge = &this->edges[edge];
+
+	if (old_size == new_size) return;
+
+	if (new_size > strut_edge->size) {
+		*strut_edge = (sl_strut_edge_mutable) {.size = new_size, .holders = 1};
+		return;
+	}
+
+	if (new_size != 0 && new_size == strut_edge->size) ++strut_edge->holders;
+
+	if (old_size != 0 && old_size == strut_edge->size && --strut_edge->holders == 0) rescan_edge(this, edge);
+}
+
+static bool update_area (sl_workarea_mutable* restrict this) {
+	u32 const left = min(this->edges[strut_left].size, this->screen.width);
+	u32 const right = min(this->edges[strut_right].size, this->screen.width - left);
+	u32 const top = min(this->edges[strut_top].size, this->screen.height);
+	u32 const bottom = min(this->edges[strut_bottom].size, this->screen.height - top);
+
+	sl_window_dimensions const area = (sl_window_dimensions) {
+	.x = this->screen.x + left,
+	.y = this->screen.y + top,
+	.width = max(this->screen.width - left - right, 1),
+	.height = max(this->screen.height - top - bottom, 1)};
+
+	if (area.x == this->area.x && area.y == this->area.y && area.width == this->area.width && area.height == this->area.height) return false;
+
+	workarea_log_va("workarea: %i %i %u %u", area.x, area.y, area.width, area.height);
+
+	this->area = area;
+	return true;
+}
+
+bool sl_workarea_set_strut (sl_workarea* restrict workarea, Window x_window, u32 const values[M_strut_values_size], bool partial) {
+	sl_workarea_mutable* const this = (sl_workarea_mutable*)workarea;
+	size_t const i = find_strut(workarea, x_window);
+
+	if (i == this->size) {
+		if (!partial && !(values[strut_left] | values[strut_right] | values[strut_top] | values[strut_bottom])) return false;
+
+		if (this->size == this->allocated_size) {
+			size_t const allocated_size = max(this->allocated_size << 1, M_smallest_nonzero_size);
+			sl_strut_mutable* struts = realloc(this->struts, sizeof(sl_strut_mutable) * allocated_size);
+
+			if (!struts) {
+				warn_log_va("size of %lu is invalid", allocated_size);
+				return false;
+			}
+
+			this->struts = struts;
+			this->allocated_size = allocated_size;
+		}
+
+		this->struts[this->size++] = (sl_strut_mutable) {.x_window = x_window};
+	} else if (!partial && this->struts[i].partial) {
+		return false;
+	}
+
+	++this->updates;
+
+	// the ranges count too, the area of every output is made of the struts along its own edges
+	bool const changed = memcmp(this->struts[i].values, values, sizeof(u32) * M_strut_values_size) != 0;
+
+	for (u8 edge = 0; edge < struts_size; ++edge) {
+		u32 const old_size = this->struts[i].values[edge];
+
+		this->struts[i].values[edge] = values[edge];
+		update_edge(this, edge, old_size, values[edge]);
+	}
+
+	memcpy(this->struts[i].values + struts_size, values + struts_size, sizeof(u32) * (M_strut_values_size - struts_size));
+	this->struts[i].partial = partial;
+
+	return update_area(this) || changed;
+}
+
+bool sl_workarea_remove_strut (sl_workarea* restrict workarea, Window x_window) {
+	sl_workarea_mutable* const this = (sl_workarea_mutable*)workarea;
+	size_t const i = find_strut(workarea, x_window);
+
+	if (i == this->size) return false;
+
+	++this->updates;
+
+	// moved out of the list first so that a rescan does not count it
+	sl_strut_mutable const strut = this->struts[i];
+	this->struts[i] = this->struts[--this->size];
+
+	for (u8 edge = 0; edge < struts_size; ++edge)
+		update_edge(this, edge, strut.values[edge], 0);
+
+	return update_area(this) || (strut.values[strut_left] | strut.values[strut_right] | strut.values[strut_top] | strut.values[strut_bottom]) != 0;
+}
+
+bool sl_workarea_set_screen (sl_workarea* restrict workarea, sl_window_dimensions screen) {
+	sl_workarea_mutable* const this = (sl_workarea_mutable*)workarea;
+
+	this->screen = screen;
+	return update_area(this);
+}
+
+// whether the range of a strut, inclusive and in root window coordinates, runs along the part [position, position + size) of the edge
+static bool range_overlaps (u32 start, u32 end, i32 position, u16 size) { return start <= end && (i64)start < position + size && (i64)end >= position; }
+
+sl_window_dimensions sl_workarea_area_within (sl_workarea const* restrict this, sl_window_dimensions output) {
+	i32 left = output.x, top = output.y;
+	i32 right = output.x + output.width, bottom = output.y + output.height;
+
+	i32 const screen_right = this->screen.x + this->screen.width, screen_bottom = this->screen.y + this->screen.height;
+
+	// a strut is measured from the edge of the screen, it only reaches into the outputs its range runs along
+	for (size_t i = 0; i < this->size; ++i) {
+		u32 const* const values = this->struts[i].values;
+
+		if (values[strut_left] && range_overlaps(values[4], values[5], output.y, output.height)) left = max(left, this->screen.x + (i32)values[strut_left]);
+		if (values[strut_right] && range_overlaps(values[6], values[7], output.y, output.height)) right = min(right, screen_right - (i32)values[strut_right]);
+		if (values[strut_top] && range_overlaps(values[8], values[9], output.x, output.width)) top = max(top, this->screen.y + (i32)values[strut_top]);
+		if (values[strut_bottom] && range_overlaps(values[10], values[11], output.x, output.width))
+			bottom = min(bottom, screen_bottom - (i32)values[strut_bottom]);
+	}
+
+	// one reserving more than the output has leaves it as it is
+	if (right <= left || bottom <= top) return output;
+
+	return (sl_window_dimensions) {.x = left, .y = top, .width = right - left, .height = bottom - top};
+}
+
+bool sl_workarea_has_partial_strut (sl_workarea const* restrict this, Window x_window) {
+	size_t const i = find_strut(this, x_window);
+
+	return i != this->size && this->struts[i].partial;
+}
+
+void sl_workarea_log_statistics (M_maybe_unused sl_workarea const* restrict this) {
+	log("workarea: %lu strut updates, %lu edge rescans, %lu struts", this->updates, this->rescans, this->size);
+}
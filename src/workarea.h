@@ -0,0 +1,70 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stddef.h>
+
+#include <X11/X.h>
+
+#include "types.h"
+#include "window-dimensions.h"
+
+enum { strut_left, strut_right, strut_top, strut_bottom, struts_size };
+
+// one window's _NET_WM_STRUT_PARTIAL: left, right, top, bottom, then left_start_y, left_end_y, right_start_y, right_end_y, top_start_x, ...
+#define M_strut_values_size 12
+
+typedef struct sl_strut {
+	Window const x_window;
+	u32 const values[M_strut_values_size];
+	bool const partial; // from _NET_WM_STRUT_PARTIAL, a _NET_WM_STRUT on the same window is ignored while it is set
+} sl_strut;
+
+// the widest strut on one edge, and how many windows reserve exactly that much so that only losing the last of them needs a rescan
+typedef struct sl_strut_edge {
+	u32 const size;
+	size_t const holders;
+} sl_strut_edge;
+
+typedef struct sl_workarea {
+	sl_strut const* struts;
+	size_t const size;
+	size_t const allocated_size;
+
+	sl_strut_edge const edges[struts_size];
+	sl_window_dimensions const screen;
+	sl_window_dimensions const area; // the screen minus the edges, what _NET_WORKAREA publishes
+
+	u64 const updates;
+	u64 const rescans;
+} sl_workarea;
+
+extern void sl_workarea_create (sl_workarea* restrict, sl_window_dimensions screen);
+extern void sl_workarea_delete (sl_workarea* restrict);
+
+// all of these return whether the area of any output may have changed
+extern bool sl_workarea_set_strut (sl_workarea* restrict, Window, u32 const values[M_strut_values_size], bool partial);
+extern bool sl_workarea_remove_strut (sl_workarea* restrict, Window);
+extern bool sl_workarea_set_screen (sl_workarea* restrict, sl_window_dimensions screen);
+
+extern sl_window_dimensions sl_workarea_area_within (sl_workarea const* restrict, sl_window_dimensions output); // the output minus the struts along it
+
+extern bool sl_workarea_has_partial_strut (sl_workarea const* restrict, Window);
+extern void sl_workarea_log_statistics (sl_workarea const* restrict);
@@ -0,0 +1,106 @@
+/*
+  glass shard, a window manager for X11
+  Copyright (C) 2022, David Cardoso <slidey-wotter.tumblr.com>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/*
+  a client that makes the kind of traffic a window manager sees, so the events the window manager receives can be compared between builds (they are
+  logged by type when it logs out)
+
+  usage: load-generator [windows] [rounds]
+
+  every round moves, resizes and renames every window and warps the pointer over each of them
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+static double seconds_since (struct timespec start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main (int argc, char** argv) {
+	int const windows_size = argc > 1 ? atoi(argv[1]) : 64;
+	int const rounds = argc > 2 ? atoi(argv[2]) : 100;
+
+	if (windows_size <= 0 || rounds < 0) {
+		fprintf(stderr, "usage: %s [windows] [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	Display* const display = XOpenDisplay(NULL);
+
+	if (!display) {
+		fprintf(stderr, "could not open the display\n");
+		return 1;
+	}
+
+	Window const root = DefaultRootWindow(display);
+	int const screen_width = DisplayWidth(display, DefaultScreen(display));
+	int const screen_height = DisplayHeight(display, DefaultScreen(display));
+
+	Window* const windows = malloc(sizeof(Window) * windows_size);
+
+	if (!windows) {
+		fprintf(stderr, "could not allocate %i windows\n", windows_size);
+		return 1;
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (int i = 0; i < windows_size; ++i) {
+		windows[i] = XCreateSimpleWindow(display, root, (i * 37) % screen_width, (i * 23) % screen_height, 200, 150, 0, 0, 0);
+		XStoreName(display, windows[i], "load generator");
+		XMapWindow(display, windows[i]);
+	}
+
+	XSync(display, false);
+
+	char name[32];
+	for (int round = 0; round < rounds; ++round) {
+		for (int i = 0; i < windows_size; ++i) {
+			XMoveResizeWindow(display, windows[i], (i * 37 + round * 11) % screen_width, (i * 23 + round * 7) % screen_height, 200 + round % 50, 150 + round % 30);
+
+			snprintf(name, sizeof(name), "load generator %i", round);
+			XChangeProperty(display, windows[i], XA_WM_NAME, XA_STRING, 8, PropModeReplace, (unsigned char const*)name, strlen(name));
+
+			XWarpPointer(display, None, root, 0, 0, 0, 0, (i * 37 + round * 11) % screen_width + 100, (i * 23 + round * 7) % screen_height + 75);
+		}
+
+		XSync(display, false);
+	}
+
+	for (int i = 0; i < windows_size; ++i)
+		XDestroyWindow(display, windows[i]);
+
+	XSync(display, false);
+
+	printf("%i windows, %i rounds, %.3f seconds\n", windows_size, rounds, seconds_since(start));
+
+	free(windows);
+	XCloseDisplay(display);
+	return 0;
+}